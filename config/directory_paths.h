@@ -23,4 +23,9 @@ const std::filesystem::path getExportFolder();
 /// @brief returns the path to the test data folder
 /////////////////////////////////////////////////
 const std::filesystem::path getTestDataFolder();
+
+/////////////////////////////////////////////////
+/// @brief returns the path to the meshed model cache folder
+/////////////////////////////////////////////////
+const std::filesystem::path getCacheFolder();
 } // namespace config
@@ -7,6 +7,7 @@
 /// Headers
 /////////////////////////////////////////////////
 #include "DataExporter.h"
+#include "MeshCache.h"
 #include "ModelData.h"
 #include "Projector.h"
 #include "VoxManipulator.h"
@@ -15,23 +16,41 @@
 #include <SFML/Graphics/PrimitiveType.hpp>
 #include <SFML/Graphics/VertexArray.hpp>
 #include <iostream>
+#include <optional>
+#include <string>
 
 int main() {
-  // create VoxReader instance
-  hollow_lantern::VoxReader vox_reader;
-  auto model_data_result = vox_reader.ProvideVoxData("colour_cube");
-  if (!model_data_result) {
-    std::cerr << "Failed to load model data." << std::endl;
-    return 1;
-  }
-  // cast to ModelData
-  hollow_lantern::ModelData model_data = model_data_result.value();
+  const std::string model_name{"colour_cube"};
+  const hollow_lantern::MeshingOptions meshing_options{};
+
+  // unchanged models come straight from the mesh cache, skipping reading,
+  // hollowing and meshing
+  hollow_lantern::MeshCache mesh_cache;
+  std::optional<hollow_lantern::ModelData> cached_model =
+      mesh_cache.ProvideMeshedModel(model_name, meshing_options);
+
+  hollow_lantern::ModelData model_data;
+  if (cached_model) {
+    model_data = std::move(*cached_model);
+  } else {
+    // create VoxReader instance
+    hollow_lantern::VoxReader vox_reader;
+    auto model_data_result = vox_reader.ProvideVoxData(model_name);
+    if (!model_data_result) {
+      std::cerr << "Failed to load model data." << std::endl;
+      return 1;
+    }
+    // cast to ModelData
+    model_data = std::move(model_data_result.value());
+
+    // create VoxManipulator instance and hollow out model data
+    hollow_lantern::VoxManipulator vox_manipulator(meshing_options);
+    vox_manipulator.HollowAndMesh(model_data);
 
-  // create VoxManipulator instance and hollow out model data
-  hollow_lantern::VoxManipulator vox_manipulator;
-  vox_manipulator.HollowAndMesh(model_data);
+    std::cout << "[DEBUG] Hollowed and meshed model data." << std::endl;
+    mesh_cache.StoreMeshedModel(model_data, meshing_options);
+  }
 
-  std::cout << "[DEBUG] Hollowed and meshed model data." << std::endl;
   // create a Projector instance to project the 3D model data onto 2D shapes
   hollow_lantern::Projector projector;
   projector.BasicProjection(model_data, {0.f, 0.0f, 0.0f}, 4,
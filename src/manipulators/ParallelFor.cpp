@@ -0,0 +1,63 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Implementation of the ParallelFor helper
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "ParallelFor.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace hollow_lantern {
+
+/////////////////////////////////////////////////
+void ParallelFor(size_t count, size_t thread_count,
+                 const std::function<void(size_t)> &body) {
+  if (thread_count == 0) {
+    thread_count =
+        std::max<size_t>(1, std::thread::hardware_concurrency());
+  }
+  thread_count = std::min(thread_count, count);
+  if (thread_count <= 1) {
+    for (size_t idx = 0; idx < count; ++idx)
+      body(idx);
+    return;
+  }
+
+  std::atomic<size_t> next_index{0};
+  std::exception_ptr first_error;
+  std::mutex error_mutex;
+  auto work = [&]() {
+    for (size_t idx = next_index.fetch_add(1); idx < count;
+         idx = next_index.fetch_add(1)) {
+      try {
+        body(idx);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!first_error)
+          first_error = std::current_exception();
+        // stop handing out work, the result is going to be thrown away
+        next_index.store(count);
+      }
+    }
+  };
+
+  {
+    std::vector<std::jthread> workers;
+    workers.reserve(thread_count - 1);
+    for (size_t idx = 1; idx < thread_count; ++idx)
+      workers.emplace_back(work);
+    work();
+  } // jthreads join here
+
+  if (first_error)
+    std::rethrow_exception(first_error);
+}
+
+} // namespace hollow_lantern
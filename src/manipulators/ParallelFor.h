@@ -0,0 +1,36 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the ParallelFor helper
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include <cstddef>
+#include <functional>
+
+namespace hollow_lantern {
+
+/////////////////////////////////////////////////
+/// @brief Run body(0) to body(count - 1) across worker threads
+///
+/// Indices are handed out one at a time from a shared counter, so uneven work
+/// still balances. Each index runs exactly once, in no particular order; body
+/// should write its result to a slot reserved for its index. The calling
+/// thread works too, and the call returns once every index has run. The
+/// first exception thrown by body is rethrown after the workers stop.
+///
+/// @param count Number of indices to run
+/// @param thread_count Threads to use including the caller, 0 for one per
+/// hardware thread
+/// @param body Work for one index
+/////////////////////////////////////////////////
+void ParallelFor(size_t count, size_t thread_count,
+                 const std::function<void(size_t)> &body);
+
+} // namespace hollow_lantern
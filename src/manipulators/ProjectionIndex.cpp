@@ -0,0 +1,251 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Implementation of the ProjectionIndex class
+/////////////////////////////////////////////////
+
+#include "ProjectionIndex.h"
+#include <SFML/Graphics/PrimitiveType.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <utility>
+
+namespace hollow_lantern {
+
+/////////////////////////////////////////////////
+ProjectionIndex::ProjectionIndex(const sf::VertexArray &view,
+                                 std::vector<uint32_t> sources)
+    : sources(std::move(sources)) {
+  const bool is_strip =
+      view.getPrimitiveType() == sf::PrimitiveType::TriangleStrip;
+  if (!is_strip && view.getPrimitiveType() != sf::PrimitiveType::Triangles) {
+    std::cout << "[DEBUG] Only triangle lists and strips can be indexed"
+              << std::endl;
+    this->sources.clear();
+    return;
+  }
+  // every vertex of a strip after the second ends a triangle
+  const size_t step = is_strip ? 1 : 3;
+  const size_t triangle_count =
+      is_strip ? std::max<size_t>(view.getVertexCount(), 2) - 2
+               : view.getVertexCount() / 3;
+  if (!this->sources.empty() && this->sources.size() != triangle_count) {
+    std::cout << "[DEBUG] Expected " << triangle_count << " sources, got "
+              << this->sources.size() << ", ignoring them" << std::endl;
+    this->sources.clear();
+  }
+  if (triangle_count == 0)
+    return;
+
+  triangles.resize(triangle_count);
+  sf::Vector2f lower = view[0].position;
+  sf::Vector2f upper = view[0].position;
+  for (size_t tri_idx = 0; tri_idx < triangle_count; ++tri_idx) {
+    // odd strip triangles hold their list corners as n, n + 2, n + 1, see
+    // TriangleStripper, so they are read back in list order
+    const bool is_swapped = is_strip && tri_idx % 2 == 1;
+    for (size_t corner = 0; corner < 3; ++corner) {
+      const size_t read = is_swapped && corner != 0 ? 3 - corner : corner;
+      const sf::Vector2f &position = view[tri_idx * step + read].position;
+      triangles[tri_idx][corner] = position;
+      lower = {std::min(lower.x, position.x), std::min(lower.y, position.y)};
+      upper = {std::max(upper.x, position.x), std::max(upper.y, position.y)};
+    }
+  }
+
+  // about one cell per triangle, square cells unless the view is a line
+  constexpr size_t max_cells_per_axis = 1024;
+  const sf::Vector2f extent = upper - lower;
+  const float count = static_cast<float>(triangle_count);
+  float edge = std::sqrt(extent.x * extent.y / count);
+  edge = std::max({edge, std::max(extent.x, extent.y) / count, 1e-6f});
+  origin = lower;
+  columns = std::clamp<size_t>(
+      static_cast<size_t>(std::ceil(extent.x / edge)), 1, max_cells_per_axis);
+  rows = std::clamp<size_t>(static_cast<size_t>(std::ceil(extent.y / edge)),
+                            1, max_cells_per_axis);
+  cell_size = {std::max(extent.x / static_cast<float>(columns), 1e-6f),
+               std::max(extent.y / static_cast<float>(rows), 1e-6f)};
+
+  // counting pass then filling pass, so every cell's list is contiguous.
+  // Triangles with no area, such as the joins between strips, cover nothing
+  // and are left out of every cell
+  auto for_each_cell = [&](size_t tri_idx, auto &&visit) {
+    const auto &[a, b, c] = triangles[tri_idx];
+    if ((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x) == 0.0f)
+      return;
+    const size_t col_begin =
+        CellOf(std::min({a.x, b.x, c.x}), origin.x, cell_size.x, columns);
+    const size_t col_end =
+        CellOf(std::max({a.x, b.x, c.x}), origin.x, cell_size.x, columns);
+    const size_t row_begin =
+        CellOf(std::min({a.y, b.y, c.y}), origin.y, cell_size.y, rows);
+    const size_t row_end =
+        CellOf(std::max({a.y, b.y, c.y}), origin.y, cell_size.y, rows);
+    for (size_t row = row_begin; row <= row_end; ++row) {
+      for (size_t col = col_begin; col <= col_end; ++col)
+        visit(row * columns + col);
+    }
+  };
+  cell_start.assign(columns * rows + 1, 0);
+  for (size_t tri_idx = 0; tri_idx < triangle_count; ++tri_idx)
+    for_each_cell(tri_idx, [&](size_t cell) { ++cell_start[cell + 1]; });
+  for (size_t cell = 0; cell < columns * rows; ++cell)
+    cell_start[cell + 1] += cell_start[cell];
+  cell_triangles.resize(cell_start.back());
+  std::vector<uint32_t> filled(cell_start.begin(), cell_start.end() - 1);
+  for (size_t tri_idx = 0; tri_idx < triangle_count; ++tri_idx) {
+    for_each_cell(tri_idx, [&](size_t cell) {
+      cell_triangles[filled[cell]++] = static_cast<uint32_t>(tri_idx);
+    });
+  }
+  std::cout << "[DEBUG] Indexed " << triangle_count << " triangles in a "
+            << columns << "x" << rows << " grid" << std::endl;
+}
+
+/////////////////////////////////////////////////
+size_t ProjectionIndex::CellOf(float coordinate, float grid_origin,
+                               float size, size_t count) const {
+  const float cell = std::floor((coordinate - grid_origin) / size);
+  return static_cast<size_t>(
+      std::clamp(cell, 0.0f, static_cast<float>(count - 1)));
+}
+
+/////////////////////////////////////////////////
+std::optional<std::array<float, 3>>
+ProjectionIndex::Contains(size_t triangle, sf::Vector2f point) const {
+  const auto &[a, b, c] = triangles[triangle];
+  const float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+  if (area == 0.0f)
+    return std::nullopt; // edge on, covers nothing
+  const float w_a =
+      ((b.x - point.x) * (c.y - point.y) - (b.y - point.y) * (c.x - point.x)) /
+      area;
+  const float w_b =
+      ((c.x - point.x) * (a.y - point.y) - (c.y - point.y) * (a.x - point.x)) /
+      area;
+  const float w_c = 1.0f - w_a - w_b;
+  if (w_a < -1e-6f || w_b < -1e-6f || w_c < -1e-6f)
+    return std::nullopt;
+  return std::array<float, 3>{w_a, w_b, w_c};
+}
+
+/////////////////////////////////////////////////
+std::optional<ProjectionHit> ProjectionIndex::Pick(sf::Vector2f point) const {
+  if (triangles.empty())
+    return std::nullopt;
+  const sf::Vector2f far_corner(
+      origin.x + cell_size.x * static_cast<float>(columns),
+      origin.y + cell_size.y * static_cast<float>(rows));
+  if (point.x < origin.x || point.y < origin.y || point.x > far_corner.x ||
+      point.y > far_corner.y)
+    return std::nullopt;
+
+  const size_t cell = CellOf(point.y, origin.y, cell_size.y, rows) * columns +
+                      CellOf(point.x, origin.x, cell_size.x, columns);
+  // lists are in draw order, the last match is the one drawn on top
+  for (uint32_t entry = cell_start[cell + 1]; entry-- > cell_start[cell];) {
+    const uint32_t tri_idx = cell_triangles[entry];
+    const std::optional<std::array<float, 3>> weights =
+        Contains(tri_idx, point);
+    if (!weights.has_value())
+      continue;
+    ProjectionHit hit;
+    hit.triangle = tri_idx;
+    if (!sources.empty())
+      hit.source = sources[tri_idx];
+    hit.weights = weights.value();
+    return hit;
+  }
+  return std::nullopt;
+}
+
+/////////////////////////////////////////////////
+std::optional<sf::Vector3i>
+ProjectionIndex::PickVoxel(const std::vector<Triangle> &mesh,
+                           sf::Vector2f point) const {
+  const std::optional<ProjectionHit> hit = Pick(point);
+  if (!hit.has_value() || !hit->source.has_value() ||
+      hit->source.value() >= mesh.size())
+    return std::nullopt;
+  return SourceVoxel(mesh[hit->source.value()], hit->weights);
+}
+
+/////////////////////////////////////////////////
+std::vector<size_t> ProjectionIndex::Query(const sf::FloatRect &area) const {
+  std::vector<size_t> found;
+  if (triangles.empty())
+    return found;
+  const sf::Vector2f lower = area.position;
+  const sf::Vector2f upper = area.position + area.size;
+
+  // a triangle in several cells is listed by each, so gather then dedupe
+  std::vector<uint32_t> candidates;
+  const size_t col_begin = CellOf(lower.x, origin.x, cell_size.x, columns);
+  const size_t col_end = CellOf(upper.x, origin.x, cell_size.x, columns);
+  const size_t row_begin = CellOf(lower.y, origin.y, cell_size.y, rows);
+  const size_t row_end = CellOf(upper.y, origin.y, cell_size.y, rows);
+  for (size_t row = row_begin; row <= row_end; ++row) {
+    for (size_t col = col_begin; col <= col_end; ++col) {
+      const size_t cell = row * columns + col;
+      candidates.insert(candidates.end(),
+                        cell_triangles.begin() + cell_start[cell],
+                        cell_triangles.begin() + cell_start[cell + 1]);
+    }
+  }
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                   candidates.end());
+
+  const std::array<sf::Vector2f, 4> rectangle{
+      lower, sf::Vector2f(upper.x, lower.y), upper,
+      sf::Vector2f(lower.x, upper.y)};
+  for (const uint32_t tri_idx : candidates) {
+    const auto &corners = triangles[tri_idx];
+    const auto &[a, b, c] = corners;
+    // separating axis test, the rectangle's own axes are its bounding box
+    if (std::max({a.x, b.x, c.x}) < lower.x ||
+        std::min({a.x, b.x, c.x}) > upper.x ||
+        std::max({a.y, b.y, c.y}) < lower.y ||
+        std::min({a.y, b.y, c.y}) > upper.y)
+      continue;
+    const float area_sign =
+        (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    if (area_sign == 0.0f)
+      continue; // edge on, covers nothing
+    bool separated = false;
+    for (size_t edge = 0; edge < 3 && !separated; ++edge) {
+      const sf::Vector2f &from = corners[edge];
+      const sf::Vector2f &to = corners[(edge + 1) % 3];
+      // every rectangle corner strictly outside this edge separates them
+      separated = std::all_of(
+          rectangle.begin(), rectangle.end(), [&](const sf::Vector2f &point) {
+            const float side = (to.x - from.x) * (point.y - from.y) -
+                               (to.y - from.y) * (point.x - from.x);
+            return area_sign > 0.0f ? side < 0.0f : side > 0.0f;
+          });
+    }
+    if (!separated)
+      found.push_back(tri_idx);
+  }
+  return found;
+}
+
+/////////////////////////////////////////////////
+sf::Vector3i ProjectionIndex::SourceVoxel(const Triangle &face,
+                                          const std::array<float, 3> &weights) {
+  glm::vec3 point = face.vertices[0] * weights[0] +
+                    face.vertices[1] * weights[1] +
+                    face.vertices[2] * weights[2];
+  // faces sit on the voxel's outer side, X+ at x + 1 and X- at x
+  if (face.direction != Direction::NONE) {
+    const int index = static_cast<int>(face.direction) - 1;
+    const float step = index % 2 == 0 ? -0.5f : 0.5f;
+    point[index / 2] += step;
+  }
+  return {static_cast<int>(std::floor(point.x)),
+          static_cast<int>(std::floor(point.y)),
+          static_cast<int>(std::floor(point.z))};
+}
+
+} // namespace hollow_lantern
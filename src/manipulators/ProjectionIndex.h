@@ -0,0 +1,165 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the ProjectionIndex class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "ModelData.h"
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <SFML/System/Vector3.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace hollow_lantern {
+
+/////////////////////////////////////////////////
+/// @brief The topmost triangle of a view under a point
+/////////////////////////////////////////////////
+struct ProjectionHit {
+  /////////////////////////////////////////////////
+  /// @brief Index of the triangle in the view, vertices 3n to 3n + 2 of a
+  /// list or n to n + 2 of a strip
+  /////////////////////////////////////////////////
+  size_t triangle{0};
+
+  /////////////////////////////////////////////////
+  /// @brief Index into the mesh of the face it was projected from, if known
+  /////////////////////////////////////////////////
+  std::optional<uint32_t> source;
+
+  /////////////////////////////////////////////////
+  /// @brief Barycentric weights of the point for the triangle's vertices,
+  /// in the corner order of the list triangle a strip triangle came from
+  /////////////////////////////////////////////////
+  std::array<float, 3> weights{0.0f, 0.0f, 0.0f};
+};
+
+/////////////////////////////////////////////////
+/// @brief Uniform grid over the triangles of one projected view
+///
+/// The grid is sized so a cell holds about one triangle, and each cell
+/// lists the triangles whose bounding box touches it in draw order. A point
+/// query only tests the triangles of one cell, so picking costs the same
+/// however many triangles the view has.
+/////////////////////////////////////////////////
+class ProjectionIndex {
+
+private:
+  /////////////////////////////////////////////////
+  /// @brief Corners of every triangle of the view, in draw order, strip
+  /// joins included. Odd strip triangles are put back in list corner order
+  /////////////////////////////////////////////////
+  std::vector<std::array<sf::Vector2f, 3>> triangles;
+
+  /////////////////////////////////////////////////
+  /// @brief Mesh face of each triangle, empty if the view has none
+  /////////////////////////////////////////////////
+  std::vector<uint32_t> sources;
+
+  sf::Vector2f origin{0.0f, 0.0f};
+  sf::Vector2f cell_size{1.0f, 1.0f};
+  size_t columns{0};
+  size_t rows{0};
+
+  /////////////////////////////////////////////////
+  /// @brief Offset into cell_triangles where each cell's list starts, plus
+  /// one past the end
+  /////////////////////////////////////////////////
+  std::vector<uint32_t> cell_start;
+
+  /////////////////////////////////////////////////
+  /// @brief Triangle indices of every cell, one cell after another
+  /////////////////////////////////////////////////
+  std::vector<uint32_t> cell_triangles;
+
+  /////////////////////////////////////////////////
+  /// @brief Cell column or row a coordinate falls in, clamped to the grid
+  /////////////////////////////////////////////////
+  size_t CellOf(float coordinate, float grid_origin, float size,
+                size_t count) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Barycentric weights of a point, nullopt if it is outside
+  ///
+  /// Edges are inclusive, edge-on triangles contain nothing.
+  /////////////////////////////////////////////////
+  std::optional<std::array<float, 3>> Contains(size_t triangle,
+                                               sf::Vector2f point) const;
+
+public:
+  /////////////////////////////////////////////////
+  /// @brief Default constructor for the ProjectionIndex class, indexes
+  /// nothing
+  /////////////////////////////////////////////////
+  ProjectionIndex() = default;
+
+  /////////////////////////////////////////////////
+  /// @brief Index the triangles of a view
+  ///
+  /// @param view Vertex array of type triangles or triangle strip, e.g. one
+  /// of projected_data
+  /// @param sources The view's list from ModelData::projected_sources, left
+  /// out or empty if the view has none
+  /////////////////////////////////////////////////
+  explicit ProjectionIndex(const sf::VertexArray &view,
+                           std::vector<uint32_t> sources = {});
+
+  /////////////////////////////////////////////////
+  /// @brief Find the triangle drawn on top at a point
+  ///
+  /// @param point Position in the view's coordinates
+  /// @return The last drawn triangle containing the point, if any
+  /////////////////////////////////////////////////
+  std::optional<ProjectionHit> Pick(sf::Vector2f point) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Find the voxel drawn on top at a point
+  ///
+  /// @param mesh ModelData::triangles of the model the view came from
+  /// @param point Position in the view's coordinates
+  /// @return Grid position of the voxel, nullopt if nothing is under the
+  /// point or the view has no sources
+  /////////////////////////////////////////////////
+  std::optional<sf::Vector3i> PickVoxel(const std::vector<Triangle> &mesh,
+                                        sf::Vector2f point) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Find every triangle overlapping a rectangle
+  ///
+  /// @param area Rectangle in the view's coordinates, edges included
+  /// @return Indices of the triangles in draw order
+  /////////////////////////////////////////////////
+  std::vector<size_t> Query(const sf::FloatRect &area) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Number of triangles indexed
+  /////////////////////////////////////////////////
+  size_t Size() const { return triangles.size(); };
+
+  /////////////////////////////////////////////////
+  /// @brief Voxel behind a point on a mesh face
+  ///
+  /// The point is rebuilt on the face from the weights and stepped half a
+  /// voxel back along the face's direction, into the voxel it belongs to.
+  /// Projection is orthographic, so weights from the view apply unchanged.
+  ///
+  /// @param face Triangle of the mesh, as given by ProjectionHit::source
+  /// @param weights ProjectionHit::weights
+  /// @return Grid position of the voxel
+  /////////////////////////////////////////////////
+  static sf::Vector3i SourceVoxel(const Triangle &face,
+                                  const std::array<float, 3> &weights);
+};
+} // namespace hollow_lantern
@@ -0,0 +1,44 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Implementation of the ProjectionSequence class
+/////////////////////////////////////////////////
+
+#include "ProjectionSequence.h"
+#include <iostream>
+
+namespace hollow_lantern {
+
+/////////////////////////////////////////////////
+ProjectionSequence::ProjectionSequence(
+    const Projector &projector, const ModelData &model_data,
+    const std::vector<glm::mat4> &model_matrices)
+    : projector(projector), model(&model_data),
+      positions(VertexBuffer::FromTriangles(model_data.triangles)),
+      plan(projector.PlanViews(model_data, model_matrices)),
+      ray_caster(projector.MakeRayCaster(model_data)) {
+  groups.resize(plan.group_facing.size());
+}
+
+/////////////////////////////////////////////////
+bool ProjectionSequence::Next(sf::VertexArray &view,
+                              std::vector<float> *depths) {
+  if (next_view >= plan.model_matrices.size())
+    return false;
+
+  std::optional<VisibleFaces> &group = groups[plan.view_group[next_view]];
+  if (!group.has_value()) {
+    group = projector.CullFaces(model->triangles, positions,
+                                plan.group_facing[plan.view_group[next_view]]);
+  }
+  // written into the caller's storage rather than a new array
+  projector.ProjectPlannedView(
+      model->triangles, plan, group.value(),
+      ray_caster.has_value() ? &ray_caster.value() : nullptr, next_view, view,
+      nullptr, depths);
+  std::cout << "[DEBUG] Lazily projected view #" << next_view << " with "
+            << view.getVertexCount() << " vertices" << std::endl;
+  ++next_view;
+  return true;
+}
+
+} // namespace hollow_lantern
@@ -0,0 +1,136 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the ProjectionSequence class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "ModelData.h"
+#include "Projector.h"
+#include "VertexTransform.h"
+#include "VoxelRayCaster.h"
+#include <SFML/Graphics/VertexArray.hpp>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <vector>
+
+namespace hollow_lantern {
+
+/////////////////////////////////////////////////
+/// @brief Views of a model projected one at a time as they are asked for
+///
+/// The mesh is gathered and the views planned once up front. Faces are culled
+/// the first time a visibility signature is needed and kept for later views
+/// with the same signature, so memory grows with the number of signatures
+/// (at most 64) rather than the number of views.
+///
+/// Views can be pulled with Next into a buffer the caller reuses, or read
+/// with a range for loop, which reuses one buffer inside the sequence.
+/////////////////////////////////////////////////
+class ProjectionSequence {
+
+private:
+  /////////////////////////////////////////////////
+  /// @brief Copy of the projector, for its options
+  /////////////////////////////////////////////////
+  Projector projector;
+
+  /////////////////////////////////////////////////
+  /// @brief Model being projected, must outlive the sequence
+  /////////////////////////////////////////////////
+  const ModelData *model;
+
+  VertexBuffer positions;
+  ProjectionPlan plan;
+
+  /////////////////////////////////////////////////
+  /// @brief Culled faces of each visibility signature, once needed
+  /////////////////////////////////////////////////
+  std::vector<std::optional<VisibleFaces>> groups;
+
+  std::optional<VoxelRayCaster> ray_caster;
+
+  /////////////////////////////////////////////////
+  /// @brief Index of the view Next will produce
+  /////////////////////////////////////////////////
+  size_t next_view{0};
+
+  /////////////////////////////////////////////////
+  /// @brief View the range iterator points at
+  /////////////////////////////////////////////////
+  sf::VertexArray current;
+
+public:
+  /////////////////////////////////////////////////
+  /// @brief Input iterator over the remaining views
+  /////////////////////////////////////////////////
+  class Iterator {
+  private:
+    ProjectionSequence *sequence{nullptr};
+
+  public:
+    using value_type = sf::VertexArray;
+    using difference_type = std::ptrdiff_t;
+
+    Iterator() = default;
+    explicit Iterator(ProjectionSequence *sequence) : sequence(sequence) {};
+
+    const sf::VertexArray &operator*() const { return sequence->current; };
+
+    Iterator &operator++() {
+      if (!sequence->Next(sequence->current))
+        sequence = nullptr;
+      return *this;
+    };
+
+    void operator++(int) { ++*this; };
+
+    bool operator==(std::default_sentinel_t) const {
+      return sequence == nullptr;
+    };
+  };
+
+  /////////////////////////////////////////////////
+  /// @brief Plan the views of a model, without projecting any of them
+  ///
+  /// @param projector Projector whose options are used
+  /// @param model_data ModelData to project, must outlive the sequence
+  /// @param model_matrices One matrix per view, in order
+  /////////////////////////////////////////////////
+  ProjectionSequence(const Projector &projector, const ModelData &model_data,
+                     const std::vector<glm::mat4> &model_matrices);
+
+  /////////////////////////////////////////////////
+  /// @brief Number of views in the whole sequence
+  /////////////////////////////////////////////////
+  size_t Size() const { return plan.model_matrices.size(); };
+
+  /////////////////////////////////////////////////
+  /// @brief Project the next view
+  ///
+  /// @param view Overwritten with the view, a triangle list is written into
+  /// its existing storage
+  /// @param depths If given, overwritten with the depth of every vertex as
+  /// for ModelData::projected_depths
+  /// @return False, leaving view untouched, once every view has been produced
+  /////////////////////////////////////////////////
+  bool Next(sf::VertexArray &view, std::vector<float> *depths = nullptr);
+
+  /////////////////////////////////////////////////
+  /// @brief Start reading the remaining views with a range for loop
+  /////////////////////////////////////////////////
+  Iterator begin() {
+    Iterator iterator(this);
+    return ++iterator;
+  };
+
+  std::default_sentinel_t end() const { return {}; };
+};
+} // namespace hollow_lantern
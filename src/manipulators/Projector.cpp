@@ -5,15 +5,114 @@
 
 #include "Projector.h"
 #include "ModelData.h"
+#include "ParallelFor.h"
+#include "ProjectionSequence.h"
+#include "RegionMerger.h"
+#include "TriangleStripper.h"
+#include "VertexTransform.h"
+#include "VoxelRayCaster.h"
 #include "glm/ext/matrix_transform.hpp"
 #include <SFML/Graphics/PrimitiveType.hpp>
+#include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <limits>
+#include <optional>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace hollow_lantern {
 
+namespace {
+/////////////////////////////////////////////////
+/// @brief Screen rectangle around one or more transformed faces
+/////////////////////////////////////////////////
+struct ScreenBox {
+  float min_x{std::numeric_limits<float>::infinity()};
+  float max_x{-std::numeric_limits<float>::infinity()};
+  float min_y{std::numeric_limits<float>::infinity()};
+  float max_y{-std::numeric_limits<float>::infinity()};
+
+  void Extend(const ScreenBox &other) {
+    min_x = std::min(min_x, other.min_x);
+    max_x = std::max(max_x, other.max_x);
+    min_y = std::min(min_y, other.min_y);
+    max_y = std::max(max_y, other.max_y);
+  }
+
+  /////////////////////////////////////////////////
+  /// @brief Check the insides overlap, boxes that only touch do not
+  /////////////////////////////////////////////////
+  bool Overlaps(const ScreenBox &other) const {
+    return min_x < other.max_x && other.min_x < max_x &&
+           min_y < other.max_y && other.min_y < max_y;
+  }
+};
+
+/////////////////////////////////////////////////
+/// @brief Screen rectangle of face idx of a transformed buffer
+/////////////////////////////////////////////////
+ScreenBox FaceBox(const VertexBuffer &transformed, size_t idx) {
+  ScreenBox box;
+  for (size_t vertex = idx * 3; vertex < idx * 3 + 3; ++vertex) {
+    box.min_x = std::min(box.min_x, transformed.x[vertex]);
+    box.max_x = std::max(box.max_x, transformed.x[vertex]);
+    box.min_y = std::min(box.min_y, transformed.y[vertex]);
+    box.max_y = std::max(box.max_y, transformed.y[vertex]);
+  }
+  return box;
+}
+
+/////////////////////////////////////////////////
+/// @brief Check two transformed faces cover some of the same screen
+///
+/// Separating axis test on the edge normals of both faces. Faces that only
+/// share an edge or a corner, like the halves of a quad, do not overlap.
+/////////////////////////////////////////////////
+bool FacesOverlap(const VertexBuffer &transformed, size_t lhs, size_t rhs) {
+  constexpr float tolerance = 1e-5f;
+  const std::array<std::pair<size_t, size_t>, 2> pairs{std::pair{lhs, rhs},
+                                                        std::pair{rhs, lhs}};
+  for (const auto &[edges, other] : pairs) {
+    for (size_t corner = 0; corner < 3; ++corner) {
+      const size_t from = edges * 3 + corner;
+      const size_t to = edges * 3 + (corner + 1) % 3;
+      const float normal_x = transformed.y[from] - transformed.y[to];
+      const float normal_y = transformed.x[to] - transformed.x[from];
+      auto extent = [&](size_t face) {
+        std::pair<float, float> range{std::numeric_limits<float>::infinity(),
+                                      -std::numeric_limits<float>::infinity()};
+        for (size_t vertex = face * 3; vertex < face * 3 + 3; ++vertex) {
+          const float along = normal_x * transformed.x[vertex] +
+                              normal_y * transformed.y[vertex];
+          range = {std::min(range.first, along),
+                   std::max(range.second, along)};
+        }
+        return range;
+      };
+      const auto [edges_min, edges_max] = extent(edges);
+      const auto [other_min, other_max] = extent(other);
+      const float slack =
+          tolerance * (std::abs(normal_x) + std::abs(normal_y));
+      if (edges_max <= other_min + slack || other_max <= edges_min + slack)
+        return false;
+    }
+  }
+  return true;
+}
+} // namespace
+
+/////////////////////////////////////////////////
+Projector::Projector(size_t thread_count) {
+  options.thread_count = thread_count;
+}
+
+/////////////////////////////////////////////////
+Projector::Projector(const ProjectionOptions &options) : options(options) {}
+
 /////////////////////////////////////////////////
 void Projector::BasicProjection(ModelData &model_data,
                                 const glm::vec3 &tilt_angle,
@@ -26,81 +125,196 @@ void Projector::BasicProjection(ModelData &model_data,
             << ", rotation_axis=(" << rotation_axis.x << ", " << rotation_axis.y
             << ", " << rotation_axis.z << ")" << std::endl;
 
-  std::vector<glm::vec3> rotation_positions;
-  if (rotation_axis.x != 0.0f) {
-    std::cout << "[DEBUG] Using X-axis rotation" << std::endl;
-    for (size_t i = 0; i < intervals; ++i) {
-      float angle =
-          static_cast<float>(i) * (360.0f / static_cast<float>(intervals));
-      rotation_positions.emplace_back(angle, 0.0f, 0.0f);
-      std::cout << "[DEBUG] Rotation position: (" << angle << ", 0, 0)"
-                << std::endl;
-    }
-  } else if (rotation_axis.y != 0.0f) {
-    std::cout << "[DEBUG] Using Y-axis rotation" << std::endl;
-    for (size_t i = 0; i < intervals; ++i) {
-      float angle =
-          static_cast<float>(i) * (360.0f / static_cast<float>(intervals));
-      rotation_positions.emplace_back(0.0f, angle, 0.0f);
-      std::cout << "[DEBUG] Rotation position: (0, " << angle << ", 0)"
-                << std::endl;
-    }
-  } else if (rotation_axis.z != 0.0f) {
-    std::cout << "[DEBUG] Using Z-axis rotation" << std::endl;
-    for (size_t i = 0; i < intervals; ++i) {
-      float angle =
-          static_cast<float>(i) * (360.0f / static_cast<float>(intervals));
-      rotation_positions.emplace_back(0.0f, 0.0f, angle);
-      std::cout << "[DEBUG] Rotation position: (0, 0, " << angle << ")"
-                << std::endl;
-    }
-  } else {
-    std::cout << "[DEBUG] No rotation axis specified, defaulting to Y-axis"
-              << std::endl;
-    for (size_t i = 0; i < intervals; ++i) {
-      float angle =
-          static_cast<float>(i) * (360.0f / static_cast<float>(intervals));
-      rotation_positions.emplace_back(0.0f, angle, 0.0f);
-      std::cout << "[DEBUG] Rotation position: (0, " << angle << ", 0)"
-                << std::endl;
+  ProjectModelMatrices(
+      model_data,
+      GenerateModelMatrices(model_data, tilt_angle,
+                            TurntableRotations(intervals, rotation_axis)));
+}
+
+/////////////////////////////////////////////////
+ProjectionSequence
+Projector::LazyProjection(const ModelData &model_data,
+                          const glm::vec3 &tilt_angle, const size_t intervals,
+                          const glm::vec3 &rotation_axis) const {
+  std::cout << "[DEBUG] Starting LazyProjection with intervals=" << intervals
+            << std::endl;
+  return ProjectionSequence(
+      *this, model_data,
+      GenerateModelMatrices(model_data, tilt_angle,
+                            TurntableRotations(intervals, rotation_axis)));
+}
+
+/////////////////////////////////////////////////
+void Projector::BatchProjection(
+    ModelData &model_data, const std::vector<glm::vec3> &rotations) const {
+  std::cout << "[DEBUG] Starting BatchProjection with " << rotations.size()
+            << " rotations" << std::endl;
+  ProjectModelMatrices(model_data,
+                       GenerateModelMatrices(model_data, {0.0f, 0.0f, 0.0f},
+                                             rotations));
+}
+
+/////////////////////////////////////////////////
+void Projector::GridProjection(ModelData &model_data,
+                               const std::vector<float> &pitches,
+                               const size_t yaw_intervals) const {
+  std::cout << "[DEBUG] Starting GridProjection with " << pitches.size()
+            << " pitches x " << yaw_intervals << " yaws" << std::endl;
+  std::vector<glm::vec3> yaws;
+  for (size_t i = 0; i < yaw_intervals; ++i) {
+    yaws.emplace_back(0.0f,
+                      static_cast<float>(i) *
+                          (360.0f / static_cast<float>(yaw_intervals)),
+                      0.0f);
+  }
+  // every pitch shares one pass, so the mesh is gathered and each
+  // visibility signature culled once for the whole grid
+  std::vector<glm::mat4> model_matrices;
+  model_matrices.reserve(pitches.size() * yaws.size());
+  for (const float pitch : pitches) {
+    for (const glm::mat4 &model_matrix :
+         GenerateModelMatrices(model_data, {pitch, 0.0f, 0.0f}, yaws)) {
+      model_matrices.push_back(model_matrix);
     }
   }
+  ProjectModelMatrices(model_data, model_matrices);
+}
 
-  std::vector<glm::mat4> model_matrices =
-      GenerateModelMatrices(model_data, tilt_angle, rotation_positions);
-
-  std::cout << "[DEBUG] Generated " << model_matrices.size()
+/////////////////////////////////////////////////
+void Projector::ProjectModelMatrices(
+    ModelData &model_data, const std::vector<glm::mat4> &model_matrices) const {
+  std::cout << "[DEBUG] Projecting " << model_matrices.size()
             << " model matrices" << std::endl;
 
+  // every view only reads the shared mesh and its own matrix, so views are
+  // projected concurrently into slots reserved up front
+  const std::vector<Triangle> &mesh = model_data.triangles;
+  // positions are gathered once and shared by every view's transform
+  const VertexBuffer positions = VertexBuffer::FromTriangles(mesh);
+  std::cout << "[DEBUG] Transforming with the " << VertexTransformKernelName()
+            << " kernel" << std::endl;
+  const ProjectionPlan plan = PlanViews(model_data, model_matrices);
+
+  const size_t thread_count = options.thread_count;
+  std::vector<VisibleFaces> groups(plan.group_facing.size());
+  ParallelFor(groups.size(), thread_count, [&](size_t group_idx) {
+    groups[group_idx] =
+        CullFaces(mesh, positions, plan.group_facing[group_idx]);
+  });
+  // counts are printed after the join so lines from workers never interleave
+  for (size_t group_idx = 0; group_idx < groups.size(); ++group_idx) {
+    std::cout << "[DEBUG] Visibility signature #" << group_idx << " culled "
+              << mesh.size() - groups[group_idx].triangles.size() << " of "
+              << mesh.size() << " triangles" << std::endl;
+  }
+
+  const std::optional<VoxelRayCaster> ray_caster = MakeRayCaster(model_data);
+  std::vector<sf::VertexArray> views(model_matrices.size());
+  std::vector<std::vector<uint32_t>> sources(model_matrices.size());
+  std::vector<std::vector<float>> depths(model_matrices.size());
+  ParallelFor(model_matrices.size(), thread_count, [&](size_t mat_idx) {
+    ProjectPlannedView(mesh, plan, groups[plan.view_group[mat_idx]],
+                       ray_caster.has_value() ? &ray_caster.value() : nullptr,
+                       mat_idx, views[mat_idx], &sources[mat_idx],
+                       &depths[mat_idx]);
+  });
+
+  model_data.projected_data.reserve(model_data.projected_data.size() +
+                                    views.size());
+  model_data.projected_sources.resize(model_data.projected_data.size());
+  model_data.projected_depths.resize(model_data.projected_data.size());
+  for (size_t mat_idx = 0; mat_idx < views.size(); ++mat_idx) {
+    std::cout << "[DEBUG] Projected data #" << mat_idx << " has "
+              << views[mat_idx].getVertexCount() << " vertices" << std::endl;
+    model_data.projected_data.push_back(std::move(views[mat_idx]));
+    model_data.projected_sources.push_back(std::move(sources[mat_idx]));
+    model_data.projected_depths.push_back(std::move(depths[mat_idx]));
+  }
+}
+
+/////////////////////////////////////////////////
+ProjectionPlan
+Projector::PlanViews(const ModelData &model_data,
+                     const std::vector<glm::mat4> &model_matrices) const {
+  ProjectionPlan plan;
+  plan.model_matrices = model_matrices;
+
+  // views turned by whole quarter turns skip the matrix and are remapped
+  plan.voxel_scale = static_cast<float>(model_data.voxel_scale);
+  plan.model_center = glm::vec3(static_cast<float>(model_data.size.x),
+                                static_cast<float>(model_data.size.y),
+                                static_cast<float>(model_data.size.z)) *
+                      plan.voxel_scale * 0.5f;
+  plan.remaps.resize(model_matrices.size());
   for (size_t mat_idx = 0; mat_idx < model_matrices.size(); ++mat_idx) {
-    const auto &model_matric = model_matrices[mat_idx];
-    std::cout << "[DEBUG] Processing model matrix #" << mat_idx << std::endl;
-    std::vector<Triangle> triangles = model_data.triangles;
-
-    for (size_t tri_idx = 0; tri_idx < triangles.size(); ++tri_idx) {
-      for (size_t vert_idx = 0; vert_idx < triangles[tri_idx].vertices.size();
-           ++vert_idx) {
-        glm::vec4 transformed_vertex =
-            model_matric *
-            glm::vec4(triangles[tri_idx].vertices[vert_idx], 1.0f);
-        triangles[tri_idx].vertices[vert_idx] = glm::vec3(
-            transformed_vertex.x, transformed_vertex.y, transformed_vertex.z);
-      }
-    }
+    plan.remaps[mat_idx] =
+        SnapToQuarterTurns(model_matrices[mat_idx], plan.voxel_scale);
+    if (plan.remaps[mat_idx].has_value())
+      std::cout << "[DEBUG] View #" << mat_idx
+                << " is a quarter turn, remapping axes exactly" << std::endl;
+  }
 
-    std::cout << "[DEBUG] Before back face culling: " << triangles.size()
-              << " triangles" << std::endl;
-    // ImplementBackFaceCulling(triangles);
-    ImplementCullingWithDirections(triangles, model_matric);
-    std::cout << "[DEBUG] After back face culling: " << triangles.size()
-              << " triangles" << std::endl;
+  // the facing directions only change at a few angles, so views are grouped
+  // by their visibility signature and each group is culled once
+  constexpr size_t no_group = std::numeric_limits<size_t>::max();
+  std::array<size_t, 64> group_of_signature;
+  group_of_signature.fill(no_group);
+  plan.view_group.resize(model_matrices.size());
+  for (size_t mat_idx = 0; mat_idx < model_matrices.size(); ++mat_idx) {
+    const std::array<bool, 6> facing =
+        plan.remaps[mat_idx].has_value()
+            ? FacingDirections(plan.remaps[mat_idx].value())
+            : FacingDirections(model_matrices[mat_idx]);
+    const uint8_t signature = FacingSignature(facing);
+    if (group_of_signature[signature] == no_group) {
+      group_of_signature[signature] = plan.group_facing.size();
+      plan.group_facing.push_back(facing);
+    }
+    plan.view_group[mat_idx] = group_of_signature[signature];
+  }
+  std::cout << "[DEBUG] " << model_matrices.size() << " views share "
+            << plan.group_facing.size() << " visibility signatures"
+            << std::endl;
+  return plan;
+}
 
-    sf::VertexArray projected_data = ProjectOntoVertexArray(triangles);
-    std::cout << "[DEBUG] Projected data has "
-              << projected_data.getVertexCount() << " vertices" << std::endl;
+/////////////////////////////////////////////////
+std::optional<VoxelRayCaster>
+Projector::MakeRayCaster(const ModelData &model_data) const {
+  if (!options.ray_cast_visibility)
+    return std::nullopt;
+  // ray casting needs the voxels, models loaded from the cache have none
+  if (model_data.voxel_data.empty()) {
+    std::cout << "[DEBUG] No voxels to ray cast for " << model_data.name
+              << ", keeping every front face" << std::endl;
+    return std::nullopt;
+  }
+  return VoxelRayCaster(model_data, options.rays_per_voxel);
+}
 
-    model_data.projected_data.push_back(projected_data);
+/////////////////////////////////////////////////
+void Projector::ProjectPlannedView(const std::vector<Triangle> &mesh,
+                                   const ProjectionPlan &plan,
+                                   const VisibleFaces &group,
+                                   const VoxelRayCaster *ray_caster,
+                                   size_t view, sf::VertexArray &result,
+                                   std::vector<uint32_t> *sources,
+                                   std::vector<float> *depths) const {
+  const VisibleFaces *visible = &group;
+  VisibleFaces hit;
+  if (ray_caster != nullptr) {
+    // the caster ignores the translation and scale of the model matrix
+    hit = KeepFaces(group, ray_caster->VisibleTriangles(
+                               mesh, plan.model_matrices[view]));
+    visible = &hit;
   }
+  if (plan.remaps[view].has_value())
+    RemapVisibleFaces(mesh, *visible, plan.remaps[view].value(),
+                      plan.voxel_scale, plan.model_center, result, sources,
+                      depths);
+  else
+    ProjectVisibleFaces(mesh, *visible, plan.model_matrices[view], result,
+                        sources, depths);
 }
 
 /////////////////////////////////////////////////
@@ -108,12 +322,16 @@ void Projector::FixedAngleProjection(ModelData &model_data,
                                      const glm::vec3 &rotation) {
 
   // translate the model to the origin first
+  const float voxel_scale = static_cast<float>(model_data.voxel_scale);
   glm::vec3 model_size{static_cast<float>(model_data.size.x),
                        static_cast<float>(model_data.size.y),
                        static_cast<float>(model_data.size.z)};
-  glm::vec3 model_center = model_size * 0.5f;
+  glm::vec3 model_center = model_size * voxel_scale * 0.5f;
   glm::mat4 translate_to_origin =
       glm::translate(glm::mat4(1.0f), -model_center);
+  // levels of detail are meshed in their own voxel units
+  glm::mat4 scale_to_source =
+      glm::scale(glm::mat4(1.0f), glm::vec3(voxel_scale));
   // create a one time rotation matrix and apply it to all triangles
   glm::mat4 rotation_matrix =
       glm::rotate(glm::mat4(1.0f), glm::radians(rotation.x),
@@ -125,47 +343,199 @@ void Projector::FixedAngleProjection(ModelData &model_data,
 
   // create an an overall model matrix that translates to origin, rotates and
   // then translates back
-  glm::mat4 model_matrix =
-      -translate_to_origin * rotation_matrix * translate_to_origin;
+  glm::mat4 model_matrix = -translate_to_origin * rotation_matrix *
+                           translate_to_origin * scale_to_source;
 
   std::cout << "[DEBUG] FixedAngleProjection with rotation: (" << rotation.x
             << ", " << rotation.y << ", " << rotation.z << ")" << std::endl;
-  std::vector<Triangle> triangles = model_data.triangles;
-  for (size_t tri_idx = 0; tri_idx < triangles.size(); ++tri_idx) {
-    for (size_t vert_idx = 0; vert_idx < triangles[tri_idx].vertices.size();
-         ++vert_idx) {
-      glm::vec4 transformed_vertex =
-          model_matrix * glm::vec4(triangles[tri_idx].vertices[vert_idx], 1.0f);
-      triangles[tri_idx].vertices[vert_idx] = glm::vec3(
-          transformed_vertex.x, transformed_vertex.y, transformed_vertex.z);
-    }
-  }
-  std::cout << "[DEBUG] Before back face culling: " << triangles.size()
-            << " triangles" << std::endl;
-  // ImplementBackFaceCulling(triangles);
-
-  ImplementCullingWithDirections(triangles, rotation_matrix);
-  std::cout << "[DEBUG] After back face culling: " << triangles.size()
-            << " triangles" << std::endl;
-  sf::VertexArray projected_data = ProjectOntoVertexArray(triangles);
+  sf::VertexArray projected_data =
+      ProjectView(model_data.triangles,
+                  VertexBuffer::FromTriangles(model_data.triangles),
+                  model_matrix, rotation_matrix);
 
   std::cout << "[DEBUG] Projected data has " << projected_data.getVertexCount()
             << " vertices" << std::endl;
   model_data.projected_data.push_back(projected_data);
+  model_data.projected_sources.resize(model_data.projected_data.size());
+  model_data.projected_depths.resize(model_data.projected_data.size());
+}
+/////////////////////////////////////////////////
+bool Projector::AxisAlignedProjection(ModelData &model_data,
+                                      Direction facing) const {
+  if (facing == Direction::NONE) {
+    std::cout << "[DEBUG] AxisAlignedProjection needs a direction"
+              << std::endl;
+    return false;
+  }
+  const QuarterTurnRemap remap = RemapFacing(facing);
+
+  // the masks must still match the model, ResizeMasks sizes every dimension
+  const Mask &mask = model_data.masks[static_cast<size_t>(facing) - 1];
+  const std::array<int, 3> extent{model_data.size.x, model_data.size.y,
+                                  model_data.size.z};
+  const int axis = (static_cast<int>(facing) - 1) / 2;
+  const bool has_mask =
+      mask.data.size() == static_cast<size_t>(extent[axis]) &&
+      !mask.data.empty() &&
+      mask.data[0].size() == static_cast<size_t>(extent[(axis + 1) % 3]) &&
+      !mask.data[0].empty() &&
+      mask.data[0][0].size() == static_cast<size_t>(extent[(axis + 2) % 3]);
+
+  sf::VertexArray projected_data;
+  // the front layer is built from the masks, so only the mesh has sources,
+  // and only the mesh has faces that can overlap and need depths
+  std::vector<uint32_t> sources;
+  std::vector<float> depths;
+  if (has_mask) {
+    projected_data = ProjectFrontLayer(model_data, facing, remap);
+  } else {
+    std::cout << "[DEBUG] No masks for " << model_data.name
+              << ", projecting the mesh instead" << std::endl;
+    const float voxel_scale = static_cast<float>(model_data.voxel_scale);
+    const glm::vec3 model_center =
+        glm::vec3(static_cast<float>(model_data.size.x),
+                  static_cast<float>(model_data.size.y),
+                  static_cast<float>(model_data.size.z)) *
+        voxel_scale * 0.5f;
+    const std::vector<Triangle> &mesh = model_data.triangles;
+    RemapVisibleFaces(mesh,
+                      CullFaces(mesh, VertexBuffer::FromTriangles(mesh),
+                                FacingDirections(remap)),
+                      remap, voxel_scale, model_center, projected_data,
+                      &sources, &depths);
+  }
+
+  std::cout << "[DEBUG] Axis aligned projection has "
+            << projected_data.getVertexCount() << " vertices" << std::endl;
+  model_data.projected_data.push_back(std::move(projected_data));
+  model_data.projected_sources.resize(model_data.projected_data.size() - 1);
+  model_data.projected_sources.push_back(std::move(sources));
+  model_data.projected_depths.resize(model_data.projected_data.size() - 1);
+  model_data.projected_depths.push_back(std::move(depths));
+  return true;
+}
+
+/////////////////////////////////////////////////
+size_t Projector::SelectLevelOfDetail(const ModelData &model_data,
+                                      const float pixels_per_unit,
+                                      const float target_voxel_size) const {
+  // level 0 is the model itself, level n is levels_of_detail[n - 1]. Pick the
+  // finest level whose voxels are at least the target size on screen.
+  for (size_t level = 0; level <= model_data.levels_of_detail.size();
+       ++level) {
+    const int voxel_scale =
+        level == 0 ? model_data.voxel_scale
+                   : model_data.levels_of_detail[level - 1].voxel_scale;
+    if (static_cast<float>(voxel_scale) * pixels_per_unit >=
+        target_voxel_size) {
+      return level;
+    }
+  }
+  // even the coarsest level is below the target, it is still the cheapest
+  return model_data.levels_of_detail.size();
+}
+
+/////////////////////////////////////////////////
+void Projector::LevelOfDetailProjection(ModelData &model_data,
+                                        const glm::vec3 &tilt_angle,
+                                        const size_t intervals,
+                                        const glm::vec3 &rotation_axis,
+                                        const float pixels_per_unit,
+                                        const float target_voxel_size) const {
+  size_t level =
+      SelectLevelOfDetail(model_data, pixels_per_unit, target_voxel_size);
+  std::cout << "[DEBUG] Projecting level of detail " << level << std::endl;
+  if (level == 0) {
+    BasicProjection(model_data, tilt_angle, intervals, rotation_axis);
+    return;
+  }
+
+  // project the coarse level, but hand the views to the source model so
+  // exporting and drawing don't need to know which level was used
+  ModelData &coarse = model_data.levels_of_detail[level - 1];
+  coarse.projected_data.clear();
+  coarse.projected_sources.clear();
+  coarse.projected_depths.clear();
+  BasicProjection(coarse, tilt_angle, intervals, rotation_axis);
+  // depths are in source units like the positions, so they carry over
+  model_data.projected_depths.resize(model_data.projected_data.size());
+  coarse.projected_depths.resize(coarse.projected_data.size());
+  for (size_t view = 0; view < coarse.projected_data.size(); ++view) {
+    model_data.projected_data.push_back(
+        std::move(coarse.projected_data[view]));
+    model_data.projected_depths.push_back(
+        std::move(coarse.projected_depths[view]));
+  }
+  // the coarse views' sources index the coarse mesh, not this one
+  model_data.projected_sources.resize(model_data.projected_data.size());
+  coarse.projected_data.clear();
+  coarse.projected_sources.clear();
+  coarse.projected_depths.clear();
+}
+
+/////////////////////////////////////////////////
+std::vector<glm::vec3>
+Projector::TurntableRotations(const size_t intervals,
+                              const glm::vec3 &rotation_axis) const {
+  std::vector<glm::vec3> rotation_positions;
+  if (rotation_axis.x != 0.0f) {
+    std::cout << "[DEBUG] Using X-axis rotation" << std::endl;
+    for (size_t i = 0; i < intervals; ++i) {
+      float angle =
+          static_cast<float>(i) * (360.0f / static_cast<float>(intervals));
+      rotation_positions.emplace_back(angle, 0.0f, 0.0f);
+      std::cout << "[DEBUG] Rotation position: (" << angle << ", 0, 0)"
+                << std::endl;
+    }
+  } else if (rotation_axis.y != 0.0f) {
+    std::cout << "[DEBUG] Using Y-axis rotation" << std::endl;
+    for (size_t i = 0; i < intervals; ++i) {
+      float angle =
+          static_cast<float>(i) * (360.0f / static_cast<float>(intervals));
+      rotation_positions.emplace_back(0.0f, angle, 0.0f);
+      std::cout << "[DEBUG] Rotation position: (0, " << angle << ", 0)"
+                << std::endl;
+    }
+  } else if (rotation_axis.z != 0.0f) {
+    std::cout << "[DEBUG] Using Z-axis rotation" << std::endl;
+    for (size_t i = 0; i < intervals; ++i) {
+      float angle =
+          static_cast<float>(i) * (360.0f / static_cast<float>(intervals));
+      rotation_positions.emplace_back(0.0f, 0.0f, angle);
+      std::cout << "[DEBUG] Rotation position: (0, 0, " << angle << ")"
+                << std::endl;
+    }
+  } else {
+    std::cout << "[DEBUG] No rotation axis specified, defaulting to Y-axis"
+              << std::endl;
+    for (size_t i = 0; i < intervals; ++i) {
+      float angle =
+          static_cast<float>(i) * (360.0f / static_cast<float>(intervals));
+      rotation_positions.emplace_back(0.0f, angle, 0.0f);
+      std::cout << "[DEBUG] Rotation position: (0, " << angle << ", 0)"
+                << std::endl;
+    }
+  }
+  return rotation_positions;
 }
+
 /////////////////////////////////////////////////
 std::vector<glm::mat4> Projector::GenerateModelMatrices(
-    ModelData &model_data, const glm::vec3 &tilt,
+    const ModelData &model_data, const glm::vec3 &tilt,
     const std::vector<glm::vec3> &rotation_positions) const {
 
   std::vector<glm::mat4> model_matrices;
+  const float voxel_scale = static_cast<float>(model_data.voxel_scale);
   glm::vec3 model_size{static_cast<float>(model_data.size.x),
                        static_cast<float>(model_data.size.y),
                        static_cast<float>(model_data.size.z)};
-  glm::vec3 model_center = model_size * 0.5f;
+  glm::vec3 model_center = model_size * voxel_scale * 0.5f;
 
   glm::mat4 translate_to_origin =
       glm::translate(glm::mat4(1.0f), -model_center);
+  // levels of detail are meshed in their own voxel units
+  glm::mat4 scale_to_source =
+      glm::scale(glm::mat4(1.0f), glm::vec3(voxel_scale));
   glm::mat4 tilt_matrix = glm::rotate(glm::mat4(1.0f), glm::radians(tilt.x),
                                       glm::vec3(1.0f, 0.0f, 0.0f));
 
@@ -179,7 +549,7 @@ std::vector<glm::mat4> Projector::GenerateModelMatrices(
         glm::rotate(glm::mat4(1.0f), glm::radians(rotation_position.z),
                     glm::vec3(0.0f, 0.0f, 1.0f));
     glm::mat4 model_matrix =
-        rotation_matrix * tilt_matrix * translate_to_origin;
+        rotation_matrix * tilt_matrix * translate_to_origin * scale_to_source;
     model_matrices.push_back(model_matrix);
     std::cout << "[DEBUG] Generated model matrix #" << idx << std::endl;
   }
@@ -187,148 +557,558 @@ std::vector<glm::mat4> Projector::GenerateModelMatrices(
 }
 
 /////////////////////////////////////////////////
-void Projector::ImplementBackFaceCulling(
-    std::vector<Triangle> &triangles) const {
+sf::VertexArray Projector::ProjectView(const std::vector<Triangle> &mesh,
+                                       const VertexBuffer &positions,
+                                       const glm::mat4 &model_matrix,
+                                       const glm::mat4 &rotation) const {
+  // which way each direction faces only depends on the rotation, so culling
+  // happens before any vertex is transformed
+  sf::VertexArray result;
+  ProjectVisibleFaces(mesh,
+                      CullFaces(mesh, positions, FacingDirections(rotation)),
+                      model_matrix, result);
+  return result;
+}
 
-  size_t culled_count = 0;
-  for (auto it = triangles.begin(); it != triangles.end();) {
-    const auto &v0 = it->vertices[0];
-    const auto &v1 = it->vertices[1];
-    const auto &v2 = it->vertices[2];
+/////////////////////////////////////////////////
+VisibleFaces Projector::CullFaces(const std::vector<Triangle> &mesh,
+                                  const VertexBuffer &positions,
+                                  const std::array<bool, 6> &facing) const {
+  // one stable pass gathers the surviving faces and their positions
+  VisibleFaces visible;
+  visible.triangles.reserve(mesh.size());
+  visible.positions.x.reserve(positions.Size());
+  visible.positions.y.reserve(positions.Size());
+  visible.positions.z.reserve(positions.Size());
+  for (size_t tri_idx = 0; tri_idx < mesh.size(); ++tri_idx) {
+    if (!IsFacing(facing, mesh[tri_idx].direction))
+      continue;
+    visible.triangles.push_back(tri_idx);
+    for (size_t vert_idx = tri_idx * 3; vert_idx < tri_idx * 3 + 3;
+         ++vert_idx) {
+      visible.positions.x.push_back(positions.x[vert_idx]);
+      visible.positions.y.push_back(positions.y[vert_idx]);
+      visible.positions.z.push_back(positions.z[vert_idx]);
+    }
+  }
+  return visible;
+}
 
-    glm::vec3 edge1 = v1 - v0;
-    glm::vec3 edge2 = v2 - v0;
-    glm::vec3 normal = glm::normalize(glm::cross(edge1, edge2));
+/////////////////////////////////////////////////
+VisibleFaces Projector::KeepFaces(const VisibleFaces &visible,
+                                  const std::vector<bool> &keep) const {
+  VisibleFaces kept;
+  for (size_t idx = 0; idx < visible.triangles.size(); ++idx) {
+    if (!keep[visible.triangles[idx]])
+      continue;
+    kept.triangles.push_back(visible.triangles[idx]);
+    for (size_t vertex = idx * 3; vertex < idx * 3 + 3; ++vertex) {
+      kept.positions.x.push_back(visible.positions.x[vertex]);
+      kept.positions.y.push_back(visible.positions.y[vertex]);
+      kept.positions.z.push_back(visible.positions.z[vertex]);
+    }
+  }
+  return kept;
+}
 
-    // Debug print normal
+/////////////////////////////////////////////////
+void Projector::ProjectVisibleFaces(const std::vector<Triangle> &mesh,
+                                    const VisibleFaces &visible,
+                                    const glm::mat4 &model_matrix,
+                                    sf::VertexArray &result,
+                                    std::vector<uint32_t> *sources,
+                                    std::vector<float> *depths) const {
+  // the projection drops z, so unless it is needed to remove hidden surfaces
+  // or kept as depth only the x and y rows are evaluated
+  VertexBuffer transformed;
+  TransformVertices(model_matrix, visible.positions, transformed,
+                    options.remove_hidden_surfaces ||
+                        (options.keep_depth && depths != nullptr));
+  FlattenFaces(mesh, visible, transformed, result, sources, depths);
+}
 
-    if (normal.z > 0.0f) {
-      it = triangles.erase(it);
-      ++culled_count;
+/////////////////////////////////////////////////
+void Projector::FlattenFaces(const std::vector<Triangle> &mesh,
+                             const VisibleFaces &visible,
+                             const VertexBuffer &transformed,
+                             sf::VertexArray &result,
+                             std::vector<uint32_t> *sources,
+                             std::vector<float> *depths) const {
+  std::vector<size_t> order;
+  if (options.remove_hidden_surfaces) {
+    order = OrderVisibleFaces(transformed);
+  } else {
+    order.resize(visible.triangles.size());
+    for (size_t idx = 0; idx < order.size(); ++idx)
+      order[idx] = idx;
+  }
+  // merged regions come out grouped by colour already
+  if (options.batch_by_color && !options.merge_regions) {
+    // a face joins the last run of its colour, moving ahead of every face
+    // drawn since, unless it overlaps one of another colour and would swap
+    // which is on top. Then it starts a new run
+    struct ColorRun {
+      uint32_t color;
+      ScreenBox box;
+      std::vector<size_t> faces;
+    };
+    std::vector<ColorRun> runs;
+    std::unordered_map<uint32_t, size_t> last_run_of_color;
+    for (const size_t idx : order) {
+      const uint32_t color = mesh[visible.triangles[idx]].color.toInteger();
+      const ScreenBox box = FaceBox(transformed, idx);
+      const auto found = last_run_of_color.find(color);
+      bool can_join = found != last_run_of_color.end();
+      for (size_t run = can_join ? found->second + 1 : runs.size();
+           run < runs.size() && can_join; ++run) {
+        if (runs[run].color == color || !runs[run].box.Overlaps(box))
+          continue;
+        for (const size_t other : runs[run].faces) {
+          if (FacesOverlap(transformed, idx, other)) {
+            can_join = false;
+            break;
+          }
+        }
+      }
+      if (!can_join) {
+        last_run_of_color[color] = runs.size();
+        runs.push_back({color, {}, {}});
+      }
+      ColorRun &run = runs[last_run_of_color[color]];
+      run.box.Extend(box);
+      run.faces.push_back(idx);
+    }
+    order.clear();
+    for (const ColorRun &run : runs)
+      order.insert(order.end(), run.faces.begin(), run.faces.end());
+  }
 
-    } else {
-      ++it; // Only increment if not erasing!
+  // every vertex is overwritten, so resizing keeps the caller's storage
+  result.setPrimitiveType(sf::PrimitiveType::Triangles);
+  result.resize(order.size() * 3);
+  for (size_t out_idx = 0; out_idx < order.size(); ++out_idx) {
+    const size_t idx = order[out_idx];
+    const Triangle &triangle = mesh[visible.triangles[idx]];
+    for (size_t vert_idx = 0; vert_idx < 3; ++vert_idx) {
+      const size_t vertex = idx * 3 + vert_idx;
+      const glm::vec2 &tex_coord = triangle.tex_coords[vert_idx];
+      result[out_idx * 3 + vert_idx] = sf::Vertex{
+          sf::Vector2f(transformed.x[vertex], transformed.y[vertex]),
+          triangle.color, sf::Vector2f(tex_coord.x, tex_coord.y)};
+    }
+  }
+  if (sources != nullptr) {
+    sources->clear();
+    // merged regions no longer come from any single face
+    if (!options.merge_regions) {
+      sources->reserve(order.size());
+      for (const size_t idx : order)
+        sources->push_back(static_cast<uint32_t>(visible.triangles[idx]));
+    }
+  }
+  if (depths != nullptr) {
+    depths->clear();
+    // merged regions cannot overlap, so they are drawn right without them
+    if (options.keep_depth && !options.merge_regions) {
+      depths->resize(order.size() * 3);
+      for (size_t out_idx = 0; out_idx < order.size(); ++out_idx) {
+        for (size_t vert_idx = 0; vert_idx < 3; ++vert_idx) {
+          (*depths)[out_idx * 3 + vert_idx] =
+              transformed.z[order[out_idx] * 3 + vert_idx];
+        }
+      }
+    }
+  }
+  if (options.merge_regions)
+    result = RegionMerger().MergeRegions(result);
+  if (options.triangle_strips) {
+    // strip vertices are only shared where their depths match too, so every
+    // strip vertex keeps the depth of the vertex it copies
+    const bool has_depths = depths != nullptr && !depths->empty();
+    std::vector<size_t> origins;
+    result = TriangleStripper().Stripify(result, &origins,
+                                         has_depths ? depths : nullptr);
+    // every strip triangle ends on a vertex of the face it was cut from,
+    // joins included, so picking can still find the face behind it
+    if (sources != nullptr && !sources->empty() && !origins.empty()) {
+      std::vector<uint32_t> strip_sources(origins.size() - 2);
+      for (size_t tri_idx = 0; tri_idx < strip_sources.size(); ++tri_idx)
+        strip_sources[tri_idx] = (*sources)[origins[tri_idx + 2] / 3];
+      *sources = std::move(strip_sources);
+    }
+    if (has_depths && !origins.empty()) {
+      std::vector<float> strip_depths(origins.size());
+      for (size_t vertex = 0; vertex < origins.size(); ++vertex)
+        strip_depths[vertex] = (*depths)[origins[vertex]];
+      *depths = std::move(strip_depths);
     }
   }
-  std::cout << "[DEBUG] Culled total " << culled_count << " triangles"
-            << std::endl;
 }
 
 /////////////////////////////////////////////////
-void Projector::ImplementCullingWithDirections(
-    std::vector<Triangle> &triangles, const glm::mat4 &rotation) const {
-  size_t culled_count = 0;
+std::vector<size_t>
+Projector::OrderVisibleFaces(const VertexBuffer &transformed) const {
+  const size_t face_count = transformed.Size() / 3;
+  if (face_count == 0)
+    return {};
 
-  // create vectors to represent the masks for each direction
-  std::array<glm::vec3, 6> face_vectors{
-      (glm::vec3(1.0f, 0.0f, 0.0f)),  // X_POSITIVE
-      (glm::vec3(-1.0f, 0.0f, 0.0f)), // X_NEGATIVE
-      (glm::vec3(0.0f, 1.0f, 0.0f)),  // Y_POSITIVE
-      (glm::vec3(0.0f, -1.0f, 0.0f)), // Y_NEGATIVE
-      (glm::vec3(0.0f, 0.0f, 1.0f)),  // Z_POSITIVE
-      (glm::vec3(0.0f, 0.0f, -1.0f))  // Z_NEGATIVE
+  // sample grid covering every face, at a fixed density in source units
+  const float density = options.hidden_surface_samples;
+  const auto [min_x, max_x] =
+      std::minmax_element(transformed.x.begin(), transformed.x.end());
+  const auto [min_y, max_y] =
+      std::minmax_element(transformed.y.begin(), transformed.y.end());
+  const float origin_x = *min_x;
+  const float origin_y = *min_y;
+  const size_t width =
+      static_cast<size_t>(std::ceil((*max_x - origin_x) * density)) + 1;
+  const size_t height =
+      static_cast<size_t>(std::ceil((*max_y - origin_y) * density)) + 1;
+
+  // faces touching along an edge share depths there, so nearly equal
+  // depths count as a tie rather than one face hiding the other
+  constexpr float depth_tolerance = 1e-3f;
+  std::vector<float> nearest(width * height,
+                             std::numeric_limits<float>::infinity());
 
+  // visit every sample inside a face, passing the face's depth there
+  auto for_each_sample = [&](size_t face, auto &&visit) {
+    const size_t v0 = face * 3;
+    const glm::vec3 a(transformed.x[v0], transformed.y[v0], transformed.z[v0]);
+    const glm::vec3 b(transformed.x[v0 + 1], transformed.y[v0 + 1],
+                      transformed.z[v0 + 1]);
+    const glm::vec3 c(transformed.x[v0 + 2], transformed.y[v0 + 2],
+                      transformed.z[v0 + 2]);
+    const float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    if (std::abs(area) < 1e-12f)
+      return; // edge on, covers nothing
+    // samples sit at cell centres, only those in the face's box are tested
+    auto sample_range = [&](float lowest, float highest, float origin,
+                            size_t count) {
+      const float first = std::ceil((lowest - origin) * density - 0.5f);
+      const float last = std::floor((highest - origin) * density - 0.5f);
+      return std::pair<size_t, size_t>{
+          static_cast<size_t>(std::max(first, 0.0f)),
+          std::min(static_cast<size_t>(std::max(last, 0.0f)), count - 1)};
+    };
+    const auto [x_begin, x_end] =
+        sample_range(std::min({a.x, b.x, c.x}), std::max({a.x, b.x, c.x}),
+                     origin_x, width);
+    const auto [y_begin, y_end] =
+        sample_range(std::min({a.y, b.y, c.y}), std::max({a.y, b.y, c.y}),
+                     origin_y, height);
+    for (size_t row = y_begin; row <= y_end; ++row) {
+      const float py = origin_y + (static_cast<float>(row) + 0.5f) / density;
+      for (size_t col = x_begin; col <= x_end; ++col) {
+        const float px = origin_x + (static_cast<float>(col) + 0.5f) / density;
+        // barycentric weights, edges are inclusive
+        const float w_a =
+            ((b.x - px) * (c.y - py) - (b.y - py) * (c.x - px)) / area;
+        const float w_b =
+            ((c.x - px) * (a.y - py) - (c.y - py) * (a.x - px)) / area;
+        const float w_c = 1.0f - w_a - w_b;
+        if (w_a < -1e-6f || w_b < -1e-6f || w_c < -1e-6f)
+          continue;
+        visit(row * width + col, w_a * a.z + w_b * b.z + w_c * c.z);
+      }
+    }
   };
 
-  // apply the rotation matrix to the face vectors
-  for (auto &face_vector : face_vectors) {
-    glm::vec4 transformed_vector = rotation * glm::vec4(face_vector, 0.0f);
-    face_vector = glm::vec3(transformed_vector.x, transformed_vector.y,
-                            transformed_vector.z);
+  for (size_t face = 0; face < face_count; ++face) {
+    for_each_sample(face, [&](size_t sample, float depth) {
+      nearest[sample] = std::min(nearest[sample], depth);
+    });
   }
 
-  // store the result of the dot product for each direction
-  std::array<bool, 6> facing_z_negative;
-  ;
+  // a face is hidden only if it covers samples and loses every one of them
+  std::vector<size_t> order;
+  std::vector<float> face_depth(face_count);
+  order.reserve(face_count);
+  for (size_t face = 0; face < face_count; ++face) {
+    bool covers_sample = false;
+    bool is_nearest = false;
+    for_each_sample(face, [&](size_t sample, float depth) {
+      covers_sample = true;
+      if (depth <= nearest[sample] + depth_tolerance)
+        is_nearest = true;
+    });
+    if (covers_sample && !is_nearest)
+      continue;
+    order.push_back(face);
+    face_depth[face] = (transformed.z[face * 3] + transformed.z[face * 3 + 1] +
+                        transformed.z[face * 3 + 2]) /
+                       3.0f;
+  }
 
-  for (size_t i = 0; i < face_vectors.size(); ++i) {
-    glm::vec3 face_vector = face_vectors[i];
-    // calculate the dot product with the  negative Z-axis
-    float dot_product = glm::dot(face_vector, glm::vec3(0.0f, 0.0f, -1.0f));
+  // painter's order, furthest first, mesh order between equal depths
+  std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+    return face_depth[lhs] > face_depth[rhs];
+  });
+  return order;
+}
 
-    // [DEBUG] Print the dot product for each face vector
-    std::cout << "[DEBUG] Dot product for face vector " << i << ": "
-              << dot_product << std::endl;
+/////////////////////////////////////////////////
+void Projector::RemapVisibleFaces(const std::vector<Triangle> &mesh,
+                                  const VisibleFaces &visible,
+                                  const QuarterTurnRemap &remap,
+                                  const float voxel_scale,
+                                  const glm::vec3 &model_center,
+                                  sf::VertexArray &result,
+                                  std::vector<uint32_t> *sources,
+                                  std::vector<float> *depths) const {
+  const std::array<const std::vector<float> *, 3> source{
+      &visible.positions.x, &visible.positions.y, &visible.positions.z};
+  // depth is only needed to remove hidden surfaces or to be kept
+  const bool with_depth = options.remove_hidden_surfaces ||
+                          (options.keep_depth && depths != nullptr);
+  const size_t axes = with_depth ? 3 : 2;
+  VertexBuffer transformed;
+  const std::array<std::vector<float> *, 3> target{
+      &transformed.x, &transformed.y, &transformed.z};
+  for (size_t axis = 0; axis < axes; ++axis) {
+    const std::vector<float> &from = *source[remap.axis[axis]];
+    std::vector<float> &to = *target[axis];
+    const float center = model_center[remap.axis[axis]];
+    const float sign = static_cast<float>(remap.sign[axis]);
+    to.resize(from.size());
+    // grid coordinates times an integer scale minus a half integer centre
+    // are exact in float, and the sign flip never rounds
+    for (size_t vertex = 0; vertex < from.size(); ++vertex)
+      to[vertex] = sign * (from[vertex] * voxel_scale - center);
+  }
+  FlattenFaces(mesh, visible, transformed, result, sources, depths);
+}
 
-    facing_z_negative[i] = (dot_product > 0.0f);
-    std::cout << "[DEBUG] Facing Z negative for face vector " << i << ": "
-              << std::boolalpha << facing_z_negative[i] << std::endl;
+/////////////////////////////////////////////////
+std::optional<QuarterTurnRemap>
+Projector::SnapToQuarterTurns(const glm::mat4 &model_matrix,
+                              const float voxel_scale) const {
+  // cos(90) comes out of glm::rotate as about 4e-8, well inside this
+  constexpr float tolerance = 1e-4f;
+  QuarterTurnRemap remap;
+  std::array<bool, 3> axis_used{false, false, false};
+  for (int row = 0; row < 3; ++row) {
+    int source_axis = -1;
+    for (int col = 0; col < 3; ++col) {
+      // glm matrices are indexed [column][row]
+      const float entry = model_matrix[col][row] / voxel_scale;
+      if (std::abs(entry) < tolerance)
+        continue;
+      if (source_axis != -1 || std::abs(std::abs(entry) - 1.0f) >= tolerance)
+        return std::nullopt;
+      source_axis = col;
+      remap.sign[row] = entry > 0.0f ? 1 : -1;
+    }
+    if (source_axis == -1 || axis_used[source_axis])
+      return std::nullopt;
+    axis_used[source_axis] = true;
+    remap.axis[row] = source_axis;
   }
-  for (auto it = triangles.begin(); it != triangles.end();) {
+  return remap;
+}
 
-    switch (it->direction) {
-    case (Direction::X_POSITIVE):
-      if (!facing_z_negative[0]) {
+/////////////////////////////////////////////////
+QuarterTurnRemap Projector::RemapFacing(Direction facing) const {
+  switch (facing) {
+  case Direction::X_POSITIVE: // 90 degrees about y
+    return {{2, 1, 0}, {1, 1, -1}};
+  case Direction::X_NEGATIVE: // 270 degrees about y
+    return {{2, 1, 0}, {-1, 1, 1}};
+  case Direction::Y_POSITIVE: // 270 degrees about x
+    return {{0, 2, 1}, {1, 1, -1}};
+  case Direction::Y_NEGATIVE: // 90 degrees about x
+    return {{0, 2, 1}, {1, -1, 1}};
+  case Direction::Z_POSITIVE: // 180 degrees about y
+    return {{0, 1, 2}, {-1, 1, -1}};
+  default: // Z_NEGATIVE already faces the camera
+    return {{0, 1, 2}, {1, 1, 1}};
+  }
+}
 
-        it = triangles.erase(it);
-        ++culled_count;
-      } else {
-        ++it; // Only increment if not erasing!
-      }
-      break;
-    case (Direction::X_NEGATIVE):
-      if (!facing_z_negative[1]) {
-        it = triangles.erase(it);
-        ++culled_count;
-      } else {
-        ++it; // Only increment if not erasing!
-      }
-      break;
-    case (Direction::Y_POSITIVE):
-      if (!facing_z_negative[2]) {
-        it = triangles.erase(it);
-        ++culled_count;
-      } else {
-        ++it; // Only increment if not erasing!
-      }
-      break;
-    case (Direction::Y_NEGATIVE):
-      if (!facing_z_negative[3]) {
-        it = triangles.erase(it);
-        ++culled_count;
-      } else {
-        ++it; // Only increment if not erasing!
-      }
-      break;
-    case (Direction::Z_POSITIVE):
-      if (!facing_z_negative[4]) {
-        it = triangles.erase(it);
-        ++culled_count;
-      } else {
-        ++it; // Only increment if not erasing!
+/////////////////////////////////////////////////
+sf::VertexArray
+Projector::ProjectFrontLayer(const ModelData &model_data, Direction facing,
+                             const QuarterTurnRemap &remap) const {
+  const Mask &mask = model_data.masks[static_cast<size_t>(facing) - 1];
+  const int mask_axis = (static_cast<int>(facing) - 1) / 2;
+  // look a cell up by model position, whatever the mask's layout
+  auto cell = [&](const std::array<int, 3> &position)
+      -> const std::optional<sf::Color> & {
+    const int a = position[mask_axis];
+    const int b = position[(mask_axis + 1) % 3];
+    const int c = position[(mask_axis + 2) % 3];
+    return mask.data[a][b][c];
+  };
+
+  // only the occupied box can hold faces
+  Bounds region{{0, 0, 0}, model_data.size};
+  if (model_data.occupancy.Matches(model_data.size))
+    region = model_data.occupancy.bounds;
+  const std::array<int, 3> lower{region.min.x, region.min.y, region.min.z};
+  const std::array<int, 3> upper{region.max.x, region.max.y, region.max.z};
+
+  const int screen_x = remap.axis[0];
+  const int screen_y = remap.axis[1];
+  const int depth = remap.axis[2];
+  // faces pointing down an axis are seen from its low end and vice versa
+  const bool from_low_end = (static_cast<int>(facing) - 1) % 2 == 1;
+
+  const float voxel_scale = static_cast<float>(model_data.voxel_scale);
+  const std::array<float, 3> center{
+      static_cast<float>(model_data.size.x) * voxel_scale * 0.5f,
+      static_cast<float>(model_data.size.y) * voxel_scale * 0.5f,
+      static_cast<float>(model_data.size.z) * voxel_scale * 0.5f};
+  auto to_screen = [&](int screen_axis, int source_axis, int coordinate) {
+    return static_cast<float>(remap.sign[screen_axis]) *
+           (static_cast<float>(coordinate) * voxel_scale - center[source_axis]);
+  };
+
+  // quads of a front layer never overlap, so batching by colour cannot change
+  // what is on top, each colour gets a run in the order it is first drawn
+  std::unordered_map<uint32_t, size_t> run_of_color;
+  std::vector<std::vector<sf::Vertex>> color_runs;
+  std::vector<std::optional<sf::Color>> row(
+      static_cast<size_t>(std::max(upper[screen_x] - lower[screen_x], 0)));
+  for (int v = lower[screen_y]; v < upper[screen_y]; ++v) {
+    // the first set cell along each ray is the one the camera sees
+    for (int u = lower[screen_x]; u < upper[screen_x]; ++u) {
+      std::optional<sf::Color> &front = row[u - lower[screen_x]];
+      front = std::nullopt;
+      std::array<int, 3> position{};
+      position[screen_x] = u;
+      position[screen_y] = v;
+      for (int step = 0; step < upper[depth] - lower[depth]; ++step) {
+        position[depth] =
+            from_low_end ? lower[depth] + step : upper[depth] - 1 - step;
+        if (cell(position).has_value()) {
+          front = cell(position);
+          break;
+        }
       }
-      break;
-    case (Direction::Z_NEGATIVE):
-      if (!facing_z_negative[5]) {
-        it = triangles.erase(it);
-        ++culled_count;
-      } else {
-        ++it; // Only increment if not erasing!
+    }
+
+    // runs of one colour become a single quad
+    int run_start = lower[screen_x];
+    for (int u = lower[screen_x]; u <= upper[screen_x]; ++u) {
+      const bool run_ends =
+          u == upper[screen_x] ||
+          row[u - lower[screen_x]] != row[run_start - lower[screen_x]];
+      if (!run_ends)
+        continue;
+      const std::optional<sf::Color> &color = row[run_start - lower[screen_x]];
+      if (color.has_value()) {
+        size_t run = 0;
+        if (options.batch_by_color) {
+          run = run_of_color
+                    .try_emplace(color->toInteger(), run_of_color.size())
+                    .first->second;
+        }
+        if (run == color_runs.size())
+          color_runs.emplace_back();
+        const float x0 = to_screen(0, screen_x, run_start);
+        const float x1 = to_screen(0, screen_x, u);
+        const float y0 = to_screen(1, screen_y, v);
+        const float y1 = to_screen(1, screen_y, v + 1);
+        // split like the mesher's quads, so runs of a colour can be strips
+        for (const auto &[x, y] :
+             {std::pair{x0, y0}, std::pair{x1, y0}, std::pair{x0, y1},
+              std::pair{x1, y0}, std::pair{x1, y1}, std::pair{x0, y1}}) {
+          color_runs[run].push_back(
+              sf::Vertex{sf::Vector2f(x, y), color.value()});
+        }
       }
-      break;
-    default:
-      break;
+      run_start = u;
     }
   }
 
-  std::cout << "[DEBUG] Culled total " << culled_count << " triangles"
-            << std::endl;
+  sf::VertexArray result(sf::PrimitiveType::Triangles);
+  for (const std::vector<sf::Vertex> &quads : color_runs) {
+    for (const sf::Vertex &vertex : quads)
+      result.append(vertex);
+  }
+  if (options.triangle_strips)
+    result = TriangleStripper().Stripify(result);
+  return result;
 }
 
 /////////////////////////////////////////////////
-sf::VertexArray Projector::ProjectOntoVertexArray(
-    const std::vector<Triangle> &triangles) const {
+std::array<bool, 6>
+Projector::FacingDirections(const QuarterTurnRemap &remap) const {
+  // only the face that lands on -z after the remap is seen by the camera
+  std::array<bool, 6> facing_z_negative{};
+  const size_t source_axis = static_cast<size_t>(remap.axis[2]);
+  if (remap.sign[2] > 0)
+    facing_z_negative[source_axis * 2 + 1] = true; // the negative face
+  else
+    facing_z_negative[source_axis * 2] = true; // the positive face
+  return facing_z_negative;
+}
 
-  sf::VertexArray result(sf::PrimitiveType::Triangles);
+/////////////////////////////////////////////////
+std::array<bool, 6>
+Projector::FacingDirections(const glm::mat4 &rotation) const {
+  // create vectors to represent the masks for each direction
+  std::array<glm::vec3, 6> face_vectors{
+      (glm::vec3(1.0f, 0.0f, 0.0f)),  // X_POSITIVE
+      (glm::vec3(-1.0f, 0.0f, 0.0f)), // X_NEGATIVE
+      (glm::vec3(0.0f, 1.0f, 0.0f)),  // Y_POSITIVE
+      (glm::vec3(0.0f, -1.0f, 0.0f)), // Y_NEGATIVE
+      (glm::vec3(0.0f, 0.0f, 1.0f)),  // Z_POSITIVE
+      (glm::vec3(0.0f, 0.0f, -1.0f))  // Z_NEGATIVE
+  };
 
-  for (const auto &triangle : triangles) {
-    // print out triangle vertices and color for debugging
-    for (const auto &vertex : triangle.vertices) {
-      result.append(
-          sf::Vertex(sf::Vector2f(vertex.x, vertex.y), triangle.color));
+  std::array<bool, 6> facing_z_negative;
+  for (size_t i = 0; i < face_vectors.size(); ++i) {
+    // apply the rotation matrix to the face vector, w = 0 ignores translation
+    glm::vec4 transformed_vector = rotation * glm::vec4(face_vectors[i], 0.0f);
+    // calculate the dot product with the negative Z-axis
+    glm::vec3 face_vector(transformed_vector.x, transformed_vector.y,
+                          transformed_vector.z);
+    float dot_product = glm::dot(face_vector, glm::vec3(0.0f, 0.0f, -1.0f));
+    facing_z_negative[i] = (dot_product > 0.0f);
+  }
+  return facing_z_negative;
+}
+
+/////////////////////////////////////////////////
+uint8_t Projector::FacingSignature(const std::array<bool, 6> &facing) const {
+  uint8_t signature = 0;
+  for (size_t i = 0; i < facing.size(); ++i) {
+    if (facing[i])
+      signature |= static_cast<uint8_t>(1u << i);
+  }
+  return signature;
+}
+
+/////////////////////////////////////////////////
+bool Projector::IsFacing(const std::array<bool, 6> &facing,
+                         Direction direction) const {
+  if (direction == Direction::NONE)
+    return true; // no direction to judge by, keep it
+  // masks are stored X+, X-, Y+, Y-, Z+, Z- to match the Direction enum
+  return facing[static_cast<size_t>(direction) - 1];
+}
+
+/////////////////////////////////////////////////
+std::vector<ColorBatch>
+Projector::ColorBatches(const sf::VertexArray &view) const {
+  std::vector<ColorBatch> batches;
+  if (view.getPrimitiveType() == sf::PrimitiveType::TriangleStrip) {
+    // strips change colour between the repeated vertices of a join, so each
+    // run of one colour is a strip of its own
+    for (size_t vertex = 0; vertex < view.getVertexCount(); ++vertex) {
+      if (batches.empty() || batches.back().color != view[vertex].color)
+        batches.push_back({view[vertex].color, vertex, 0});
+      ++batches.back().vertex_count;
     }
+    return batches;
   }
-  return result;
+  for (size_t vertex = 0; vertex + 2 < view.getVertexCount(); vertex += 3) {
+    if (batches.empty() || batches.back().color != view[vertex].color)
+      batches.push_back({view[vertex].color, vertex, 0});
+    batches.back().vertex_count += 3;
+  }
+  return batches;
 }
 
 } // namespace hollow_lantern
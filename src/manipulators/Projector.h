@@ -13,14 +13,161 @@
 /////////////////////////////////////////////////
 
 #include "ModelData.h"
+#include "VertexTransform.h"
+#include "VoxelRayCaster.h"
 #include <SFML/Graphics/VertexArray.hpp>
+#include <array>
+#include <cstdint>
 #include <glm/mat4x4.hpp>
+#include <optional>
 #include <vector>
 namespace hollow_lantern {
 
+/////////////////////////////////////////////////
+/// @brief Faces of a mesh that survive culling for a set of views
+/////////////////////////////////////////////////
+struct VisibleFaces {
+  /////////////////////////////////////////////////
+  /// @brief Indices into the mesh of the surviving triangles, in mesh order
+  /////////////////////////////////////////////////
+  std::vector<size_t> triangles;
+
+  /////////////////////////////////////////////////
+  /// @brief Untransformed vertices of the surviving triangles, three each
+  /////////////////////////////////////////////////
+  VertexBuffer positions;
+};
+
+/////////////////////////////////////////////////
+/// @brief Options controlling how views are projected
+/////////////////////////////////////////////////
+struct ProjectionOptions {
+  /////////////////////////////////////////////////
+  /// @brief Threads used to project views, 0 for one per hardware thread
+  /////////////////////////////////////////////////
+  size_t thread_count{0};
+
+  /////////////////////////////////////////////////
+  /// @brief Drop faces hidden behind nearer ones and draw back to front
+  ///
+  /// Without it every face pointing at the camera is kept in mesh order.
+  /////////////////////////////////////////////////
+  bool remove_hidden_surfaces{false};
+
+  /////////////////////////////////////////////////
+  /// @brief Depth samples per source voxel along each screen axis
+  ///
+  /// A face is only removed if every sample it covers is nearer to another
+  /// face, so faces too small to cover a sample are always kept.
+  /////////////////////////////////////////////////
+  float hidden_surface_samples{4.0f};
+
+  /////////////////////////////////////////////////
+  /// @brief Keep only faces struck by rays cast through the voxel grid
+  ///
+  /// Removes front faces hidden by other parts of the model before they are
+  /// transformed. Needs ModelData::voxel_data, views of models without it
+  /// are projected as usual.
+  /////////////////////////////////////////////////
+  bool ray_cast_visibility{false};
+
+  /////////////////////////////////////////////////
+  /// @brief Rays per voxel along each screen axis when ray casting
+  /////////////////////////////////////////////////
+  float rays_per_voxel{4.0f};
+
+  /////////////////////////////////////////////////
+  /// @brief Merge each view's same coloured triangles with RegionMerger
+  ///
+  /// Exact but slow, meant for final exports rather than previews.
+  /////////////////////////////////////////////////
+  bool merge_regions{false};
+
+  /////////////////////////////////////////////////
+  /// @brief Group each view's triangles into runs of one colour
+  ///
+  /// A face moves back to the last run of its colour, so each run can be
+  /// drawn in one call, see ColorBatches. Faces never move past one of
+  /// another colour they overlap, so what is on top does not change, and a
+  /// colour only needs a second run where that would happen.
+  /////////////////////////////////////////////////
+  bool batch_by_color{false};
+
+  /////////////////////////////////////////////////
+  /// @brief Write each view as a triangle strip with TriangleStripper
+  ///
+  /// Applied last, after merging and batching. Views that would not shrink
+  /// stay triangle lists.
+  /////////////////////////////////////////////////
+  bool triangle_strips{false};
+
+  /////////////////////////////////////////////////
+  /// @brief Record the depth of every vertex in ModelData::projected_depths
+  ///
+  /// Lets SpriteRasterizer draw the nearest face at every pixel whatever
+  /// order a view was written in. Without it, and without
+  /// remove_hidden_surfaces, only x and y are transformed.
+  /////////////////////////////////////////////////
+  bool keep_depth{true};
+};
+
+/////////////////////////////////////////////////
+/// @brief A run of vertices of one colour in a projected view
+/////////////////////////////////////////////////
+struct ColorBatch {
+  sf::Color color;
+  size_t first_vertex{0};
+  size_t vertex_count{0};
+};
+
+/////////////////////////////////////////////////
+/// @brief A rotation by whole quarter turns written as an axis remap
+///
+/// Output axis i is source axis axis[i] multiplied by sign[i], so applying it
+/// needs no trigonometry or matrix math and introduces no float error.
+/////////////////////////////////////////////////
+struct QuarterTurnRemap {
+  std::array<int, 3> axis{0, 1, 2};
+  std::array<int, 3> sign{1, 1, 1};
+};
+
+/////////////////////////////////////////////////
+/// @brief Everything about a set of views that is worked out before any
+/// view is projected
+/////////////////////////////////////////////////
+struct ProjectionPlan {
+  std::vector<glm::mat4> model_matrices;
+
+  /////////////////////////////////////////////////
+  /// @brief Exact remap of each view that is a quarter turn
+  /////////////////////////////////////////////////
+  std::vector<std::optional<QuarterTurnRemap>> remaps;
+
+  /////////////////////////////////////////////////
+  /// @brief Facing directions of each visibility signature in use
+  /////////////////////////////////////////////////
+  std::vector<std::array<bool, 6>> group_facing;
+
+  /////////////////////////////////////////////////
+  /// @brief Index into group_facing for each view
+  /////////////////////////////////////////////////
+  std::vector<size_t> view_group;
+
+  float voxel_scale{1.0f};
+  glm::vec3 model_center{0.0f, 0.0f, 0.0f};
+};
+
+class ProjectionSequence;
+
 class Projector {
+  friend class ProjectionSequence;
 
 private:
+  /////////////////////////////////////////////////
+  /// @brief Threading and hidden surface settings for every view
+  /////////////////////////////////////////////////
+  ProjectionOptions options;
+
   /////////////////////////////////////////////////
   /// @brief Generate model matrices for all rotation specified
   ///
@@ -29,26 +176,257 @@ private:
   /// @param rotation_positions Vector of rotation positions
   /////////////////////////////////////////////////
   std::vector<glm::mat4>
-  GenerateModelMatrices(ModelData &model_data, const glm::vec3 &tilt,
+  GenerateModelMatrices(const ModelData &model_data, const glm::vec3 &tilt,
                         const std::vector<glm::vec3> &rotation_positions) const;
 
   /////////////////////////////////////////////////
-  /// @brief Culls rotated triangles that are not visible
+  /// @brief Rotations at even intervals about one axis
   ///
-  /// @param triangles Vector of rotated triangles to cull
+  /// @param intervals Number of rotations
+  /// @param rotation_axis Axis to turn about, y if all components are zero
   /////////////////////////////////////////////////
-  void ImplementBackFaceCulling(std::vector<Triangle> &triangles) const;
+  std::vector<glm::vec3>
+  TurntableRotations(const size_t intervals,
+                     const glm::vec3 &rotation_axis) const;
 
-  void ImplementCullingWithDirections(
-      std::vector<Triangle> &triangles,
-      const glm::mat4 &rotational_transformation) const;
   /////////////////////////////////////////////////
-  /// @brief Turns 3D triangles into a 2D vertex array of type triangles
+  /// @brief Snap views to quarter turns and group them by visibility
   ///
-  /// @param triangles Triangles to project onto a vertex array
+  /// @param model_data ModelData the matrices were generated for
+  /// @param model_matrices Matrices from GenerateModelMatrices
   /////////////////////////////////////////////////
-  sf::VertexArray
-  ProjectOntoVertexArray(const std::vector<Triangle> &triangles) const;
+  ProjectionPlan PlanViews(const ModelData &model_data,
+                           const std::vector<glm::mat4> &model_matrices) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Ray caster for a model when ray_cast_visibility is set
+  ///
+  /// @return nullopt if ray casting is off or the model has no voxels
+  /////////////////////////////////////////////////
+  std::optional<VoxelRayCaster>
+  MakeRayCaster(const ModelData &model_data) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Project one view of a plan from its group's culled faces
+  ///
+  /// @param mesh Triangles the faces were culled from
+  /// @param plan Result of PlanViews
+  /// @param group CullFaces result for the view's visibility signature
+  /// @param ray_caster Result of MakeRayCaster, nullptr to skip ray casting
+  /// @param view Index of the view in the plan
+  /// @param result Overwritten with the view as described for FlattenFaces
+  /// @param sources If given, filled as described for FlattenFaces
+  /// @param depths If given, filled as described for FlattenFaces
+  /////////////////////////////////////////////////
+  void ProjectPlannedView(const std::vector<Triangle> &mesh,
+                          const ProjectionPlan &plan, const VisibleFaces &group,
+                          const VoxelRayCaster *ray_caster, size_t view,
+                          sf::VertexArray &result,
+                          std::vector<uint32_t> *sources = nullptr,
+                          std::vector<float> *depths = nullptr) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Project one view per model matrix and append them in order
+  ///
+  /// The mesh is gathered once, views are grouped by visibility signature
+  /// so each group is culled once, and the views are projected concurrently.
+  ///
+  /// @param model_data ModelData instance containing the model to project
+  /// @param model_matrices Matrices from GenerateModelMatrices
+  /////////////////////////////////////////////////
+  void ProjectModelMatrices(ModelData &model_data,
+                            const std::vector<glm::mat4> &model_matrices) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Cull, transform and flatten a mesh for one view
+  ///
+  /// Faces pointing away from the camera are dropped before anything is
+  /// transformed, and the survivors keep their order.
+  ///
+  /// @param mesh Triangles to project
+  /// @param positions Vertices of the mesh from VertexBuffer::FromTriangles
+  /// @param model_matrix Matrix applied to the surviving vertices
+  /// @param rotation Matrix whose rotation decides which faces are culled
+  /// @return Vertex array of type triangles
+  /////////////////////////////////////////////////
+  sf::VertexArray ProjectView(const std::vector<Triangle> &mesh,
+                              const VertexBuffer &positions,
+                              const glm::mat4 &model_matrix,
+                              const glm::mat4 &rotation) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Gather the faces of a mesh that point towards the camera
+  ///
+  /// @param mesh Triangles to cull
+  /// @param positions Vertices of the mesh from VertexBuffer::FromTriangles
+  /// @param facing Result of FacingDirections for the view
+  /// @return Surviving triangles and their positions, in mesh order
+  /////////////////////////////////////////////////
+  VisibleFaces CullFaces(const std::vector<Triangle> &mesh,
+                         const VertexBuffer &positions,
+                         const std::array<bool, 6> &facing) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Narrow culled faces down to the ones a view can see
+  ///
+  /// @param visible Result of CullFaces
+  /// @param keep Result of VoxelRayCaster::VisibleTriangles, one flag per
+  /// triangle of the mesh
+  /// @return The faces of visible flagged in keep, in the same order
+  /////////////////////////////////////////////////
+  VisibleFaces KeepFaces(const VisibleFaces &visible,
+                         const std::vector<bool> &keep) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Transform and flatten already culled faces for one view
+  ///
+  /// @param mesh Triangles the faces were culled from
+  /// @param visible Result of CullFaces
+  /// @param model_matrix Matrix applied to the vertices
+  /// @param result Overwritten with the view as described for FlattenFaces
+  /// @param sources If given, filled as described for FlattenFaces
+  /// @param depths If given, filled as described for FlattenFaces
+  /////////////////////////////////////////////////
+  void ProjectVisibleFaces(const std::vector<Triangle> &mesh,
+                           const VisibleFaces &visible,
+                           const glm::mat4 &model_matrix,
+                           sf::VertexArray &result,
+                           std::vector<uint32_t> *sources = nullptr,
+                           std::vector<float> *depths = nullptr) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Remap already culled faces for a quarter turn view
+  ///
+  /// Each output coordinate is a source coordinate scaled, recentred and
+  /// sign flipped, so views at 0, 90, 180 and 270 degrees land exactly on the
+  /// voxel grid instead of picking up rounding from a float matrix.
+  ///
+  /// @param mesh Triangles the faces were culled from
+  /// @param visible Result of CullFaces
+  /// @param remap Result of SnapToQuarterTurns for the view
+  /// @param voxel_scale Size of one voxel in source units
+  /// @param model_center Centre of the model in source units
+  /// @param result Overwritten with the view as described for FlattenFaces
+  /// @param sources If given, filled as described for FlattenFaces
+  /// @param depths If given, filled as described for FlattenFaces
+  /////////////////////////////////////////////////
+  void RemapVisibleFaces(const std::vector<Triangle> &mesh,
+                         const VisibleFaces &visible,
+                         const QuarterTurnRemap &remap, const float voxel_scale,
+                         const glm::vec3 &model_center, sf::VertexArray &result,
+                         std::vector<uint32_t> *sources = nullptr,
+                         std::vector<float> *depths = nullptr) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Write transformed faces into a vertex array
+  ///
+  /// With ProjectionOptions::remove_hidden_surfaces set, hidden faces are
+  /// dropped and the rest are written back to front, otherwise every face is
+  /// written in order. With ProjectionOptions::merge_regions set the result
+  /// is then merged into one region per colour, and with
+  /// ProjectionOptions::triangle_strips set it is written as a strip.
+  ///
+  /// @param mesh Triangles the faces were culled from
+  /// @param visible Result of CullFaces
+  /// @param transformed Screen positions of visible.positions, z only needed
+  /// when removing hidden surfaces or keeping depth
+  /// @param result Overwritten with the view, a vertex array of type
+  /// triangles or triangle strip. Triangle lists are written into its
+  /// existing storage, so a buffer reused across views stops allocating
+  /// once it has grown to the largest view; merged regions and strips are
+  /// built anew
+  /// @param sources If given, overwritten with the index into mesh of each
+  /// written triangle, or left empty when regions were merged. A strip has
+  /// one for every triangle of the strip, joins included
+  /// @param depths If given, overwritten with the depth of each written
+  /// vertex, or left empty when ProjectionOptions::keep_depth is off or
+  /// regions were merged
+  /////////////////////////////////////////////////
+  void FlattenFaces(const std::vector<Triangle> &mesh,
+                    const VisibleFaces &visible,
+                    const VertexBuffer &transformed, sf::VertexArray &result,
+                    std::vector<uint32_t> *sources = nullptr,
+                    std::vector<float> *depths = nullptr) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Find the faces of a view that are not hidden by nearer faces
+  ///
+  /// Every face is rasterised into a depth buffer of nearest depths, then a
+  /// face survives if it is the nearest at any sample it covers. The camera
+  /// looks down +z, so smaller z is nearer.
+  ///
+  /// @param transformed Screen positions with depth, three per face
+  /// @return Indices of the surviving faces, furthest first
+  /////////////////////////////////////////////////
+  std::vector<size_t> OrderVisibleFaces(const VertexBuffer &transformed) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Recognise a model matrix that only rotates by quarter turns
+  ///
+  /// @param model_matrix Matrix built by GenerateModelMatrices
+  /// @param voxel_scale Uniform scale the matrix applies
+  /// @return The equivalent axis remap, or nullopt for any other rotation
+  /////////////////////////////////////////////////
+  std::optional<QuarterTurnRemap>
+  SnapToQuarterTurns(const glm::mat4 &model_matrix,
+                     const float voxel_scale) const;
+
+  /////////////////////////////////////////////////
+  /// @brief The quarter turn that shows a face direction to the camera
+  ///
+  /// Matches the BasicProjection views about y (Z-, X+, Z+, X-) and about x
+  /// (Y- at 90 degrees, Y+ at 270 degrees).
+  /////////////////////////////////////////////////
+  QuarterTurnRemap RemapFacing(Direction facing) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Build an axis aligned view from the front-most mask cells
+  ///
+  /// Each ray through the mask for the facing direction stops at the first
+  /// set cell, so the view only holds what the camera sees. Neighbouring
+  /// cells of a row with the same colour are merged into one quad.
+  /// ProjectionOptions::batch_by_color and triangle_strips are applied as
+  /// they are to projected meshes; merge_regions is not, as the quads of a
+  /// row are already merged.
+  ///
+  /// @param model_data ModelData with masks from HollowAndMesh
+  /// @param facing Direction of the faces pointing at the camera
+  /// @param remap Result of RemapFacing for the direction
+  /// @return Vertex array of type triangles, or triangle strip with
+  /// ProjectionOptions::triangle_strips set
+  /////////////////////////////////////////////////
+  sf::VertexArray ProjectFrontLayer(const ModelData &model_data,
+                                    Direction facing,
+                                    const QuarterTurnRemap &remap) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Work out which face directions point towards the camera
+  ///
+  /// @param rotation Matrix rotating the model into view
+  /// @return One flag per direction, ordered X+, X-, Y+, Y-, Z+, Z-
+  /////////////////////////////////////////////////
+  std::array<bool, 6> FacingDirections(const glm::mat4 &rotation) const;
+
+  /////////////////////////////////////////////////
+  /// @brief FacingDirections for a quarter turn, without float noise
+  ///
+  /// Faces left edge-on by the turn are always culled.
+  /////////////////////////////////////////////////
+  std::array<bool, 6> FacingDirections(const QuarterTurnRemap &remap) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Pack the result of FacingDirections into a 6-bit signature
+  ///
+  /// Views with the same signature keep exactly the same faces.
+  /////////////////////////////////////////////////
+  uint8_t FacingSignature(const std::array<bool, 6> &facing) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Look up a direction in the result of FacingDirections
+  ///
+  /// Direction::NONE is never culled.
+  /////////////////////////////////////////////////
+  bool IsFacing(const std::array<bool, 6> &facing, Direction direction) const;
 
 public:
   /////////////////////////////////////////////////
@@ -56,11 +434,25 @@ public:
   /////////////////////////////////////////////////
   Projector() = default;
 
+  /////////////////////////////////////////////////
+  /// @brief Construct a Projector with a fixed number of threads
+  ///
+  /// @param thread_count Threads used to project views, 1 projects serially
+  /////////////////////////////////////////////////
+  explicit Projector(size_t thread_count);
+
+  /////////////////////////////////////////////////
+  /// @brief Construct a Projector with the given options
+  /////////////////////////////////////////////////
+  explicit Projector(const ProjectionOptions &options);
+
   /////////////////////////////////////////////////
   /// @brief Generate vertex arrays for intervals of rotations
   ///
   /// The model is tilted and then rotated about an axis at the intervals
-  /// specified. A snapshot of the model is taken at each interval.
+  /// specified. A snapshot of the model is taken at each interval. Views are
+  /// projected concurrently and appended in interval order. Views that end
+  /// up rotated by whole quarter turns are remapped exactly.
   ///
   /// @param model_data ModelData instance containing the model to project
   /////////////////////////////////////////////////
@@ -69,5 +461,105 @@ public:
                        const glm::vec3 &rotation_axis) const;
 
   void FixedAngleProjection(ModelData &model_data, const glm::vec3 &rotation);
+
+  /////////////////////////////////////////////////
+  /// @brief The views of BasicProjection, projected one at a time on demand
+  ///
+  /// Nothing is added to model_data.projected_data, each view is produced
+  /// when the sequence is advanced, so only one view needs to be held at a
+  /// time however many intervals there are.
+  ///
+  /// @param model_data ModelData to project, must outlive the sequence
+  /////////////////////////////////////////////////
+  ProjectionSequence LazyProjection(const ModelData &model_data,
+                                    const glm::vec3 &tilt_angle,
+                                    const size_t intervals,
+                                    const glm::vec3 &rotation_axis) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Project a list of rotations in one pass
+  ///
+  /// Each rotation is applied about x, then y, then z, like
+  /// FixedAngleProjection, but the views are centred on the origin like
+  /// BasicProjection's. The mesh, culling and output are shared across the
+  /// whole list rather than redone per call.
+  ///
+  /// @param model_data ModelData instance containing the model to project
+  /// @param rotations Rotations in degrees, one view each, in order
+  /////////////////////////////////////////////////
+  void BatchProjection(ModelData &model_data,
+                       const std::vector<glm::vec3> &rotations) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Project a pitch by yaw grid of views in one pass
+  ///
+  /// For every pitch the model is tilted about x and turned about y at even
+  /// intervals, the same views BasicProjection gives for that tilt. Views
+  /// are appended pitch by pitch, yaws in order within each pitch.
+  ///
+  /// @param model_data ModelData instance containing the model to project
+  /// @param pitches Tilts about x in degrees
+  /// @param yaw_intervals Views per pitch around y
+  /////////////////////////////////////////////////
+  void GridProjection(ModelData &model_data, const std::vector<float> &pitches,
+                      const size_t yaw_intervals) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Project the view that looks straight at one face direction
+  ///
+  /// Front, side and top views are read off the masks instead of culling and
+  /// transforming the mesh, and land on the same coordinates BasicProjection
+  /// gives the matching quarter turn. Models without masks, such as ones
+  /// loaded from the mesh cache, fall back to projecting the mesh. Colour
+  /// batching and triangle strips apply either way, region merging only to
+  /// the mesh fallback.
+  ///
+  /// @param model_data ModelData instance containing the model to project
+  /// @param facing Direction of the faces pointing at the camera
+  /// @return False, and nothing projected, for Direction::NONE
+  /////////////////////////////////////////////////
+  bool AxisAlignedProjection(ModelData &model_data, Direction facing) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Table of the colour runs of a view, one draw call each
+  ///
+  /// Views projected with ProjectionOptions::batch_by_color have about one
+  /// run per colour, other views a run wherever the colour changes.
+  ///
+  /// @param view Vertex array of type triangles or triangle strip, e.g. one
+  /// of projected_data
+  /// @return Runs of whole triangles, or of whole strips, in vertex order
+  /////////////////////////////////////////////////
+  std::vector<ColorBatch> ColorBatches(const sf::VertexArray &view) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Pick the level of detail to project at a given on-screen scale
+  ///
+  /// @param model_data ModelData whose levels_of_detail are considered
+  /// @param pixels_per_unit On-screen size of one source voxel in pixels
+  /// @param target_voxel_size Smallest voxel size on screen worth drawing
+  /// @return 0 for the model itself, n for levels_of_detail[n - 1]
+  /////////////////////////////////////////////////
+  size_t SelectLevelOfDetail(const ModelData &model_data,
+                             const float pixels_per_unit,
+                             const float target_voxel_size) const;
+
+  /////////////////////////////////////////////////
+  /// @brief BasicProjection using the level of detail chosen by
+  /// SelectLevelOfDetail
+  ///
+  /// The views are added to model_data.projected_data whichever level is
+  /// used, in the same units as the source model.
+  ///
+  /// @param model_data ModelData with levels_of_detail already generated
+  /// @param pixels_per_unit On-screen size of one source voxel in pixels
+  /// @param target_voxel_size Smallest voxel size on screen worth drawing
+  /////////////////////////////////////////////////
+  void LevelOfDetailProjection(ModelData &model_data,
+                               const glm::vec3 &tilt_angle,
+                               const size_t intervals,
+                               const glm::vec3 &rotation_axis,
+                               const float pixels_per_unit,
+                               const float target_voxel_size) const;
 };
 } // namespace hollow_lantern
@@ -0,0 +1,279 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Implementation of the RegionMerger class
+/////////////////////////////////////////////////
+
+#include "RegionMerger.h"
+#include <CGAL/Bbox_2.h>
+#include <CGAL/Constrained_Delaunay_triangulation_2.h>
+#include <CGAL/Exact_predicates_exact_constructions_kernel.h>
+#include <CGAL/Polygon_2.h>
+#include <CGAL/Polygon_set_2.h>
+#include <CGAL/Polygon_with_holes_2.h>
+#include <CGAL/Triangulation_face_base_with_info_2.h>
+#include <SFML/Graphics/PrimitiveType.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <map>
+#include <vector>
+
+namespace hollow_lantern {
+
+namespace {
+
+// exact constructions, so shared edges of neighbouring triangles line up
+// and unions never leave slivers
+using Kernel = CGAL::Exact_predicates_exact_constructions_kernel;
+using Point = Kernel::Point_2;
+using Polygon = CGAL::Polygon_2<Kernel>;
+using PolygonWithHoles = CGAL::Polygon_with_holes_2<Kernel>;
+using PolygonSet = CGAL::Polygon_set_2<Kernel>;
+
+/////////////////////////////////////////////////
+/// @brief Per face flood fill state used to find the inside of a region
+/////////////////////////////////////////////////
+struct FaceInfo {
+  int nesting_level{-1};
+
+  bool InDomain() const { return nesting_level % 2 == 1; };
+};
+
+using VertexBase = CGAL::Triangulation_vertex_base_2<Kernel>;
+using FaceBase = CGAL::Constrained_triangulation_face_base_2<
+    Kernel, CGAL::Triangulation_face_base_with_info_2<FaceInfo, Kernel>>;
+using DataStructure =
+    CGAL::Triangulation_data_structure_2<VertexBase, FaceBase>;
+using Triangulation =
+    CGAL::Constrained_Delaunay_triangulation_2<Kernel, DataStructure,
+                                               CGAL::Exact_intersections_tag>;
+
+/////////////////////////////////////////////////
+/// @brief Flood fill faces reachable without crossing a constraint
+/////////////////////////////////////////////////
+void MarkDomain(Triangulation &triangulation, Triangulation::Face_handle start,
+                int level, std::list<Triangulation::Edge> &border) {
+  if (start->info().nesting_level != -1)
+    return;
+  std::list<Triangulation::Face_handle> queue{start};
+  while (!queue.empty()) {
+    Triangulation::Face_handle face = queue.front();
+    queue.pop_front();
+    if (face->info().nesting_level != -1)
+      continue;
+    face->info().nesting_level = level;
+    for (int edge_idx = 0; edge_idx < 3; ++edge_idx) {
+      Triangulation::Face_handle neighbor = face->neighbor(edge_idx);
+      if (neighbor->info().nesting_level != -1)
+        continue;
+      const Triangulation::Edge edge(face, edge_idx);
+      if (triangulation.is_constrained(edge))
+        border.push_back(edge);
+      else
+        queue.push_back(neighbor);
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+/// @brief Number faces by how many boundaries separate them from infinity,
+/// odd levels are inside a region
+/////////////////////////////////////////////////
+void MarkDomains(Triangulation &triangulation) {
+  for (Triangulation::Face_handle face : triangulation.all_face_handles())
+    face->info().nesting_level = -1;
+  std::list<Triangulation::Edge> border;
+  MarkDomain(triangulation, triangulation.infinite_face(), 0, border);
+  while (!border.empty()) {
+    const Triangulation::Edge edge = border.front();
+    border.pop_front();
+    Triangulation::Face_handle neighbor = edge.first->neighbor(edge.second);
+    if (neighbor->info().nesting_level == -1)
+      MarkDomain(triangulation, neighbor,
+                 edge.first->info().nesting_level + 1, border);
+  }
+}
+
+/////////////////////////////////////////////////
+/// @brief Constrain a boundary, skipping vertices on a straight run
+/////////////////////////////////////////////////
+void InsertBoundary(Triangulation &triangulation, const Polygon &boundary) {
+  std::vector<Point> corners;
+  const size_t count = boundary.size();
+  for (size_t idx = 0; idx < count; ++idx) {
+    const Point &previous = boundary.vertex((idx + count - 1) % count);
+    const Point &current = boundary.vertex(idx);
+    const Point &next = boundary.vertex((idx + 1) % count);
+    if (!CGAL::collinear(previous, current, next))
+      corners.push_back(current);
+  }
+  for (size_t idx = 0; idx < corners.size(); ++idx) {
+    triangulation.insert_constraint(corners[idx],
+                                    corners[(idx + 1) % corners.size()]);
+  }
+}
+
+/////////////////////////////////////////////////
+/// @brief Screen split into square-ish tiles, each listing the triangles
+/// whose bounding boxes touch it
+/////////////////////////////////////////////////
+struct TileGrid {
+  CGAL::Bbox_2 bounds;
+  size_t side{1};
+  std::vector<std::vector<size_t>> tiles;
+
+  /////////////////////////////////////////////////
+  /// @brief About one tile per triangle over the given bounds
+  /////////////////////////////////////////////////
+  TileGrid(const CGAL::Bbox_2 &bounds, size_t triangle_count)
+      : bounds(bounds),
+        side(std::max<size_t>(
+            1, static_cast<size_t>(std::sqrt(
+                   static_cast<double>(triangle_count))))),
+        tiles(side * side) {};
+
+  /////////////////////////////////////////////////
+  /// @brief Column or row of the tile holding a coordinate, clamped to the
+  /// grid
+  /////////////////////////////////////////////////
+  size_t Index(double value, double min, double max) const {
+    if (max <= min)
+      return 0;
+    const double cell = (value - min) / (max - min) * static_cast<double>(side);
+    return std::min(side - 1, static_cast<size_t>(std::max(0.0, cell)));
+  };
+
+  /////////////////////////////////////////////////
+  /// @brief Visit the triangle list of every tile a box touches
+  /////////////////////////////////////////////////
+  template <typename Visit>
+  void ForEachTile(const CGAL::Bbox_2 &box, Visit visit) {
+    const size_t col_min = Index(box.xmin(), bounds.xmin(), bounds.xmax());
+    const size_t col_max = Index(box.xmax(), bounds.xmin(), bounds.xmax());
+    const size_t row_min = Index(box.ymin(), bounds.ymin(), bounds.ymax());
+    const size_t row_max = Index(box.ymax(), bounds.ymin(), bounds.ymax());
+    for (size_t row = row_min; row <= row_max; ++row) {
+      for (size_t col = col_min; col <= col_max; ++col)
+        visit(tiles[row * side + col]);
+    }
+  };
+};
+
+} // namespace
+
+/////////////////////////////////////////////////
+sf::VertexArray RegionMerger::MergeRegions(const sf::VertexArray &view) const {
+  if (view.getPrimitiveType() != sf::PrimitiveType::Triangles) {
+    std::cout << "[DEBUG] Only triangle lists can be merged" << std::endl;
+    return view;
+  }
+  const size_t triangle_count = view.getVertexCount() / 3;
+  for (size_t vertex = 0; vertex < triangle_count * 3; ++vertex) {
+    if (view[vertex].texCoords != sf::Vector2f(0.0f, 0.0f)) {
+      std::cout << "[DEBUG] Textured views are not merged" << std::endl;
+      return view;
+    }
+  }
+
+  CGAL::Bbox_2 bounds;
+  for (size_t vertex = 0; vertex < triangle_count * 3; ++vertex) {
+    const sf::Vector2f &position = view[vertex].position;
+    bounds += CGAL::Bbox_2(position.x, position.y, position.x, position.y);
+  }
+
+  // walk the triangles front to back, each keeps only what the triangles
+  // kept before it leave uncovered, so the colour regions end up disjoint.
+  // Kept triangles are bucketed by screen tile and only those whose
+  // bounding boxes overlap are cut away, rather than a union of everything
+  // in front that grows with every triangle
+  TileGrid grid(bounds, triangle_count);
+  std::vector<Polygon> kept;
+  std::vector<CGAL::Bbox_2> kept_boxes;
+  // the last triangle each kept one was gathered for, so triangles spanning
+  // several tiles are only cut away once
+  std::vector<size_t> gathered_for;
+  std::map<uint32_t, std::vector<PolygonWithHoles>> pieces_by_color;
+  for (size_t tri_idx = triangle_count; tri_idx-- > 0;) {
+    std::array<Point, 3> corners;
+    for (size_t vert_idx = 0; vert_idx < 3; ++vert_idx) {
+      const sf::Vector2f &position = view[tri_idx * 3 + vert_idx].position;
+      corners[vert_idx] = Point(position.x, position.y);
+    }
+    if (CGAL::collinear(corners[0], corners[1], corners[2]))
+      continue; // edge on, covers nothing
+    Polygon triangle(corners.begin(), corners.end());
+    if (triangle.orientation() == CGAL::CLOCKWISE)
+      triangle.reverse_orientation();
+
+    const CGAL::Bbox_2 box = triangle.bbox();
+    std::vector<Polygon> in_front;
+    grid.ForEachTile(box, [&](const std::vector<size_t> &tile) {
+      for (size_t other : tile) {
+        if (gathered_for[other] == tri_idx)
+          continue;
+        gathered_for[other] = tri_idx;
+        if (CGAL::do_overlap(box, kept_boxes[other]))
+          in_front.push_back(kept[other]);
+      }
+    });
+
+    PolygonSet uncovered(triangle);
+    if (!in_front.empty()) {
+      PolygonSet covered;
+      covered.join(in_front.begin(), in_front.end());
+      uncovered.difference(covered);
+    }
+    uncovered.polygons_with_holes(std::back_inserter(
+        pieces_by_color[view[tri_idx * 3].color.toInteger()]));
+
+    grid.ForEachTile(box, [&](std::vector<size_t> &tile) {
+      tile.push_back(kept.size());
+    });
+    kept.push_back(triangle);
+    kept_boxes.push_back(box);
+    gathered_for.push_back(triangle_count);
+  }
+
+  sf::VertexArray result(sf::PrimitiveType::Triangles);
+  for (const auto &[color_key, pieces] : pieces_by_color) {
+    // joining every piece at once is much cheaper than one at a time
+    PolygonSet region;
+    region.join(pieces.begin(), pieces.end());
+    std::vector<PolygonWithHoles> polygons;
+    region.polygons_with_holes(std::back_inserter(polygons));
+
+    Triangulation triangulation;
+    for (const PolygonWithHoles &polygon : polygons) {
+      InsertBoundary(triangulation, polygon.outer_boundary());
+      for (auto hole = polygon.holes_begin(); hole != polygon.holes_end();
+           ++hole) {
+        InsertBoundary(triangulation, *hole);
+      }
+    }
+    MarkDomains(triangulation);
+
+    const sf::Color color(color_key);
+    for (Triangulation::Face_handle face :
+         triangulation.finite_face_handles()) {
+      if (!face->info().InDomain())
+        continue;
+      for (int vert_idx = 0; vert_idx < 3; ++vert_idx) {
+        const Point &point = face->vertex(vert_idx)->point();
+        result.append(sf::Vertex{
+            sf::Vector2f(static_cast<float>(CGAL::to_double(point.x())),
+                         static_cast<float>(CGAL::to_double(point.y()))),
+            color});
+      }
+    }
+  }
+  std::cout << "[DEBUG] Merged " << triangle_count << " triangles into "
+            << result.getVertexCount() / 3 << " across "
+            << pieces_by_color.size() << " colours" << std::endl;
+  return result;
+}
+
+} // namespace hollow_lantern
@@ -0,0 +1,50 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the RegionMerger class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include <SFML/Graphics/VertexArray.hpp>
+
+namespace hollow_lantern {
+
+/////////////////////////////////////////////////
+/// @brief Merges the same coloured triangles of a projected view
+///
+/// Uses CGAL's exact 2D Boolean operations to build one polygon set per
+/// colour, then triangulates each set with a constrained Delaunay
+/// triangulation. The CGAL types stay in the implementation file.
+/////////////////////////////////////////////////
+class RegionMerger {
+
+public:
+  /////////////////////////////////////////////////
+  /// @brief Default constructor for the RegionMerger class
+  /////////////////////////////////////////////////
+  RegionMerger() = default;
+
+  /////////////////////////////////////////////////
+  /// @brief Replace a view's triangles with one region per colour
+  ///
+  /// Triangles are taken to be drawn in order, later over earlier, so each
+  /// one only contributes the part not covered by triangles after it. The
+  /// regions of different colours never overlap, so the result draws the
+  /// same picture in any order. Straight runs of boundary vertices are
+  /// collapsed before triangulating.
+  ///
+  /// Views that are not triangle lists, or that use texture coordinates,
+  /// are returned unchanged since merging would lose the texturing.
+  ///
+  /// @param view Vertex array of type triangles, e.g. from Projector
+  /// @return Vertex array of type triangles covering the same pixels
+  /////////////////////////////////////////////////
+  sf::VertexArray MergeRegions(const sf::VertexArray &view) const;
+};
+} // namespace hollow_lantern
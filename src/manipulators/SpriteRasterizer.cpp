@@ -0,0 +1,232 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Implementation of the SpriteRasterizer class
+/////////////////////////////////////////////////
+
+#include "SpriteRasterizer.h"
+#include "ParallelFor.h"
+#include <SFML/Graphics/PrimitiveType.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+namespace hollow_lantern {
+
+namespace {
+/////////////////////////////////////////////////
+/// @brief A triangle already placed on the sheet, in pixels
+/////////////////////////////////////////////////
+struct SheetTriangle {
+  std::array<sf::Vector2f, 3> corners;
+  std::array<float, 3> depths;
+  bool has_depths;
+  sf::Color color;
+  float min_x;
+  float max_x;
+  float min_y;
+  float max_y;
+};
+} // namespace
+
+/////////////////////////////////////////////////
+SpriteRasterizer::SpriteRasterizer(const SpriteSheetOptions &options)
+    : options(options) {}
+
+/////////////////////////////////////////////////
+sf::Image SpriteRasterizer::RasterizeSheet(
+    const std::vector<sf::VertexArray> &views,
+    const std::vector<std::vector<float>> &depths) const {
+  if (views.empty())
+    return {};
+
+  // every cell fits the union of all views, so frames share an origin
+  constexpr float infinity = std::numeric_limits<float>::infinity();
+  sf::Vector2f lower(infinity, infinity);
+  sf::Vector2f upper(-infinity, -infinity);
+  for (const sf::VertexArray &view : views) {
+    for (size_t vertex = 0; vertex < view.getVertexCount(); ++vertex) {
+      const sf::Vector2f &position = view[vertex].position;
+      lower = {std::min(lower.x, position.x), std::min(lower.y, position.y)};
+      upper = {std::max(upper.x, position.x), std::max(upper.y, position.y)};
+    }
+  }
+  if (lower.x > upper.x) {
+    lower = {0.0f, 0.0f};
+    upper = {0.0f, 0.0f};
+  }
+
+  const float scale = options.pixels_per_unit;
+  const unsigned int padding = options.padding;
+  const unsigned int cell_width =
+      std::max(1u, static_cast<unsigned int>(
+                       std::ceil((upper.x - lower.x) * scale))) +
+      2 * padding;
+  const unsigned int cell_height =
+      std::max(1u, static_cast<unsigned int>(
+                       std::ceil((upper.y - lower.y) * scale))) +
+      2 * padding;
+  const size_t columns =
+      options.columns != 0
+          ? options.columns
+          : static_cast<size_t>(
+                std::ceil(std::sqrt(static_cast<double>(views.size()))));
+  const size_t rows = (views.size() + columns - 1) / columns;
+  const unsigned int width = cell_width * static_cast<unsigned int>(columns);
+  const unsigned int height = cell_height * static_cast<unsigned int>(rows);
+
+  // place every triangle on the sheet, keeping view and draw order
+  std::vector<SheetTriangle> triangles;
+  for (size_t view_idx = 0; view_idx < views.size(); ++view_idx) {
+    const sf::VertexArray &view = views[view_idx];
+    const bool is_strip =
+        view.getPrimitiveType() == sf::PrimitiveType::TriangleStrip;
+    if (!is_strip && view.getPrimitiveType() != sf::PrimitiveType::Triangles) {
+      std::cout << "[DEBUG] Skipping view #" << view_idx
+                << ", only triangles are rasterised" << std::endl;
+      continue;
+    }
+    // a strip's joins are triangles with no area, which cover nothing
+    const size_t step = is_strip ? 1 : 3;
+    const std::vector<float> *view_depths = nullptr;
+    if (view_idx < depths.size() && !depths[view_idx].empty()) {
+      if (depths[view_idx].size() == view.getVertexCount())
+        view_depths = &depths[view_idx];
+      else
+        std::cout << "[DEBUG] View #" << view_idx << " has "
+                  << depths[view_idx].size() << " depths for "
+                  << view.getVertexCount()
+                  << " vertices, drawing it in order" << std::endl;
+    }
+    const sf::Vector2f cell_origin(
+        static_cast<float>((view_idx % columns) * cell_width + padding),
+        static_cast<float>((view_idx / columns) * cell_height + padding));
+    for (size_t vertex = 0; vertex + 2 < view.getVertexCount();
+         vertex += step) {
+      SheetTriangle triangle;
+      for (size_t corner = 0; corner < 3; ++corner) {
+        triangle.corners[corner] =
+            (view[vertex + corner].position - lower) * scale + cell_origin;
+        triangle.depths[corner] =
+            view_depths != nullptr ? (*view_depths)[vertex + corner] : 0.0f;
+      }
+      triangle.has_depths = view_depths != nullptr;
+      triangle.color = view[vertex].color;
+      const auto &[a, b, c] = triangle.corners;
+      triangle.min_x = std::min({a.x, b.x, c.x});
+      triangle.max_x = std::max({a.x, b.x, c.x});
+      triangle.min_y = std::min({a.y, b.y, c.y});
+      triangle.max_y = std::max({a.y, b.y, c.y});
+      triangles.push_back(triangle);
+    }
+  }
+
+  // bin triangles into the tiles their bounding boxes touch, in order
+  const unsigned int tiles_x = (width + tile_size - 1) / tile_size;
+  const unsigned int tiles_y = (height + tile_size - 1) / tile_size;
+  std::vector<std::vector<uint32_t>> bins(static_cast<size_t>(tiles_x) *
+                                          tiles_y);
+  auto tile_of = [](float pixel, unsigned int tile_count) {
+    const float tile = std::floor(pixel / static_cast<float>(tile_size));
+    return static_cast<unsigned int>(
+        std::clamp(tile, 0.0f, static_cast<float>(tile_count - 1)));
+  };
+  for (size_t tri_idx = 0; tri_idx < triangles.size(); ++tri_idx) {
+    const SheetTriangle &triangle = triangles[tri_idx];
+    for (unsigned int ty = tile_of(triangle.min_y, tiles_y);
+         ty <= tile_of(triangle.max_y, tiles_y); ++ty) {
+      for (unsigned int tx = tile_of(triangle.min_x, tiles_x);
+           tx <= tile_of(triangle.max_x, tiles_x); ++tx) {
+        bins[static_cast<size_t>(ty) * tiles_x + tx].push_back(
+            static_cast<uint32_t>(tri_idx));
+      }
+    }
+  }
+
+  std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+  for (size_t pixel = 0; pixel < pixels.size(); pixel += 4) {
+    pixels[pixel] = options.background.r;
+    pixels[pixel + 1] = options.background.g;
+    pixels[pixel + 2] = options.background.b;
+    pixels[pixel + 3] = options.background.a;
+  }
+
+  // tiles never share pixels, so they are filled concurrently
+  ParallelFor(bins.size(), options.thread_count, [&](size_t tile) {
+    const unsigned int tile_left =
+        static_cast<unsigned int>(tile % tiles_x) * tile_size;
+    const unsigned int tile_top =
+        static_cast<unsigned int>(tile / tiles_x) * tile_size;
+    const unsigned int tile_right = std::min(tile_left + tile_size, width);
+    const unsigned int tile_bottom = std::min(tile_top + tile_size, height);
+    // nearest depth drawn at each pixel of the tile, every pixel belongs to
+    // one view's cell so views never test against each other
+    std::array<float, tile_size * tile_size> nearest;
+    nearest.fill(infinity);
+
+    for (const uint32_t tri_idx : bins[tile]) {
+      const SheetTriangle &triangle = triangles[tri_idx];
+      const auto &[a, b, c] = triangle.corners;
+      const float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+      if (area == 0.0f)
+        continue; // edge on, covers nothing
+
+      // pixel centres inside the triangle's box and this tile
+      const auto first = [](float lowest, unsigned int start) {
+        return std::max(
+            start, static_cast<unsigned int>(
+                       std::max(0.0f, std::ceil(lowest - 0.5f))));
+      };
+      const auto last = [](float highest, unsigned int stop) {
+        return std::min(stop, static_cast<unsigned int>(std::max(
+                                  0.0f, std::floor(highest - 0.5f) + 1.0f)));
+      };
+      const unsigned int x_begin = first(triangle.min_x, tile_left);
+      const unsigned int x_end = last(triangle.max_x, tile_right);
+      const unsigned int y_begin = first(triangle.min_y, tile_top);
+      const unsigned int y_end = last(triangle.max_y, tile_bottom);
+
+      for (unsigned int py = y_begin; py < y_end; ++py) {
+        const float cy = static_cast<float>(py) + 0.5f;
+        for (unsigned int px = x_begin; px < x_end; ++px) {
+          const float cx = static_cast<float>(px) + 0.5f;
+          // barycentric weights, edges are inclusive so neighbours leave no
+          // gaps between them
+          const float w_a =
+              ((b.x - cx) * (c.y - cy) - (b.y - cy) * (c.x - cx)) / area;
+          const float w_b =
+              ((c.x - cx) * (a.y - cy) - (c.y - cy) * (a.x - cx)) / area;
+          const float w_c = 1.0f - w_a - w_b;
+          if (w_a < -1e-6f || w_b < -1e-6f || w_c < -1e-6f)
+            continue;
+          if (triangle.has_depths) {
+            // orthographic, so depth is linear across the screen
+            const float depth = w_a * triangle.depths[0] +
+                                w_b * triangle.depths[1] +
+                                w_c * triangle.depths[2];
+            float &tile_depth = nearest[(py - tile_top) * tile_size +
+                                        (px - tile_left)];
+            if (depth > tile_depth)
+              continue;
+            tile_depth = depth;
+          }
+          const size_t pixel = (static_cast<size_t>(py) * width + px) * 4;
+          pixels[pixel] = triangle.color.r;
+          pixels[pixel + 1] = triangle.color.g;
+          pixels[pixel + 2] = triangle.color.b;
+          pixels[pixel + 3] = triangle.color.a;
+        }
+      }
+    }
+  });
+
+  std::cout << "[DEBUG] Rasterised " << views.size() << " views, "
+            << triangles.size() << " triangles into a " << width << "x"
+            << height << " sheet" << std::endl;
+  return sf::Image({width, height}, pixels.data());
+}
+
+} // namespace hollow_lantern
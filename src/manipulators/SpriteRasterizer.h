@@ -0,0 +1,100 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the SpriteRasterizer class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
+#include <cstddef>
+#include <vector>
+
+namespace hollow_lantern {
+
+/////////////////////////////////////////////////
+/// @brief Layout and quality settings for a sprite sheet
+/////////////////////////////////////////////////
+struct SpriteSheetOptions {
+  /////////////////////////////////////////////////
+  /// @brief Pixels per unit of the projected views, i.e. per source voxel
+  /////////////////////////////////////////////////
+  float pixels_per_unit{8.0f};
+
+  /////////////////////////////////////////////////
+  /// @brief Empty pixels around every sprite
+  /////////////////////////////////////////////////
+  unsigned int padding{1};
+
+  /////////////////////////////////////////////////
+  /// @brief Sprites per row, 0 for a roughly square sheet
+  /////////////////////////////////////////////////
+  size_t columns{0};
+
+  /////////////////////////////////////////////////
+  /// @brief Threads used to fill tiles, 0 for one per hardware thread
+  /////////////////////////////////////////////////
+  size_t thread_count{0};
+
+  /////////////////////////////////////////////////
+  /// @brief Colour of pixels no triangle covers
+  /////////////////////////////////////////////////
+  sf::Color background{sf::Color::Transparent};
+};
+
+/////////////////////////////////////////////////
+/// @brief Turns projected views into pixels without a window or GPU
+///
+/// Every view gets a cell of the same size, large enough for the biggest,
+/// and views keep their offset from the origin so frames line up. The sheet
+/// is split into square tiles, triangles are binned into the tiles they
+/// touch and the tiles are filled in parallel. Views with depths keep the
+/// nearest triangle at every pixel, the later one on a tie, using a depth
+/// buffer per tile. Views without are drawn in order, later over earlier, the
+/// same as drawing the vertex array.
+/////////////////////////////////////////////////
+class SpriteRasterizer {
+
+private:
+  /////////////////////////////////////////////////
+  /// @brief Edge length of a tile in pixels
+  /////////////////////////////////////////////////
+  static constexpr unsigned int tile_size{32};
+
+  SpriteSheetOptions options;
+
+public:
+  /////////////////////////////////////////////////
+  /// @brief Default constructor for the SpriteRasterizer class
+  /////////////////////////////////////////////////
+  SpriteRasterizer() = default;
+
+  /////////////////////////////////////////////////
+  /// @brief Construct a SpriteRasterizer with the given options
+  /////////////////////////////////////////////////
+  explicit SpriteRasterizer(const SpriteSheetOptions &options);
+
+  /////////////////////////////////////////////////
+  /// @brief Rasterise views into one sprite sheet
+  ///
+  /// Cells are filled row by row in view order.
+  ///
+  /// @param views Vertex arrays of type triangles or triangle strip, e.g.
+  /// projected_data
+  /// @param depths Depth of every vertex of each view, smaller is nearer,
+  /// e.g. projected_depths. Views past its end or with an empty list are
+  /// drawn in order
+  /// @return The sheet, empty if there are no views
+  /////////////////////////////////////////////////
+  sf::Image
+  RasterizeSheet(const std::vector<sf::VertexArray> &views,
+                 const std::vector<std::vector<float>> &depths = {}) const;
+};
+} // namespace hollow_lantern
@@ -0,0 +1,143 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Implementation of the TriangleStripper class
+/////////////////////////////////////////////////
+
+#include "TriangleStripper.h"
+#include <SFML/Graphics/PrimitiveType.hpp>
+#include <array>
+#include <iostream>
+#include <utility>
+
+namespace hollow_lantern {
+
+namespace {
+/////////////////////////////////////////////////
+/// @brief Vertices of a list that can be shared by neighbouring strip
+/// triangles
+/////////////////////////////////////////////////
+bool SameVertex(const sf::VertexArray &view, const std::vector<float> *depths,
+                size_t lhs, size_t rhs) {
+  if (depths != nullptr && (*depths)[lhs] != (*depths)[rhs])
+    return false;
+  return view[lhs].position == view[rhs].position &&
+         view[lhs].color == view[rhs].color &&
+         view[lhs].texCoords == view[rhs].texCoords;
+}
+
+/////////////////////////////////////////////////
+/// @brief Index of a triangle's corner matching a vertex, or 3 if none
+/////////////////////////////////////////////////
+size_t FindCorner(const sf::VertexArray &view,
+                  const std::vector<float> *depths, size_t triangle,
+                  size_t vertex) {
+  for (size_t corner = 0; corner < 3; ++corner) {
+    if (SameVertex(view, depths, triangle * 3 + corner, vertex))
+      return corner;
+  }
+  return 3;
+}
+
+/////////////////////////////////////////////////
+/// @brief Order a triangle's corners are read in at a strip position
+///
+/// Odd strip triangles are drawn as n + 1, n, n + 2, so reading them as
+/// corners 0, 2, 1 draws every triangle with the winding of the list.
+/////////////////////////////////////////////////
+std::array<size_t, 3> CornerOrder(size_t position) {
+  if (position % 2 == 0)
+    return {0, 1, 2};
+  return {0, 2, 1};
+}
+
+/////////////////////////////////////////////////
+/// @brief Check a triangle can extend a strip ending on two list vertices
+///
+/// @param position Strip position the triangle would start at
+/////////////////////////////////////////////////
+bool CanExtend(const sf::VertexArray &view, const std::vector<float> *depths,
+               size_t triangle, size_t position, size_t second_last,
+               size_t last) {
+  const std::array<size_t, 3> order = CornerOrder(position);
+  return FindCorner(view, depths, triangle, second_last) == order[0] &&
+         FindCorner(view, depths, triangle, last) == order[1];
+}
+} // namespace
+
+/////////////////////////////////////////////////
+sf::VertexArray
+TriangleStripper::Stripify(const sf::VertexArray &view,
+                           std::vector<size_t> *origins,
+                           const std::vector<float> *depths) const {
+  if (origins != nullptr)
+    origins->clear();
+  if (view.getPrimitiveType() != sf::PrimitiveType::Triangles) {
+    std::cout << "[DEBUG] Only triangle lists can be stripified" << std::endl;
+    return view;
+  }
+  const size_t triangle_count = view.getVertexCount() / 3;
+  if (depths != nullptr && depths->size() != view.getVertexCount()) {
+    std::cout << "[DEBUG] Expected " << view.getVertexCount()
+              << " depths, got " << depths->size() << ", ignoring them"
+              << std::endl;
+    depths = nullptr;
+  }
+
+  sf::VertexArray strip(sf::PrimitiveType::TriangleStrip);
+  // the list vertex behind every strip vertex, kept even if nobody asked as
+  // vertices are compared by where they came from
+  std::vector<size_t> copied_from;
+  auto append = [&](size_t vertex) {
+    strip.append(view[vertex]);
+    copied_from.push_back(vertex);
+  };
+  size_t strip_count = 0;
+  for (size_t tri_idx = 0; tri_idx < triangle_count; ++tri_idx) {
+    // extend the strip if this triangle shares its last edge in the order
+    // its position reads it
+    const size_t size = strip.getVertexCount();
+    if (size >= 2 && CanExtend(view, depths, tri_idx, size - 2,
+                               copied_from[size - 2], copied_from[size - 1])) {
+      append(tri_idx * 3 + CornerOrder(size - 2)[2]);
+      continue;
+    }
+
+    // start a new strip at whichever position lets the next triangle extend
+    // it, padding with one more repeated vertex if that position is not the
+    // nearest
+    const size_t nearest = size == 0 ? 0 : size + 2;
+    size_t position = nearest;
+    if (tri_idx + 1 < triangle_count) {
+      for (size_t candidate : {nearest, nearest + 1}) {
+        const std::array<size_t, 3> order = CornerOrder(candidate);
+        if (CanExtend(view, depths, tri_idx + 1, candidate + 1,
+                      tri_idx * 3 + order[1], tri_idx * 3 + order[2])) {
+          position = candidate;
+          break;
+        }
+      }
+    }
+    // the repeated vertices only form triangles with no area
+    if (size > 0)
+      append(copied_from[size - 1]);
+    while (strip.getVertexCount() < position)
+      append(tri_idx * 3);
+    for (size_t corner : CornerOrder(position))
+      append(tri_idx * 3 + corner);
+    ++strip_count;
+  }
+
+  if (strip.getVertexCount() >= triangle_count * 3) {
+    std::cout << "[DEBUG] Strips would not be smaller, keeping "
+              << triangle_count << " triangles as a list" << std::endl;
+    return view;
+  }
+  std::cout << "[DEBUG] Stripified " << triangle_count << " triangles into "
+            << strip_count << " strips of " << strip.getVertexCount()
+            << " vertices" << std::endl;
+  if (origins != nullptr)
+    *origins = std::move(copied_from);
+  return strip;
+}
+
+} // namespace hollow_lantern
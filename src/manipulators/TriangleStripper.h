@@ -0,0 +1,60 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the TriangleStripper class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include <SFML/Graphics/VertexArray.hpp>
+#include <cstddef>
+#include <vector>
+
+namespace hollow_lantern {
+
+/////////////////////////////////////////////////
+/// @brief Rewrites triangle lists as one triangle strip
+///
+/// The mesher emits each quad as two triangles sharing an edge, and quads of
+/// a row share an edge with the next, so runs of them turn into strips of
+/// two vertices per quad plus two. Draw order is kept: a triangle only
+/// extends the strip if it shares the strip's last edge and every vertex of
+/// that edge, colour and texture coordinates included, otherwise a new
+/// strip starts. Corner order is kept too: strip triangle n is corners 0, 1,
+/// 2 of its list triangle for even n and 0, 2, 1 for odd n, so winding and
+/// barycentric weights carry over. Strips are chained by repeating the last
+/// vertex of one and the first of the next, once more if that puts the next
+/// triangle where it can be extended, which only adds triangles with no area,
+/// as vertex arrays have no primitive restart.
+/////////////////////////////////////////////////
+class TriangleStripper {
+
+public:
+  /////////////////////////////////////////////////
+  /// @brief Default constructor for the TriangleStripper class
+  /////////////////////////////////////////////////
+  TriangleStripper() = default;
+
+  /////////////////////////////////////////////////
+  /// @brief Turn a view's triangles into a triangle strip
+  ///
+  /// @param view Vertex array of type triangles
+  /// @param origins If given, overwritten with the index into view of the
+  /// vertex each strip vertex copies, or left empty if view is returned
+  /// unchanged. Joins aside, strip triangle n comes from list triangle
+  /// origins[n + 2] / 3
+  /// @param depths If given, one per vertex of view, and vertices are only
+  /// shared if their depths match as well
+  /// @return Vertex array of type triangle strip, or view unchanged if it is
+  /// not a triangle list or a strip would not have fewer vertices
+  /////////////////////////////////////////////////
+  sf::VertexArray Stripify(const sf::VertexArray &view,
+                           std::vector<size_t> *origins = nullptr,
+                           const std::vector<float> *depths = nullptr) const;
+};
+} // namespace hollow_lantern
@@ -0,0 +1,159 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Implementation of the batched vertex transform kernel
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "VertexTransform.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define HOLLOW_LANTERN_SSE2 1
+#endif
+
+namespace hollow_lantern {
+
+namespace {
+
+/////////////////////////////////////////////////
+/// @brief One row of an affine matrix, out = x * a + y * b + z * c + d
+/////////////////////////////////////////////////
+struct MatrixRow {
+  float a, b, c, d;
+};
+
+/////////////////////////////////////////////////
+/// @brief Pull row `row` out of a column-major glm matrix
+/////////////////////////////////////////////////
+MatrixRow ExtractRow(const glm::mat4 &matrix, int row) {
+  return {matrix[0][row], matrix[1][row], matrix[2][row], matrix[3][row]};
+}
+
+/////////////////////////////////////////////////
+/// @brief Scalar row evaluation, also used for the tail of the SIMD kernels
+/////////////////////////////////////////////////
+void TransformRowScalar(const MatrixRow &row, const float *x, const float *y,
+                        const float *z, float *out, size_t begin,
+                        size_t end) {
+  for (size_t idx = begin; idx < end; ++idx) {
+    out[idx] = x[idx] * row.a + y[idx] * row.b + z[idx] * row.c + row.d;
+  }
+}
+
+#if defined(__AVX2__)
+/////////////////////////////////////////////////
+/// @brief Evaluate one row for eight positions per iteration
+/////////////////////////////////////////////////
+void TransformRow(const MatrixRow &row, const float *x, const float *y,
+                  const float *z, float *out, size_t count) {
+  const __m256 a = _mm256_set1_ps(row.a);
+  const __m256 b = _mm256_set1_ps(row.b);
+  const __m256 c = _mm256_set1_ps(row.c);
+  const __m256 d = _mm256_set1_ps(row.d);
+  size_t idx = 0;
+  for (; idx + 8 <= count; idx += 8) {
+    const __m256 vx = _mm256_loadu_ps(x + idx);
+    const __m256 vy = _mm256_loadu_ps(y + idx);
+    const __m256 vz = _mm256_loadu_ps(z + idx);
+#if defined(__FMA__)
+    __m256 result = _mm256_fmadd_ps(vx, a, d);
+    result = _mm256_fmadd_ps(vy, b, result);
+    result = _mm256_fmadd_ps(vz, c, result);
+#else
+    __m256 result = _mm256_add_ps(_mm256_mul_ps(vx, a), d);
+    result = _mm256_add_ps(_mm256_mul_ps(vy, b), result);
+    result = _mm256_add_ps(_mm256_mul_ps(vz, c), result);
+#endif
+    _mm256_storeu_ps(out + idx, result);
+  }
+  TransformRowScalar(row, x, y, z, out, idx, count);
+}
+#elif defined(HOLLOW_LANTERN_SSE2)
+/////////////////////////////////////////////////
+/// @brief Evaluate one row for four positions per iteration
+/////////////////////////////////////////////////
+void TransformRow(const MatrixRow &row, const float *x, const float *y,
+                  const float *z, float *out, size_t count) {
+  const __m128 a = _mm_set1_ps(row.a);
+  const __m128 b = _mm_set1_ps(row.b);
+  const __m128 c = _mm_set1_ps(row.c);
+  const __m128 d = _mm_set1_ps(row.d);
+  size_t idx = 0;
+  for (; idx + 4 <= count; idx += 4) {
+    __m128 result = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(x + idx), a), d);
+    result = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(y + idx), b), result);
+    result = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(z + idx), c), result);
+    _mm_storeu_ps(out + idx, result);
+  }
+  TransformRowScalar(row, x, y, z, out, idx, count);
+}
+#else
+/////////////////////////////////////////////////
+/// @brief Portable fallback, simple enough for the compiler to vectorise
+/////////////////////////////////////////////////
+void TransformRow(const MatrixRow &row, const float *x, const float *y,
+                  const float *z, float *out, size_t count) {
+  TransformRowScalar(row, x, y, z, out, 0, count);
+}
+#endif
+
+} // namespace
+
+/////////////////////////////////////////////////
+VertexBuffer VertexBuffer::FromTriangles(
+    const std::vector<Triangle> &triangles) {
+  VertexBuffer buffer;
+  const size_t count = triangles.size() * 3;
+  buffer.x.resize(count);
+  buffer.y.resize(count);
+  buffer.z.resize(count);
+  for (size_t tri_idx = 0; tri_idx < triangles.size(); ++tri_idx) {
+    for (size_t vert_idx = 0; vert_idx < 3; ++vert_idx) {
+      const glm::vec3 &vertex = triangles[tri_idx].vertices[vert_idx];
+      buffer.x[tri_idx * 3 + vert_idx] = vertex.x;
+      buffer.y[tri_idx * 3 + vert_idx] = vertex.y;
+      buffer.z[tri_idx * 3 + vert_idx] = vertex.z;
+    }
+  }
+  return buffer;
+}
+
+/////////////////////////////////////////////////
+void TransformVertices(const glm::mat4 &matrix, const VertexBuffer &input,
+                       VertexBuffer &output, bool with_depth) {
+  const size_t count = input.Size();
+  output.x.resize(count);
+  output.y.resize(count);
+  if (with_depth) {
+    output.z.resize(count);
+  } else {
+    output.z.clear();
+  }
+
+  // rows are evaluated one after another so each pass streams through the
+  // inputs with four broadcast coefficients and no shuffles
+  const float *x = input.x.data();
+  const float *y = input.y.data();
+  const float *z = input.z.data();
+  TransformRow(ExtractRow(matrix, 0), x, y, z, output.x.data(), count);
+  TransformRow(ExtractRow(matrix, 1), x, y, z, output.y.data(), count);
+  if (with_depth)
+    TransformRow(ExtractRow(matrix, 2), x, y, z, output.z.data(), count);
+}
+
+/////////////////////////////////////////////////
+const char *VertexTransformKernelName() {
+#if defined(__AVX2__)
+  return "AVX2";
+#elif defined(HOLLOW_LANTERN_SSE2)
+  return "SSE2";
+#else
+  return "scalar";
+#endif
+}
+
+} // namespace hollow_lantern
@@ -0,0 +1,64 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the batched vertex transform kernel
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include <glm/mat4x4.hpp>
+#include <vector>
+
+#include "ModelData.h"
+
+namespace hollow_lantern {
+
+/////////////////////////////////////////////////
+/// @brief Vertex positions stored as one array per component
+///
+/// Keeping x, y and z apart lets the transform load a whole SIMD register of
+/// each component at once instead of shuffling vec3s.
+/////////////////////////////////////////////////
+struct VertexBuffer {
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<float> z;
+
+  size_t Size() const { return x.size(); };
+
+  /////////////////////////////////////////////////
+  /// @brief Gather every vertex of a mesh, triangle by triangle
+  ///
+  /// Vertex i of triangle t ends up at index t * 3 + i.
+  /////////////////////////////////////////////////
+  static VertexBuffer FromTriangles(const std::vector<Triangle> &triangles);
+};
+
+/////////////////////////////////////////////////
+/// @brief Transform a batch of positions by a model matrix
+///
+/// Positions are treated as points (w = 1) and the matrix is assumed to be
+/// affine, so no perspective divide is done. With with_depth false only the
+/// two rows needed for x and y are evaluated and output.z is left empty.
+///
+/// @param matrix Model matrix to apply
+/// @param input Positions to transform
+/// @param output Resized to match input and overwritten
+/// @param with_depth Also compute transformed z
+/////////////////////////////////////////////////
+void TransformVertices(const glm::mat4 &matrix, const VertexBuffer &input,
+                       VertexBuffer &output, bool with_depth = true);
+
+/////////////////////////////////////////////////
+/// @brief Name of the instruction set TransformVertices was built for
+///
+/// @return "AVX2", "SSE2" or "scalar"
+/////////////////////////////////////////////////
+const char *VertexTransformKernelName();
+
+} // namespace hollow_lantern
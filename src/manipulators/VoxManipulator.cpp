@@ -7,33 +7,593 @@
 /////////////////////////////////////////////////
 #include "VoxManipulator.h"
 #include "ModelData.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <glm/glm.hpp>
 #include <iostream> // For debug output
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace hollow_lantern {
+/////////////////////////////////////////////////
+VoxManipulator::VoxManipulator(const MeshingOptions &meshing_options)
+    : meshing_options(meshing_options) {}
+
 /////////////////////////////////////////////////
 void VoxManipulator::HollowAndMesh(ModelData &model_data) {
   std::cout << "[DEBUG] Starting HollowAndMesh()" << std::endl;
-  // Step 1: Hollow out the voxel data
-  HollowOut(model_data);
+  // Step 1: Size the masks and split the model into chunks, all dirty. The
+  // voxels may have been edited directly since they were read, so the
+  // occupancy is counted afresh rather than trusted
+  RecordOccupancy(ModelView(model_data), model_data);
+  ResizeMasks(model_data);
+  CreateChunks(model_data);
+  MarkExteriorAir(ModelView(model_data), model_data);
+
+  // Step 2: Hollow, mask and mesh every chunk
+  Remesh(model_data);
+}
+
+/////////////////////////////////////////////////
+ModelData VoxManipulator::CropAndMesh(const ModelData &model_data,
+                                      const Bounds &crop) {
+  std::cout << "[DEBUG] Starting CropAndMesh()" << std::endl;
+  const ModelView view(model_data, crop);
+
+  ModelData cropped;
+  cropped.name = model_data.name + "_crop";
+  cropped.size = view.Size();
+  cropped.voxel_scale = model_data.voxel_scale;
+  cropped.origin = model_data.origin + view.bounds.min;
+
+  // everything from here on is sized to the crop, not the model
+  const Bounds whole{{0, 0, 0}, cropped.size};
+  RecordOccupancy(view, cropped);
+  ResizeMasks(cropped);
+  MarkExteriorAir(view, cropped);
+  CreateMasks(view, cropped, whole);
+  if (meshing_options.mode == MeshingMode::GREEDY ||
+      meshing_options.mode == MeshingMode::GREEDY_ATLAS) {
+    GreedyMeshing(cropped, whole, cropped.triangles);
+  } else {
+    CreateTrianglesFromMask(cropped, whole, cropped.triangles);
+  }
+  if (meshing_options.mode == MeshingMode::GREEDY_ATLAS)
+    BuildColorAtlas(cropped);
 
-  // Step 2: Create masks based on the hollowed voxel data
-  CreateMasks(model_data);
+  std::cout << "[DEBUG] Cropped " << cropped.size.x << "x" << cropped.size.y
+            << "x" << cropped.size.z << " at (" << cropped.origin.x << ", "
+            << cropped.origin.y << ", " << cropped.origin.z << ") into "
+            << cropped.triangles.size() << " triangles" << std::endl;
+  return cropped;
+}
 
-  CreateTrianglesFromMask(model_data);
-  // Step 3: Generate triangles from the masks
-  // GreedyMeshing(model_data);
+/////////////////////////////////////////////////
+bool VoxManipulator::SetVoxel(ModelData &model_data,
+                              const sf::Vector3i &position,
+                              const sf::Color &color) {
+  if (position.x < 0 || position.y < 0 || position.z < 0 ||
+      position.x >= model_data.size.x || position.y >= model_data.size.y ||
+      position.z >= model_data.size.z) {
+    std::cerr << "[DEBUG] SetVoxel position (" << position.x << ", "
+              << position.y << ", " << position.z << ") out of bounds!"
+              << std::endl;
+    return false;
+  }
+  Voxel &voxel = model_data.voxel_data[position.x][position.y][position.z];
+  const bool was_visible = voxel.is_visible;
+  if (!was_visible && model_data.occupancy.Matches(model_data.size))
+    model_data.occupancy.Add(position.x, position.y, position.z);
+  voxel.color = color;
+  voxel.is_visible = true;
+  MarkChunksDirty(model_data, position);
+  if (!was_visible && !model_data.chunks.empty() &&
+      ExteriorAirMatches(model_data))
+    SealExteriorAir(model_data, position);
+  return true;
 }
+
 /////////////////////////////////////////////////
-void VoxManipulator::HollowOut(ModelData &model_data) {
-  std::cout << "[DEBUG] Starting HollowOut()" << std::endl;
+bool VoxManipulator::ClearVoxel(ModelData &model_data,
+                                const sf::Vector3i &position) {
+  if (position.x < 0 || position.y < 0 || position.z < 0 ||
+      position.x >= model_data.size.x || position.y >= model_data.size.y ||
+      position.z >= model_data.size.z) {
+    std::cerr << "[DEBUG] ClearVoxel position (" << position.x << ", "
+              << position.y << ", " << position.z << ") out of bounds!"
+              << std::endl;
+    return false;
+  }
+  Voxel &voxel = model_data.voxel_data[position.x][position.y][position.z];
+  const bool was_visible = voxel.is_visible;
+  if (was_visible && model_data.occupancy.Matches(model_data.size))
+    model_data.occupancy.Remove(position.x, position.y, position.z);
+  voxel.is_visible = false;
+  voxel.is_internal_voxel = false;
 
-  // check all neighbors of each voxel and see if visisble or not
-  for (int x = 0; x < model_data.size.x; ++x) {
-    for (int y = 0; y < model_data.size.y; ++y) {
-      for (int z = 0; z < model_data.size.z; ++z) {
+  // the mask loops skip empty rows, so the faces of the cleared voxel have to
+  // be removed here rather than being overwritten on the next remesh
+  for (auto &mask : model_data.masks) {
+    if (mask.data.empty())
+      continue;
+    switch (mask.direction) {
+    case Direction::X_POSITIVE:
+    case Direction::X_NEGATIVE:
+      mask.data[position.x][position.y][position.z] = std::nullopt;
+      break;
+    case Direction::Y_POSITIVE:
+    case Direction::Y_NEGATIVE:
+      mask.data[position.y][position.z][position.x] = std::nullopt;
+      break;
+    case Direction::Z_POSITIVE:
+    case Direction::Z_NEGATIVE:
+      mask.data[position.z][position.x][position.y] = std::nullopt;
+      break;
+    default:
+      break;
+    }
+  }
+  MarkChunksDirty(model_data, position);
+  if (was_visible && !model_data.chunks.empty() &&
+      ExteriorAirMatches(model_data))
+    OpenExteriorAir(model_data, position);
+  return true;
+}
+
+/////////////////////////////////////////////////
+void VoxManipulator::ApplyVoxelEdits(ModelData &model_data,
+                                     const std::vector<VoxelEdit> &edits) {
+  for (const auto &edit : edits) {
+    if (edit.color.has_value()) {
+      SetVoxel(model_data, edit.position, edit.color.value());
+    } else {
+      ClearVoxel(model_data, edit.position);
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+void VoxManipulator::Remesh(ModelData &model_data) {
+  if (model_data.chunks.empty()) {
+    // nothing has been meshed yet, so there is nothing to reuse
+    RecordOccupancy(ModelView(model_data), model_data);
+    ResizeMasks(model_data);
+    CreateChunks(model_data);
+    MarkExteriorAir(ModelView(model_data), model_data);
+  } else if (!ExteriorAirMatches(model_data)) {
+    // the masks were built against air that no longer fits, start over
+    MarkExteriorAir(ModelView(model_data), model_data);
+    for (Chunk &chunk : model_data.chunks)
+      chunk.is_dirty = true;
+  }
+
+  // the atlas only needs packing from scratch if no clean chunk has tiles
+  // worth keeping
+  const bool repack_dirty_tiles =
+      meshing_options.mode == MeshingMode::GREEDY_ATLAS &&
+      !model_data.color_atlas.pixels.empty() &&
+      std::any_of(model_data.chunks.begin(), model_data.chunks.end(),
+                  [](const Chunk &chunk) { return !chunk.is_dirty; });
+
+  // mesh the dirty chunks into their own vectors first, the clean chunks still
+  // point into the current triangle list
+  std::vector<std::vector<Triangle>> remeshed(model_data.chunks.size());
+  std::vector<size_t> dirty_chunks;
+  for (size_t idx = 0; idx < model_data.chunks.size(); ++idx) {
+    const Chunk &chunk = model_data.chunks[idx];
+    if (!chunk.is_dirty)
+      continue;
+    if (repack_dirty_tiles)
+      FreeAtlasTiles(model_data, chunk);
+    HollowOut(model_data, chunk.bounds);
+    CreateMasks(ModelView(model_data), model_data, chunk.bounds);
+    if (meshing_options.mode == MeshingMode::GREEDY ||
+        meshing_options.mode == MeshingMode::GREEDY_ATLAS) {
+      GreedyMeshing(model_data, chunk.bounds, remeshed[idx]);
+    } else {
+      CreateTrianglesFromMask(model_data, chunk.bounds, remeshed[idx]);
+    }
+    dirty_chunks.push_back(idx);
+  }
+  std::cout << "[DEBUG] Remeshed " << dirty_chunks.size() << " of "
+            << model_data.chunks.size() << " chunks" << std::endl;
+  if (dirty_chunks.empty())
+    return;
+
+  // stitch clean and remeshed chunks back together in chunk order
+  std::vector<Triangle> triangles;
+  size_t total = 0;
+  for (size_t idx = 0; idx < model_data.chunks.size(); ++idx) {
+    const Chunk &chunk = model_data.chunks[idx];
+    total += chunk.is_dirty ? remeshed[idx].size() : chunk.triangle_count;
+  }
+  triangles.reserve(total);
+
+  for (size_t idx = 0; idx < model_data.chunks.size(); ++idx) {
+    Chunk &chunk = model_data.chunks[idx];
+    size_t offset = triangles.size();
+    if (chunk.is_dirty) {
+      triangles.insert(triangles.end(), remeshed[idx].begin(),
+                       remeshed[idx].end());
+    } else {
+      auto first = model_data.triangles.begin() + chunk.triangle_offset;
+      triangles.insert(triangles.end(), first, first + chunk.triangle_count);
+    }
+    chunk.triangle_offset = offset;
+    chunk.triangle_count = triangles.size() - offset;
+    chunk.is_dirty = false;
+  }
+  model_data.triangles = std::move(triangles);
+
+  // clean chunks keep their tiles unless the dirty ones do not fit around
+  // them
+  if (meshing_options.mode == MeshingMode::GREEDY_ATLAS &&
+      (!repack_dirty_tiles || !PackAtlasTiles(model_data, dirty_chunks))) {
+    BuildColorAtlas(model_data);
+  }
+}
+
+/////////////////////////////////////////////////
+void VoxManipulator::GenerateLevelsOfDetail(ModelData &model_data,
+                                            size_t level_count) {
+  std::cout << "[DEBUG] Starting GenerateLevelsOfDetail()" << std::endl;
+  model_data.levels_of_detail.clear();
+  model_data.levels_of_detail.reserve(level_count);
+
+  for (size_t level = 0; level < level_count; ++level) {
+    // each level is built from the previous one rather than the source, so
+    // the cost of a level is proportional to its parent's size
+    const ModelData &parent =
+        level == 0 ? model_data : model_data.levels_of_detail.back();
+    if (parent.size.x <= 1 && parent.size.y <= 1 && parent.size.z <= 1)
+      break; // can't get any coarser
+
+    ModelData coarse = Downsample(parent);
+    HollowAndMesh(coarse);
+    std::cout << "[DEBUG] Level of detail x" << coarse.voxel_scale << ": "
+              << coarse.size.x << "x" << coarse.size.y << "x" << coarse.size.z
+              << " with " << coarse.triangles.size() << " triangles"
+              << std::endl;
+    model_data.levels_of_detail.push_back(std::move(coarse));
+  }
+}
+
+/////////////////////////////////////////////////
+ModelData VoxManipulator::Downsample(const ModelData &model_data) const {
+  ModelData coarse;
+  coarse.name = model_data.name + "_lod" +
+                std::to_string(model_data.voxel_scale * 2);
+  coarse.voxel_scale = model_data.voxel_scale * 2;
+  coarse.size = {(model_data.size.x + 1) / 2, (model_data.size.y + 1) / 2,
+                 (model_data.size.z + 1) / 2};
+  coarse.occupancy.Reset(coarse.size);
+
+  // only blocks overlapping the occupied bounds can hold a visible voxel
+  Bounds occupied = model_data.occupancy.bounds;
+  if (!model_data.occupancy.Matches(model_data.size))
+    occupied = {{0, 0, 0}, model_data.size};
+  const Bounds blocks{
+      {occupied.min.x / 2, occupied.min.y / 2, occupied.min.z / 2},
+      {(occupied.max.x + 1) / 2, (occupied.max.y + 1) / 2,
+       (occupied.max.z + 1) / 2}};
+
+  coarse.voxel_data.resize(coarse.size.x);
+  for (int x = 0; x < coarse.size.x; ++x) {
+    coarse.voxel_data[x].resize(coarse.size.y);
+    for (int y = 0; y < coarse.size.y; ++y) {
+      coarse.voxel_data[x][y].resize(coarse.size.z);
+      for (int z = 0; z < coarse.size.z; ++z) {
+        if (!blocks.Contains(x, y, z))
+          continue;
+        // tally the colours of the visible voxels in the 2x2x2 block
+        std::array<sf::Color, 8> colors;
+        std::array<int, 8> counts{};
+        size_t distinct = 0;
+        for (int dx = 0; dx < 2; ++dx) {
+          for (int dy = 0; dy < 2; ++dy) {
+            for (int dz = 0; dz < 2; ++dz) {
+              const int fx = x * 2 + dx;
+              const int fy = y * 2 + dy;
+              const int fz = z * 2 + dz;
+              if (fx >= model_data.size.x || fy >= model_data.size.y ||
+                  fz >= model_data.size.z)
+                continue;
+              const Voxel &fine = model_data.voxel_data[fx][fy][fz];
+              if (!fine.is_visible)
+                continue;
+              size_t idx = 0;
+              while (idx < distinct && colors[idx] != fine.color)
+                ++idx;
+              if (idx == distinct) {
+                colors[distinct++] = fine.color;
+              }
+              ++counts[idx];
+            }
+          }
+        }
+        if (distinct == 0)
+          continue;
+
+        // dominant colour wins, ties go to the first colour found
+        size_t dominant = 0;
+        for (size_t idx = 1; idx < distinct; ++idx) {
+          if (counts[idx] > counts[dominant])
+            dominant = idx;
+        }
+        Voxel &voxel = coarse.voxel_data[x][y][z];
+        voxel.color = colors[dominant];
+        voxel.is_visible = true;
+        coarse.occupancy.Add(x, y, z);
+      }
+    }
+  }
+  return coarse;
+}
+
+/////////////////////////////////////////////////
+void VoxManipulator::CreateChunks(ModelData &model_data) {
+  const int chunk_size = ModelData::chunk_size;
+  model_data.chunk_count = {
+      (model_data.size.x + chunk_size - 1) / chunk_size,
+      (model_data.size.y + chunk_size - 1) / chunk_size,
+      (model_data.size.z + chunk_size - 1) / chunk_size};
+
+  model_data.chunks.clear();
+  model_data.chunks.reserve(model_data.chunk_count.x *
+                            model_data.chunk_count.y *
+                            model_data.chunk_count.z);
+  for (int cx = 0; cx < model_data.chunk_count.x; ++cx) {
+    for (int cy = 0; cy < model_data.chunk_count.y; ++cy) {
+      for (int cz = 0; cz < model_data.chunk_count.z; ++cz) {
+        Chunk chunk;
+        chunk.bounds.min = {cx * chunk_size, cy * chunk_size, cz * chunk_size};
+        chunk.bounds.max = {std::min((cx + 1) * chunk_size, model_data.size.x),
+                            std::min((cy + 1) * chunk_size, model_data.size.y),
+                            std::min((cz + 1) * chunk_size, model_data.size.z)};
+        model_data.chunks.push_back(chunk);
+      }
+    }
+  }
+  std::cout << "[DEBUG] Created " << model_data.chunks.size() << " chunks ("
+            << model_data.chunk_count.x << "x" << model_data.chunk_count.y
+            << "x" << model_data.chunk_count.z << ")" << std::endl;
+}
+
+/////////////////////////////////////////////////
+void VoxManipulator::MarkChunksDirty(ModelData &model_data,
+                                     const sf::Vector3i &position) {
+  if (model_data.chunks.empty())
+    return; // not meshed yet, HollowAndMesh will pick up the edit
+
+  const std::array<sf::Vector3i, 7> affected{
+      position,
+      sf::Vector3i(position.x - 1, position.y, position.z),
+      sf::Vector3i(position.x + 1, position.y, position.z),
+      sf::Vector3i(position.x, position.y - 1, position.z),
+      sf::Vector3i(position.x, position.y + 1, position.z),
+      sf::Vector3i(position.x, position.y, position.z - 1),
+      sf::Vector3i(position.x, position.y, position.z + 1)};
+
+  for (const auto &voxel : affected) {
+    if (voxel.x < 0 || voxel.y < 0 || voxel.z < 0 ||
+        voxel.x >= model_data.size.x || voxel.y >= model_data.size.y ||
+        voxel.z >= model_data.size.z)
+      continue;
+    const int cx = voxel.x / ModelData::chunk_size;
+    const int cy = voxel.y / ModelData::chunk_size;
+    const int cz = voxel.z / ModelData::chunk_size;
+    model_data
+        .chunks[(cx * model_data.chunk_count.y + cy) *
+                    model_data.chunk_count.z +
+                cz]
+        .is_dirty = true;
+  }
+}
+
+/////////////////////////////////////////////////
+bool VoxManipulator::ExteriorAirMatches(const ModelData &model_data) const {
+  const auto &exterior_air = model_data.exterior_air;
+  const sf::Vector3i &size = model_data.size;
+  if (exterior_air.size() != static_cast<size_t>(size.x))
+    return false;
+  return size.x == 0 ||
+         (exterior_air[0].size() == static_cast<size_t>(size.y) &&
+          (size.y == 0 ||
+           exterior_air[0][0].size() == static_cast<size_t>(size.z)));
+}
+
+namespace {
+const std::array<sf::Vector3i, 6> face_steps{
+    sf::Vector3i(1, 0, 0),  sf::Vector3i(-1, 0, 0), sf::Vector3i(0, 1, 0),
+    sf::Vector3i(0, -1, 0), sf::Vector3i(0, 0, 1),  sf::Vector3i(0, 0, -1)};
+
+bool IsInside(const sf::Vector3i &size, const sf::Vector3i &cell) {
+  return cell.x >= 0 && cell.y >= 0 && cell.z >= 0 && cell.x < size.x &&
+         cell.y < size.y && cell.z < size.z;
+}
+
+/////////////////////////////////////////////////
+/// @brief Cells on the edge of the model border the space around it
+/////////////////////////////////////////////////
+bool IsOnEdge(const sf::Vector3i &size, const sf::Vector3i &cell) {
+  return cell.x == 0 || cell.y == 0 || cell.z == 0 || cell.x == size.x - 1 ||
+         cell.y == size.y - 1 || cell.z == size.z - 1;
+}
+} // namespace
+
+/////////////////////////////////////////////////
+void VoxManipulator::OpenExteriorAir(ModelData &model_data,
+                                     const sf::Vector3i &position) {
+  const sf::Vector3i &size = model_data.size;
+  auto &exterior_air = model_data.exterior_air;
+  bool touches_exterior = IsOnEdge(size, position);
+  for (const sf::Vector3i &step : face_steps) {
+    const sf::Vector3i next = position + step;
+    if (IsInside(size, next) && exterior_air[next.x][next.y][next.z])
+      touches_exterior = true;
+  }
+  if (!touches_exterior)
+    return; // opens onto a sealed cavity, which stays sealed
+
+  // everything reached through empty space joins the exterior
+  std::vector<sf::Vector3i> open_cells{position};
+  exterior_air[position.x][position.y][position.z] = true;
+  size_t opened = 1;
+  while (!open_cells.empty()) {
+    const sf::Vector3i cell = open_cells.back();
+    open_cells.pop_back();
+    for (const sf::Vector3i &step : face_steps) {
+      const sf::Vector3i next = cell + step;
+      if (!IsInside(size, next) || exterior_air[next.x][next.y][next.z] ||
+          model_data.voxel_data[next.x][next.y][next.z].is_visible)
+        continue;
+      exterior_air[next.x][next.y][next.z] = true;
+      MarkChunksDirty(model_data, next);
+      open_cells.push_back(next);
+      ++opened;
+    }
+  }
+  if (opened > 1)
+    std::cout << "[DEBUG] Clearing a voxel opened " << opened
+              << " cells to the outside" << std::endl;
+}
+
+/////////////////////////////////////////////////
+void VoxManipulator::SealExteriorAir(ModelData &model_data,
+                                     const sf::Vector3i &position) {
+  const sf::Vector3i &size = model_data.size;
+  auto &exterior_air = model_data.exterior_air;
+  if (!exterior_air[position.x][position.y][position.z])
+    return; // filled a sealed cavity, nothing led out through it
+  exterior_air[position.x][position.y][position.z] = false;
+
+  // one breadth first search per exterior neighbour, searches that meet
+  // are merged into one group
+  struct Search {
+    std::vector<sf::Vector3i> cells;
+    size_t next{0};
+  };
+  std::vector<Search> searches;
+  std::unordered_map<uint64_t, size_t> search_of_cell;
+  auto key = [&](const sf::Vector3i &cell) {
+    return (static_cast<uint64_t>(cell.x) * size.y + cell.y) * size.z + cell.z;
+  };
+  for (const sf::Vector3i &step : face_steps) {
+    const sf::Vector3i next = position + step;
+    if (!IsInside(size, next) || !exterior_air[next.x][next.y][next.z])
+      continue;
+    search_of_cell.emplace(key(next), searches.size());
+    searches.push_back({{next}, 0});
+  }
+  if (searches.empty())
+    return;
+
+  std::array<size_t, 6> parent{0, 1, 2, 3, 4, 5};
+  std::array<bool, 6> reaches_edge{};
+  auto group_of = [&](size_t search) {
+    while (parent[search] != search)
+      search = parent[search];
+    return search;
+  };
+  // a group is still open while one of its searches has cells left
+  auto is_open = [&](size_t group) {
+    for (size_t idx = 0; idx < searches.size(); ++idx) {
+      if (group_of(idx) == group &&
+          searches[idx].next < searches[idx].cells.size())
+        return true;
+    }
+    return false;
+  };
+
+  while (true) {
+    bool any_open = false;
+    for (size_t idx = 0; idx < searches.size(); ++idx) {
+      Search &search = searches[idx];
+      const size_t group = group_of(idx);
+      if (reaches_edge[group] || search.next == search.cells.size())
+        continue;
+      any_open = true;
+      const sf::Vector3i cell = search.cells[search.next++];
+      if (IsOnEdge(size, cell)) {
+        reaches_edge[group] = true;
+        continue;
+      }
+      for (const sf::Vector3i &step : face_steps) {
+        const sf::Vector3i next = cell + step;
+        if (!IsInside(size, next) || !exterior_air[next.x][next.y][next.z])
+          continue;
+        const auto [found, inserted] =
+            search_of_cell.try_emplace(key(next), idx);
+        if (inserted) {
+          search.cells.push_back(next);
+          continue;
+        }
+        const size_t other = group_of(found->second);
+        if (other != group) {
+          parent[other] = group;
+          reaches_edge[group] = reaches_edge[group] || reaches_edge[other];
+        }
+      }
+    }
+    if (!any_open)
+      break;
+
+    // the air around the voxel led out somewhere other than through it, so
+    // if every other group is sealed the last one must still lead out
+    if (IsOnEdge(size, position))
+      continue;
+    size_t open_groups = 0;
+    size_t last_open = 0;
+    bool any_exterior = false;
+    for (size_t idx = 0; idx < searches.size(); ++idx) {
+      if (group_of(idx) != idx)
+        continue;
+      any_exterior = any_exterior || reaches_edge[idx];
+      if (!reaches_edge[idx] && is_open(idx)) {
+        ++open_groups;
+        last_open = idx;
+      }
+    }
+    if (!any_exterior && open_groups == 1)
+      reaches_edge[last_open] = true;
+  }
+
+  size_t sealed = 0;
+  for (size_t idx = 0; idx < searches.size(); ++idx) {
+    if (reaches_edge[group_of(idx)])
+      continue;
+    for (const sf::Vector3i &cell : searches[idx].cells) {
+      exterior_air[cell.x][cell.y][cell.z] = false;
+      MarkChunksDirty(model_data, cell);
+      ++sealed;
+    }
+  }
+  if (sealed > 0)
+    std::cout << "[DEBUG] Setting a voxel sealed off " << sealed << " cells"
+              << std::endl;
+}
+
+/////////////////////////////////////////////////
+void VoxManipulator::HollowOut(ModelData &model_data, const Bounds &region) {
+  const Bounds clamped = ClampToOccupied(model_data, region);
+  const Occupancy &occupancy = model_data.occupancy;
+  // check all neighbors of each voxel and see if visisble or not. Empty
+  // voxels are never internal, so empty slices and rows can be skipped
+  for (int x = clamped.min.x; x < clamped.max.x; ++x) {
+    if (occupancy.slice_counts[0][x] == 0)
+      continue;
+    for (int y = clamped.min.y; y < clamped.max.y; ++y) {
+      if (occupancy.row_counts[0][x][y] == 0)
+        continue;
+      for (int z = clamped.min.z; z < clamped.max.z; ++z) {
         Voxel &voxel = model_data.voxel_data[x][y][z];
-        if (!voxel.is_visible)
+        if (!voxel.is_visible) {
+          voxel.is_internal_voxel = false;
           continue;
+        }
         // Check neighbors in all 6 directions
         size_t neighbors = 0;
         if (x > 0 && model_data.voxel_data[x - 1][y][z].is_visible)
@@ -53,24 +613,113 @@ void VoxManipulator::HollowOut(ModelData &model_data) {
           ++neighbors; // front
 
         // If it has all 6 neighbors, mark to be hollowed
-        if (neighbors == 6) {
-          voxel.is_internal_voxel = true;
-        }
+        voxel.is_internal_voxel = (neighbors == 6);
       }
     }
   }
+}
+
+/////////////////////////////////////////////////
+void VoxManipulator::MarkExteriorAir(const ModelView &view,
+                                     ModelData &target) {
+  const sf::Vector3i size = view.Size();
+  const Bounds &occupied = target.occupancy.bounds;
+  auto &exterior_air = target.exterior_air;
 
-  std::cout << "[DEBUG] Finished HollowOut()" << std::endl;
+  // everything outside the occupied bounds is exterior, so only the cells
+  // inside them need flooding
+  exterior_air.assign(size.x, std::vector<std::vector<bool>>(
+                                  size.y, std::vector<bool>(size.z, true)));
+  if (occupied.IsEmpty())
+    return;
+  for (int x = occupied.min.x; x < occupied.max.x; ++x) {
+    for (int y = occupied.min.y; y < occupied.max.y; ++y) {
+      std::fill(exterior_air[x][y].begin() + occupied.min.z,
+                exterior_air[x][y].begin() + occupied.max.z, false);
+    }
+  }
+
+  // cells waiting to have their neighbours visited
+  std::vector<sf::Vector3i> open_cells;
+  auto visit = [&](int x, int y, int z) {
+    if (!occupied.Contains(x, y, z))
+      return;
+    if (exterior_air[x][y][z] || view.At(x, y, z).is_visible)
+      return;
+    exterior_air[x][y][z] = true;
+    open_cells.emplace_back(x, y, z);
+  };
+
+  // seed with every cell on the faces of the occupied bounds, any path in
+  // from outside has to cross one of them
+  const sf::Vector3i &lower = occupied.min;
+  const sf::Vector3i upper = occupied.max - sf::Vector3i(1, 1, 1);
+  for (int x = lower.x; x <= upper.x; ++x) {
+    for (int y = lower.y; y <= upper.y; ++y) {
+      visit(x, y, lower.z);
+      visit(x, y, upper.z);
+    }
+    for (int z = lower.z; z <= upper.z; ++z) {
+      visit(x, lower.y, z);
+      visit(x, upper.y, z);
+    }
+  }
+  for (int y = lower.y; y <= upper.y; ++y) {
+    for (int z = lower.z; z <= upper.z; ++z) {
+      visit(lower.x, y, z);
+      visit(upper.x, y, z);
+    }
+  }
+
+  while (!open_cells.empty()) {
+    const sf::Vector3i cell = open_cells.back();
+    open_cells.pop_back();
+    visit(cell.x - 1, cell.y, cell.z);
+    visit(cell.x + 1, cell.y, cell.z);
+    visit(cell.x, cell.y - 1, cell.z);
+    visit(cell.x, cell.y + 1, cell.z);
+    visit(cell.x, cell.y, cell.z - 1);
+    visit(cell.x, cell.y, cell.z + 1);
+  }
+}
+
+/////////////////////////////////////////////////
+void VoxManipulator::RecordOccupancy(const ModelView &view,
+                                     ModelData &target) {
+  const sf::Vector3i size = view.Size();
+  target.occupancy.Reset(size);
+  for (int x = 0; x < size.x; ++x) {
+    for (int y = 0; y < size.y; ++y) {
+      for (int z = 0; z < size.z; ++z) {
+        if (view.At(x, y, z).is_visible)
+          target.occupancy.Add(x, y, z);
+      }
+    }
+  }
 }
 
 /////////////////////////////////////////////////
-void VoxManipulator::CreateMasks(ModelData &model_data) {
-  std::cout << "[DEBUG] Starting CreateMasks()" << std::endl;
-  auto &voxel_data = model_data.voxel_data;
+Bounds VoxManipulator::ClampToOccupied(const ModelData &model_data,
+                                       const Bounds &region) const {
+  const Bounds &occupied = model_data.occupancy.bounds;
+  Bounds clamped{{std::max(region.min.x, occupied.min.x),
+                  std::max(region.min.y, occupied.min.y),
+                  std::max(region.min.z, occupied.min.z)},
+                 {std::min(region.max.x, occupied.max.x),
+                  std::min(region.max.y, occupied.max.y),
+                  std::min(region.max.z, occupied.max.z)}};
+  // loops run from min to max, an empty box must not run at all
+  if (clamped.IsEmpty())
+    return Bounds{};
+  return clamped;
+}
 
+/////////////////////////////////////////////////
+void VoxManipulator::ResizeMasks(ModelData &model_data) {
   for (auto &mask : model_data.masks) {
 
-    // Resize mask.data before accessing it
+    // Resize mask.data before accessing it, clearing every cell as
+    // CreateMasks skips empty rows and would leave stale faces in them
     switch (mask.direction) {
     case Direction::X_POSITIVE:
     case Direction::X_NEGATIVE: {
@@ -79,7 +728,7 @@ void VoxManipulator::CreateMasks(ModelData &model_data) {
       for (size_t x = 0; x < model_data.size.x; ++x) {
         mask.data[x].resize(model_data.size.y);
         for (size_t y = 0; y < model_data.size.y; ++y)
-          mask.data[x][y].resize(model_data.size.z);
+          mask.data[x][y].assign(model_data.size.z, std::nullopt);
       }
       break;
     }
@@ -90,7 +739,7 @@ void VoxManipulator::CreateMasks(ModelData &model_data) {
       for (size_t y = 0; y < model_data.size.y; ++y) {
         mask.data[y].resize(model_data.size.z);
         for (size_t z = 0; z < model_data.size.z; ++z)
-          mask.data[y][z].resize(model_data.size.x);
+          mask.data[y][z].assign(model_data.size.x, std::nullopt);
       }
       break;
     }
@@ -101,7 +750,7 @@ void VoxManipulator::CreateMasks(ModelData &model_data) {
       for (size_t z = 0; z < model_data.size.z; ++z) {
         mask.data[z].resize(model_data.size.x);
         for (size_t x = 0; x < model_data.size.x; ++x)
-          mask.data[z][x].resize(model_data.size.y);
+          mask.data[z][x].assign(model_data.size.y, std::nullopt);
       }
       break;
     }
@@ -113,18 +762,36 @@ void VoxManipulator::CreateMasks(ModelData &model_data) {
 
     std::cout << "[DEBUG] Mask data resized for direction "
               << static_cast<int>(mask.direction) << std::endl;
+  }
+}
+
+/////////////////////////////////////////////////
+void VoxManipulator::CreateMasks(const ModelView &view, ModelData &target,
+                                 const Bounds &region) {
+  const sf::Vector3i size = view.Size();
+  // cells of empty voxels are already std::nullopt (ResizeMasks and ClearVoxel
+  // see to that), so only rows holding a visible voxel need evaluating
+  const Bounds clamped = ClampToOccupied(target, region);
+  const Occupancy &occupancy = target.occupancy;
+
+  for (auto &mask : target.masks) {
     switch (mask.direction) {
     case Direction::X_POSITIVE: {
       // X_POSITIVE: we look at each x slice and evaluate y,z
-      for (size_t x = 0; x < model_data.size.x; ++x) {
-        for (size_t y = 0; y < model_data.size.y; ++y) {
-          for (size_t z = 0; z < model_data.size.z; ++z) {
-            if (voxel_data[x][y][z].is_visible) {
-              // if at end of model or next voxel is visible (then it is masked)
-              if (x == model_data.size.x - 1 ||
-                  !voxel_data[x + 1][y][z].is_visible) {
-
-                mask.data[x][y][z] = voxel_data[x][y][z].color;
+      for (int x = clamped.min.x; x < clamped.max.x; ++x) {
+        if (occupancy.slice_counts[0][x] == 0)
+          continue;
+        for (int y = clamped.min.y; y < clamped.max.y; ++y) {
+          if (occupancy.row_counts[0][x][y] == 0)
+            continue;
+          for (int z = clamped.min.z; z < clamped.max.z; ++z) {
+            if (view.At(x, y, z).is_visible) {
+              // if at end of model or next cell is exterior air (a visible or
+              // sealed neighbour masks the face)
+              if (x == size.x - 1 ||
+                  target.exterior_air[x + 1][y][z]) {
+
+                mask.data[x][y][z] = view.At(x, y, z).color;
               } else {
                 mask.data[x][y][z] = std::nullopt;
               }
@@ -139,12 +806,16 @@ void VoxManipulator::CreateMasks(ModelData &model_data) {
     case Direction::X_NEGATIVE: {
       // start from the other end of the model
       // X_NEGATIVE: we look at each x slice and evaluate y,z
-      for (int x = model_data.size.x - 1; x >= 0; --x) {
-        for (size_t y = 0; y < model_data.size.y; ++y) {
-          for (size_t z = 0; z < model_data.size.z; ++z) {
-            if (voxel_data[x][y][z].is_visible) {
-              if (x == 0 || !voxel_data[x - 1][y][z].is_visible) {
-                mask.data[x][y][z] = voxel_data[x][y][z].color;
+      for (int x = clamped.max.x - 1; x >= clamped.min.x; --x) {
+        if (occupancy.slice_counts[0][x] == 0)
+          continue;
+        for (int y = clamped.min.y; y < clamped.max.y; ++y) {
+          if (occupancy.row_counts[0][x][y] == 0)
+            continue;
+          for (int z = clamped.min.z; z < clamped.max.z; ++z) {
+            if (view.At(x, y, z).is_visible) {
+              if (x == 0 || target.exterior_air[x - 1][y][z]) {
+                mask.data[x][y][z] = view.At(x, y, z).color;
 
               } else {
                 mask.data[x][y][z] = std::nullopt;
@@ -159,13 +830,17 @@ void VoxManipulator::CreateMasks(ModelData &model_data) {
     }
     case Direction::Y_POSITIVE: {
       // Y_POSITIVE: we look at each y slice and evaluate x,z
-      for (size_t y = 0; y < model_data.size.y; ++y) {
-        for (size_t x = 0; x < model_data.size.x; ++x) {
-          for (size_t z = 0; z < model_data.size.z; ++z) {
-            if (voxel_data[x][y][z].is_visible) {
-              if (y == model_data.size.y - 1 ||
-                  !voxel_data[x][y + 1][z].is_visible) {
-                mask.data[y][z][x] = voxel_data[x][y][z].color;
+      for (int y = clamped.min.y; y < clamped.max.y; ++y) {
+        if (occupancy.slice_counts[1][y] == 0)
+          continue;
+        for (int z = clamped.min.z; z < clamped.max.z; ++z) {
+          if (occupancy.row_counts[1][y][z] == 0)
+            continue;
+          for (int x = clamped.min.x; x < clamped.max.x; ++x) {
+            if (view.At(x, y, z).is_visible) {
+              if (y == size.y - 1 ||
+                  target.exterior_air[x][y + 1][z]) {
+                mask.data[y][z][x] = view.At(x, y, z).color;
               } else {
                 mask.data[y][z][x] = std::nullopt;
               }
@@ -179,12 +854,16 @@ void VoxManipulator::CreateMasks(ModelData &model_data) {
     }
     case Direction::Y_NEGATIVE: {
       // Y_NEGATIVE: we look at each y slice and evaluate x,z
-      for (int y = model_data.size.y - 1; y >= 0; --y) {
-        for (size_t x = 0; x < model_data.size.x; ++x) {
-          for (size_t z = 0; z < model_data.size.z; ++z) {
-            if (voxel_data[x][y][z].is_visible) {
-              if (y == 0 || !voxel_data[x][y - 1][z].is_visible) {
-                mask.data[y][z][x] = voxel_data[x][y][z].color;
+      for (int y = clamped.max.y - 1; y >= clamped.min.y; --y) {
+        if (occupancy.slice_counts[1][y] == 0)
+          continue;
+        for (int z = clamped.min.z; z < clamped.max.z; ++z) {
+          if (occupancy.row_counts[1][y][z] == 0)
+            continue;
+          for (int x = clamped.min.x; x < clamped.max.x; ++x) {
+            if (view.At(x, y, z).is_visible) {
+              if (y == 0 || target.exterior_air[x][y - 1][z]) {
+                mask.data[y][z][x] = view.At(x, y, z).color;
               } else {
                 mask.data[y][z][x] = std::nullopt;
               }
@@ -198,13 +877,17 @@ void VoxManipulator::CreateMasks(ModelData &model_data) {
     }
     case Direction::Z_POSITIVE: {
       // Z_POSITIVE: we look at each z slice and evaluate x,y
-      for (size_t z = 0; z < model_data.size.z; ++z) {
-        for (size_t x = 0; x < model_data.size.x; ++x) {
-          for (size_t y = 0; y < model_data.size.y; ++y) {
-            if (voxel_data[x][y][z].is_visible) {
-              if (z == model_data.size.z - 1 ||
-                  !voxel_data[x][y][z + 1].is_visible) {
-                mask.data[z][x][y] = voxel_data[x][y][z].color;
+      for (int z = clamped.min.z; z < clamped.max.z; ++z) {
+        if (occupancy.slice_counts[2][z] == 0)
+          continue;
+        for (int x = clamped.min.x; x < clamped.max.x; ++x) {
+          if (occupancy.row_counts[2][z][x] == 0)
+            continue;
+          for (int y = clamped.min.y; y < clamped.max.y; ++y) {
+            if (view.At(x, y, z).is_visible) {
+              if (z == size.z - 1 ||
+                  target.exterior_air[x][y][z + 1]) {
+                mask.data[z][x][y] = view.At(x, y, z).color;
               } else {
                 mask.data[z][x][y] = std::nullopt;
               }
@@ -218,12 +901,16 @@ void VoxManipulator::CreateMasks(ModelData &model_data) {
     }
     case Direction::Z_NEGATIVE: {
       // Z_NEGATIVE: we look at each z slice and evaluate x,y
-      for (int z = model_data.size.z - 1; z >= 0; --z) {
-        for (size_t x = 0; x < model_data.size.x; ++x) {
-          for (size_t y = 0; y < model_data.size.y; ++y) {
-            if (voxel_data[x][y][z].is_visible) {
-              if (z == 0 || !voxel_data[x][y][z - 1].is_visible) {
-                mask.data[z][x][y] = voxel_data[x][y][z].color;
+      for (int z = clamped.max.z - 1; z >= clamped.min.z; --z) {
+        if (occupancy.slice_counts[2][z] == 0)
+          continue;
+        for (int x = clamped.min.x; x < clamped.max.x; ++x) {
+          if (occupancy.row_counts[2][z][x] == 0)
+            continue;
+          for (int y = clamped.min.y; y < clamped.max.y; ++y) {
+            if (view.At(x, y, z).is_visible) {
+              if (z == 0 || target.exterior_air[x][y][z - 1]) {
+                mask.data[z][x][y] = view.At(x, y, z).color;
               } else {
                 mask.data[z][x][y] = std::nullopt;
               }
@@ -241,24 +928,26 @@ void VoxManipulator::CreateMasks(ModelData &model_data) {
       break;
     }
   }
-  std::cout << "[DEBUG] Finished CreateMasks()" << std::endl;
 }
 
 /////////////////////////////////////////////////
-void VoxManipulator::CreateTrianglesFromMask(ModelData &model_data) {
-  std::cout << "[DEBUG] Starting CreateTrianglesFromMask()" << std::endl;
-  model_data.triangles.clear();
-
+void VoxManipulator::CreateTrianglesFromMask(const ModelData &model_data,
+                                             const Bounds &region,
+                                             std::vector<Triangle> &triangles) {
+  // a mask cell can only be set where there is a visible voxel
+  const Bounds clamped = ClampToOccupied(model_data, region);
+  const Occupancy &occupancy = model_data.occupancy;
   for (const auto &mask : model_data.masks) {
-    std::cout << "[DEBUG] Processing mask for direction "
-              << static_cast<int>(mask.direction) << std::endl;
-
     switch (mask.direction) {
     case Direction::X_POSITIVE: {
       // mask[x][y][z], face at (x+1, y, z), varying y, z
-      for (size_t x = 0; x < mask.data.size(); ++x) {
-        for (size_t y = 0; y < mask.data[x].size(); ++y) {
-          for (size_t z = 0; z < mask.data[x][y].size(); ++z) {
+      for (int x = clamped.min.x; x < clamped.max.x; ++x) {
+        if (occupancy.slice_counts[0][x] == 0)
+          continue;
+        for (int y = clamped.min.y; y < clamped.max.y; ++y) {
+          if (occupancy.row_counts[0][x][y] == 0)
+            continue;
+          for (int z = clamped.min.z; z < clamped.max.z; ++z) {
             if (mask.data[x][y][z].has_value()) {
               sf::Color color = mask.data[x][y][z].value();
               float xf = static_cast<float>(x + 1);
@@ -270,8 +959,8 @@ void VoxManipulator::CreateTrianglesFromMask(ModelData &model_data) {
               Triangle t2(glm::vec3(xf, yf + 1, zf),
                           glm::vec3(xf, yf + 1, zf + 1),
                           glm::vec3(xf, yf, zf + 1), color, mask.direction);
-              model_data.triangles.emplace_back(t1);
-              model_data.triangles.emplace_back(t2);
+              triangles.emplace_back(t1);
+              triangles.emplace_back(t2);
             }
           }
         }
@@ -280,9 +969,13 @@ void VoxManipulator::CreateTrianglesFromMask(ModelData &model_data) {
     }
     case Direction::X_NEGATIVE: {
       // mask[x][y][z], face at (x, y, z), varying y, z
-      for (size_t x = 0; x < mask.data.size(); ++x) {
-        for (size_t y = 0; y < mask.data[x].size(); ++y) {
-          for (size_t z = 0; z < mask.data[x][y].size(); ++z) {
+      for (int x = clamped.min.x; x < clamped.max.x; ++x) {
+        if (occupancy.slice_counts[0][x] == 0)
+          continue;
+        for (int y = clamped.min.y; y < clamped.max.y; ++y) {
+          if (occupancy.row_counts[0][x][y] == 0)
+            continue;
+          for (int z = clamped.min.z; z < clamped.max.z; ++z) {
             if (mask.data[x][y][z].has_value()) {
               sf::Color color = mask.data[x][y][z].value();
               float xf = static_cast<float>(x);
@@ -293,8 +986,8 @@ void VoxManipulator::CreateTrianglesFromMask(ModelData &model_data) {
                           glm::vec3(xf, yf + 1, zf), color, mask.direction);
               Triangle t2(glm::vec3(xf, yf + 1, zf), glm::vec3(xf, yf, zf + 1),
                           glm::vec3(xf, yf + 1, zf + 1), color, mask.direction);
-              model_data.triangles.emplace_back(t1);
-              model_data.triangles.emplace_back(t2);
+              triangles.emplace_back(t1);
+              triangles.emplace_back(t2);
             }
           }
         }
@@ -303,9 +996,13 @@ void VoxManipulator::CreateTrianglesFromMask(ModelData &model_data) {
     }
     case Direction::Y_POSITIVE: {
       // mask[y][z][x], face at (x, y+1, z), varying x, z
-      for (size_t y = 0; y < mask.data.size(); ++y) {
-        for (size_t z = 0; z < mask.data[y].size(); ++z) {
-          for (size_t x = 0; x < mask.data[y][z].size(); ++x) {
+      for (int y = clamped.min.y; y < clamped.max.y; ++y) {
+        if (occupancy.slice_counts[1][y] == 0)
+          continue;
+        for (int z = clamped.min.z; z < clamped.max.z; ++z) {
+          if (occupancy.row_counts[1][y][z] == 0)
+            continue;
+          for (int x = clamped.min.x; x < clamped.max.x; ++x) {
             if (mask.data[y][z][x].has_value()) {
               sf::Color color = mask.data[y][z][x].value();
               float xf = static_cast<float>(x);
@@ -317,8 +1014,8 @@ void VoxManipulator::CreateTrianglesFromMask(ModelData &model_data) {
               Triangle t2(glm::vec3(xf + 1, yf, zf),
                           glm::vec3(xf + 1, yf, zf + 1),
                           glm::vec3(xf, yf, zf + 1), color, mask.direction);
-              model_data.triangles.emplace_back(t1);
-              model_data.triangles.emplace_back(t2);
+              triangles.emplace_back(t1);
+              triangles.emplace_back(t2);
             }
           }
         }
@@ -327,9 +1024,13 @@ void VoxManipulator::CreateTrianglesFromMask(ModelData &model_data) {
     }
     case Direction::Y_NEGATIVE: {
       // mask[y][z][x], face at (x, y, z), varying x, z
-      for (size_t y = 0; y < mask.data.size(); ++y) {
-        for (size_t z = 0; z < mask.data[y].size(); ++z) {
-          for (size_t x = 0; x < mask.data[y][z].size(); ++x) {
+      for (int y = clamped.min.y; y < clamped.max.y; ++y) {
+        if (occupancy.slice_counts[1][y] == 0)
+          continue;
+        for (int z = clamped.min.z; z < clamped.max.z; ++z) {
+          if (occupancy.row_counts[1][y][z] == 0)
+            continue;
+          for (int x = clamped.min.x; x < clamped.max.x; ++x) {
             if (mask.data[y][z][x].has_value()) {
               sf::Color color = mask.data[y][z][x].value();
               float xf = static_cast<float>(x);
@@ -340,8 +1041,8 @@ void VoxManipulator::CreateTrianglesFromMask(ModelData &model_data) {
                           glm::vec3(xf + 1, yf, zf), color, mask.direction);
               Triangle t2(glm::vec3(xf + 1, yf, zf), glm::vec3(xf, yf, zf + 1),
                           glm::vec3(xf + 1, yf, zf + 1), color, mask.direction);
-              model_data.triangles.emplace_back(t1);
-              model_data.triangles.emplace_back(t2);
+              triangles.emplace_back(t1);
+              triangles.emplace_back(t2);
             }
           }
         }
@@ -350,9 +1051,13 @@ void VoxManipulator::CreateTrianglesFromMask(ModelData &model_data) {
     }
     case Direction::Z_POSITIVE: {
       // mask[z][x][y], face at (x, y, z+1), varying x, y
-      for (size_t z = 0; z < mask.data.size(); ++z) {
-        for (size_t x = 0; x < mask.data[z].size(); ++x) {
-          for (size_t y = 0; y < mask.data[z][x].size(); ++y) {
+      for (int z = clamped.min.z; z < clamped.max.z; ++z) {
+        if (occupancy.slice_counts[2][z] == 0)
+          continue;
+        for (int x = clamped.min.x; x < clamped.max.x; ++x) {
+          if (occupancy.row_counts[2][z][x] == 0)
+            continue;
+          for (int y = clamped.min.y; y < clamped.max.y; ++y) {
             if (mask.data[z][x][y].has_value()) {
               sf::Color color = mask.data[z][x][y].value();
               float xf = static_cast<float>(x);
@@ -364,8 +1069,8 @@ void VoxManipulator::CreateTrianglesFromMask(ModelData &model_data) {
               Triangle t2(glm::vec3(xf + 1, yf, zf),
                           glm::vec3(xf + 1, yf + 1, zf),
                           glm::vec3(xf, yf + 1, zf), color, mask.direction);
-              model_data.triangles.emplace_back(t1);
-              model_data.triangles.emplace_back(t2);
+              triangles.emplace_back(t1);
+              triangles.emplace_back(t2);
             }
           }
         }
@@ -374,9 +1079,13 @@ void VoxManipulator::CreateTrianglesFromMask(ModelData &model_data) {
     }
     case Direction::Z_NEGATIVE: {
       // mask[z][x][y], face at (x, y, z), varying x, y
-      for (size_t z = 0; z < mask.data.size(); ++z) {
-        for (size_t x = 0; x < mask.data[z].size(); ++x) {
-          for (size_t y = 0; y < mask.data[z][x].size(); ++y) {
+      for (int z = clamped.min.z; z < clamped.max.z; ++z) {
+        if (occupancy.slice_counts[2][z] == 0)
+          continue;
+        for (int x = clamped.min.x; x < clamped.max.x; ++x) {
+          if (occupancy.row_counts[2][z][x] == 0)
+            continue;
+          for (int y = clamped.min.y; y < clamped.max.y; ++y) {
             if (mask.data[z][x][y].has_value()) {
               sf::Color color = mask.data[z][x][y].value();
               float xf = static_cast<float>(x);
@@ -387,8 +1096,8 @@ void VoxManipulator::CreateTrianglesFromMask(ModelData &model_data) {
                           glm::vec3(xf + 1, yf, zf), color, mask.direction);
               Triangle t2(glm::vec3(xf + 1, yf, zf), glm::vec3(xf, yf + 1, zf),
                           glm::vec3(xf + 1, yf + 1, zf), color, mask.direction);
-              model_data.triangles.emplace_back(t1);
-              model_data.triangles.emplace_back(t2);
+              triangles.emplace_back(t1);
+              triangles.emplace_back(t2);
             }
           }
         }
@@ -401,119 +1110,527 @@ void VoxManipulator::CreateTrianglesFromMask(ModelData &model_data) {
       break;
     }
   }
-  std::cout << "[DEBUG] Finished CreateTrianglesFromMask()" << std::endl;
 }
+namespace {
+/////////////////////////////////////////////////
+/// @brief Rectangle of mask cells under one greedy quad
+///
+/// Rows and columns follow the mask layout, e.g. mask.data[x][y][z] has rows
+/// along y and columns along z
 /////////////////////////////////////////////////
-void VoxManipulator::GreedyMeshing(ModelData &model_data) {
-  std::cout << "[DEBUG] Starting GreedyMeshing()" << std::endl;
-  model_data.triangles.clear(); // Clear previous results
+struct AtlasTile {
+  size_t first_triangle;
+  size_t mask_index;
+  int slice, row, col, rows, cols;
+  int row_axis, col_axis;
+  sf::Vector2u position{0, 0};
+};
 
-  size_t mask_index = 0;
-  for (const auto &mask : model_data.masks) {
-    // convenience variable for number of slices in the mask
-    size_t slice = mask.data.size();
-    if (slice == 0) {
-      std::cout << "[DEBUG] Mask #" << mask_index << " has no slices, skipping."
+/////////////////////////////////////////////////
+/// @brief Tiles under the quads of a range of triangles
+/////////////////////////////////////////////////
+std::vector<AtlasTile> CollectTiles(const std::vector<Triangle> &triangles,
+                                    size_t first, size_t count) {
+  std::vector<AtlasTile> tiles;
+  tiles.reserve(count / 2);
+  for (size_t idx = first; idx + 1 < first + count; idx += 2) {
+    glm::vec3 lower = triangles[idx].vertices[0];
+    glm::vec3 upper = triangles[idx].vertices[0];
+    for (size_t tri = idx; tri < idx + 2; ++tri) {
+      for (const auto &vertex : triangles[tri].vertices) {
+        lower = glm::min(lower, vertex);
+        upper = glm::max(upper, vertex);
+      }
+    }
+
+    AtlasTile tile{};
+    tile.first_triangle = idx;
+    // masks are stored X+, X-, Y+, Y-, Z+, Z- to match the Direction enum
+    tile.mask_index = static_cast<size_t>(triangles[idx].direction) - 1;
+    int plane_axis = 0;
+    switch (triangles[idx].direction) {
+    case Direction::X_POSITIVE:
+    case Direction::X_NEGATIVE:
+      plane_axis = 0;
+      tile.row_axis = 1;
+      tile.col_axis = 2;
+      break;
+    case Direction::Y_POSITIVE:
+    case Direction::Y_NEGATIVE:
+      plane_axis = 1;
+      tile.row_axis = 2;
+      tile.col_axis = 0;
+      break;
+    case Direction::Z_POSITIVE:
+    case Direction::Z_NEGATIVE:
+      plane_axis = 2;
+      tile.row_axis = 0;
+      tile.col_axis = 1;
+      break;
+    default:
+      std::cout << "[DEBUG] Triangle without a direction in BuildColorAtlas"
                 << std::endl;
-      ++mask_index;
       continue;
     }
-    // Determine mask size (rows, cols)
-    size_t rows = mask.data[0].size();
-    if (rows == 0) {
-      std::cout << "[DEBUG] Mask #" << mask_index << " has 0 rows, skipping."
-                << std::endl;
-      ++mask_index;
+    // positive faces sit on the far side of their voxel
+    const bool positive = triangles[idx].direction == Direction::X_POSITIVE ||
+                          triangles[idx].direction == Direction::Y_POSITIVE ||
+                          triangles[idx].direction == Direction::Z_POSITIVE;
+    tile.slice = static_cast<int>(lower[plane_axis]) - (positive ? 1 : 0);
+    tile.row = static_cast<int>(lower[tile.row_axis]);
+    tile.col = static_cast<int>(lower[tile.col_axis]);
+    tile.rows = static_cast<int>(upper[tile.row_axis]) - tile.row;
+    tile.cols = static_cast<int>(upper[tile.col_axis]) - tile.col;
+    tiles.push_back(tile);
+  }
+  return tiles;
+}
+
+/////////////////////////////////////////////////
+/// @brief Order tiles tallest first, which keeps shelves and splits of free
+/// space from wasting height
+/////////////////////////////////////////////////
+std::vector<size_t> TallestFirst(const std::vector<AtlasTile> &tiles) {
+  std::vector<size_t> order(tiles.size());
+  for (size_t idx = 0; idx < tiles.size(); ++idx)
+    order[idx] = idx;
+  std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+    return tiles[lhs].rows > tiles[rhs].rows;
+  });
+  return order;
+}
+
+/////////////////////////////////////////////////
+/// @brief Copy a placed tile's colours into the atlas and map its quad onto
+/// it
+/////////////////////////////////////////////////
+void WriteTile(ModelData &model_data, const AtlasTile &tile) {
+  ColorAtlas &atlas = model_data.color_atlas;
+  // copy the mask colours into the tile, u along columns and v along rows
+  const Mask &mask = model_data.masks[tile.mask_index];
+  for (int v = 0; v < tile.rows; ++v) {
+    for (int u = 0; u < tile.cols; ++u) {
+      const auto &cell = mask.data[tile.slice][tile.row + v][tile.col + u];
+      atlas.pixels[(tile.position.y + v) * atlas.size.x + tile.position.x +
+                   u] = cell.value_or(sf::Color::Transparent);
+    }
+  }
+  // map each corner of the quad onto the same corner of its tile
+  for (size_t tri = tile.first_triangle; tri < tile.first_triangle + 2;
+       ++tri) {
+    Triangle &triangle = model_data.triangles[tri];
+    for (size_t vert = 0; vert < triangle.vertices.size(); ++vert) {
+      const glm::vec3 &vertex = triangle.vertices[vert];
+      triangle.tex_coords[vert] = glm::vec2(
+          static_cast<float>(tile.position.x) + vertex[tile.col_axis] -
+              static_cast<float>(tile.col),
+          static_cast<float>(tile.position.y) + vertex[tile.row_axis] -
+              static_cast<float>(tile.row));
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+/// @brief Put a tile in the smallest free space that holds it
+///
+/// The space is split into what is left right of the tile and below it.
+///
+/// @return False if no space is big enough
+/////////////////////////////////////////////////
+bool PlaceTile(std::vector<AtlasSpace> &free_space, AtlasTile &tile) {
+  const unsigned cols = static_cast<unsigned>(tile.cols);
+  const unsigned rows = static_cast<unsigned>(tile.rows);
+  size_t best = free_space.size();
+  for (size_t idx = 0; idx < free_space.size(); ++idx) {
+    const sf::Vector2u &size = free_space[idx].size;
+    if (size.x < cols || size.y < rows)
+      continue;
+    if (best == free_space.size() ||
+        size.x * size.y < free_space[best].size.x * free_space[best].size.y)
+      best = idx;
+  }
+  if (best == free_space.size())
+    return false;
+
+  const AtlasSpace space = free_space[best];
+  free_space[best] = free_space.back();
+  free_space.pop_back();
+  tile.position = space.position;
+  if (space.size.x > cols) {
+    free_space.push_back({{space.position.x + cols, space.position.y},
+                          {space.size.x - cols, rows}});
+  }
+  if (space.size.y > rows) {
+    free_space.push_back({{space.position.x, space.position.y + rows},
+                          {space.size.x, space.size.y - rows}});
+  }
+  return true;
+}
+} // namespace
+
+/////////////////////////////////////////////////
+void VoxManipulator::BuildColorAtlas(ModelData &model_data) {
+  std::cout << "[DEBUG] Starting BuildColorAtlas()" << std::endl;
+  std::vector<AtlasTile> tiles =
+      CollectTiles(model_data.triangles, 0, model_data.triangles.size());
+
+  // shelf packing, tallest tiles first so each shelf wastes little height
+  const std::vector<size_t> order = TallestFirst(tiles);
+  unsigned total_area = 0;
+  unsigned widest = 0;
+  for (const AtlasTile &tile : tiles) {
+    total_area += static_cast<unsigned>(tile.rows * tile.cols);
+    widest = std::max(widest, static_cast<unsigned>(tile.cols));
+  }
+  const unsigned atlas_width = std::max(
+      widest, static_cast<unsigned>(std::ceil(std::sqrt(total_area))));
+
+  // whatever the tiles leave of each shelf is kept for later remeshes
+  std::vector<AtlasSpace> free_space;
+  auto keep_free = [&](sf::Vector2u position, sf::Vector2u size) {
+    if (size.x > 0 && size.y > 0)
+      free_space.push_back({position, size});
+  };
+  sf::Vector2u cursor{0, 0};
+  unsigned shelf_height = 0;
+  for (size_t idx : order) {
+    AtlasTile &tile = tiles[idx];
+    if (cursor.x + tile.cols > atlas_width) {
+      keep_free(cursor, {atlas_width - cursor.x, shelf_height});
+      cursor = {0, cursor.y + shelf_height};
+      shelf_height = 0;
+    }
+    tile.position = cursor;
+    // the first tile on a shelf is the tallest
+    shelf_height = std::max(shelf_height, static_cast<unsigned>(tile.rows));
+    keep_free({cursor.x, cursor.y + tile.rows},
+              {static_cast<unsigned>(tile.cols), shelf_height - tile.rows});
+    cursor.x += tile.cols;
+  }
+  keep_free(cursor, {atlas_width - cursor.x, shelf_height});
+
+  ColorAtlas &atlas = model_data.color_atlas;
+  atlas.size = {tiles.empty() ? 0 : atlas_width, cursor.y + shelf_height};
+  atlas.pixels.assign(static_cast<size_t>(atlas.size.x) * atlas.size.y,
+                      sf::Color::Transparent);
+  atlas.free_space = std::move(free_space);
+  for (const AtlasTile &tile : tiles)
+    WriteTile(model_data, tile);
+  std::cout << "[DEBUG] Packed " << tiles.size() << " tiles into a "
+            << atlas.size.x << "x" << atlas.size.y << " colour atlas"
+            << std::endl;
+}
+
+/////////////////////////////////////////////////
+void VoxManipulator::FreeAtlasTiles(ModelData &model_data,
+                                    const Chunk &chunk) {
+  ColorAtlas &atlas = model_data.color_atlas;
+  const auto &triangles = model_data.triangles;
+  for (size_t idx = chunk.triangle_offset;
+       idx + 1 < chunk.triangle_offset + chunk.triangle_count; idx += 2) {
+    // a quad's tex_coords reach the corners of its tile
+    glm::vec2 lower = triangles[idx].tex_coords[0];
+    glm::vec2 upper = triangles[idx].tex_coords[0];
+    for (size_t tri = idx; tri < idx + 2; ++tri) {
+      for (const auto &tex_coord : triangles[tri].tex_coords) {
+        lower = glm::min(lower, tex_coord);
+        upper = glm::max(upper, tex_coord);
+      }
+    }
+    const AtlasSpace space{
+        {static_cast<unsigned>(lower.x), static_cast<unsigned>(lower.y)},
+        {static_cast<unsigned>(upper.x - lower.x),
+         static_cast<unsigned>(upper.y - lower.y)}};
+    if (space.size.x == 0 || space.size.y == 0)
+      continue;
+    for (unsigned v = 0; v < space.size.y; ++v) {
+      auto row = atlas.pixels.begin() +
+                 (space.position.y + v) * atlas.size.x + space.position.x;
+      std::fill(row, row + space.size.x, sf::Color::Transparent);
+    }
+    atlas.free_space.push_back(space);
+  }
+}
+
+/////////////////////////////////////////////////
+bool VoxManipulator::PackAtlasTiles(ModelData &model_data,
+                                    const std::vector<size_t> &chunk_indices) {
+  ColorAtlas &atlas = model_data.color_atlas;
+  std::vector<AtlasTile> tiles;
+  for (size_t chunk_idx : chunk_indices) {
+    const Chunk &chunk = model_data.chunks[chunk_idx];
+    std::vector<AtlasTile> chunk_tiles = CollectTiles(
+        model_data.triangles, chunk.triangle_offset, chunk.triangle_count);
+    tiles.insert(tiles.end(), chunk_tiles.begin(), chunk_tiles.end());
+  }
+
+  for (size_t idx : TallestFirst(tiles)) {
+    AtlasTile &tile = tiles[idx];
+    if (static_cast<unsigned>(tile.cols) > atlas.size.x) {
+      std::cout << "[DEBUG] A " << tile.cols << " texel wide tile does not fit "
+                << "the " << atlas.size.x << " texel wide atlas" << std::endl;
+      return false;
+    }
+    if (!PlaceTile(atlas.free_space, tile)) {
+      // a new shelf at the bottom, rows are added after every texel in use
+      const unsigned rows = static_cast<unsigned>(tile.rows);
+      atlas.free_space.push_back({{0, atlas.size.y}, {atlas.size.x, rows}});
+      atlas.size.y += rows;
+      atlas.pixels.resize(static_cast<size_t>(atlas.size.x) * atlas.size.y,
+                          sf::Color::Transparent);
+      PlaceTile(atlas.free_space, tile);
+    }
+    WriteTile(model_data, tile);
+  }
+
+  size_t free_area = 0;
+  for (const AtlasSpace &space : atlas.free_space)
+    free_area += static_cast<size_t>(space.size.x) * space.size.y;
+  if (free_area * 2 > atlas.pixels.size()) {
+    std::cout << "[DEBUG] " << free_area << " of " << atlas.pixels.size()
+              << " atlas texels are free, packing it again" << std::endl;
+    return false;
+  }
+  std::cout << "[DEBUG] Packed " << tiles.size() << " remeshed tiles into a "
+            << atlas.size.x << "x" << atlas.size.y << " colour atlas"
+            << std::endl;
+  return true;
+}
+
+/////////////////////////////////////////////////
+float VoxManipulator::ColorDistance(const sf::Color &lhs,
+                                    const sf::Color &rhs) const {
+  // "redmean" weighted euclidean distance, a cheap approximation of how far
+  // apart two colours look. Alpha is compared directly.
+  const float red_mean = (static_cast<float>(lhs.r) + rhs.r) * 0.5f;
+  const float dr = static_cast<float>(lhs.r) - rhs.r;
+  const float dg = static_cast<float>(lhs.g) - rhs.g;
+  const float db = static_cast<float>(lhs.b) - rhs.b;
+  const float da = static_cast<float>(lhs.a) - rhs.a;
+  return std::sqrt((2.0f + red_mean / 256.0f) * dr * dr + 4.0f * dg * dg +
+                   (2.0f + (255.0f - red_mean) / 256.0f) * db * db + da * da);
+}
+
+/////////////////////////////////////////////////
+void VoxManipulator::GreedyMeshing(const ModelData &model_data,
+                                   const Bounds &region,
+                                   std::vector<Triangle> &triangles) {
+  const float tolerance = meshing_options.color_tolerance;
+  const Bounds clamped = ClampToOccupied(model_data, region);
+  if (clamped.IsEmpty())
+    return;
+
+  for (const auto &mask : model_data.masks) {
+    // mask.data[dim1][dim2][dim3] maps to a different axis order per
+    // direction, work out the region's range in each mask dimension
+    sf::Vector3i lower, upper;
+    switch (mask.direction) {
+    case Direction::X_POSITIVE:
+    case Direction::X_NEGATIVE:
+      // mask.data[x][y][z]
+      lower = {clamped.min.x, clamped.min.y, clamped.min.z};
+      upper = {clamped.max.x, clamped.max.y, clamped.max.z};
+      break;
+    case Direction::Y_POSITIVE:
+    case Direction::Y_NEGATIVE:
+      // mask.data[y][z][x]
+      lower = {clamped.min.y, clamped.min.z, clamped.min.x};
+      upper = {clamped.max.y, clamped.max.z, clamped.max.x};
+      break;
+    case Direction::Z_POSITIVE:
+    case Direction::Z_NEGATIVE:
+      // mask.data[z][x][y]
+      lower = {clamped.min.z, clamped.min.x, clamped.min.y};
+      upper = {clamped.max.z, clamped.max.x, clamped.max.y};
+      break;
+    default:
+      std::cout << "[DEBUG] Unknown mask direction in GreedyMeshing: "
+                << (int)mask.direction << std::endl;
       continue;
     }
-    size_t cols = mask.data[0][0].size();
+    const int rows = upper.y - lower.y;
+    const int cols = upper.z - lower.z;
+    if (upper.x <= lower.x || rows <= 0 || cols <= 0)
+      continue;
 
-    // Track which cells are already meshed using a corresponding 3D vector of
-    // bools. The order must match mask.data[dim1][dim2][dim3].
+    // Track which cells are already meshed, indexed relative to the region.
+    // The order must match mask.data[dim1][dim2][dim3].
     std::vector<std::vector<std::vector<bool>>> visited(
-        slice,
+        upper.x - lower.x,
         std::vector<std::vector<bool>>(rows, std::vector<bool>(cols, false)));
 
-    // Iterate over each slice of the mask and find quads
-    for (size_t dim1 = 0; dim1 < slice; ++dim1) {
-      for (size_t dim2 = 0; dim2 < rows; ++dim2) {
-        for (size_t dim3 = 0; dim3 < cols; ++dim3) {
+    // a cell can join the quad if it is unvisited, coloured and close enough
+    // to the colour of the cell the quad started from
+    auto can_merge = [&](int dim1, int dim2, int dim3,
+                         const sf::Color &seed_color) {
+      const auto &cell = mask.data[dim1][dim2][dim3];
+      if (visited[dim1 - lower.x][dim2 - lower.y][dim3 - lower.z] ||
+          !cell.has_value())
+        return false;
+      if (meshing_options.mode == MeshingMode::GREEDY_ATLAS)
+        return true; // colours come from the atlas, only geometry matters
+      if (tolerance <= 0.0f)
+        return cell.value() == seed_color;
+      return ColorDistance(cell.value(), seed_color) <= tolerance;
+    };
+
+    // occupancy counts share the mask layout, masks come in pairs per axis
+    const size_t axis = (static_cast<size_t>(mask.direction) - 1) / 2;
+    const auto &slice_counts = model_data.occupancy.slice_counts[axis];
+    const auto &row_counts = model_data.occupancy.row_counts[axis];
+
+    // Iterate over each slice of the mask and find quads, a slice or row
+    // without visible voxels has no coloured cells to start a quad from
+    for (int dim1 = lower.x; dim1 < upper.x; ++dim1) {
+      if (slice_counts[dim1] == 0)
+        continue;
+      for (int dim2 = lower.y; dim2 < upper.y; ++dim2) {
+        if (row_counts[dim1][dim2] == 0)
+          continue;
+        for (int dim3 = lower.z; dim3 < upper.z; ++dim3) {
           // Only process unvisited, colored cells
-          if (!visited[dim1][dim2][dim3] &&
-              mask.data[dim1][dim2][dim3].has_value()) {
-            sf::Color color = mask.data[dim1][dim2][dim3].value();
-
-            // Find maximal width
-            size_t width = 1;
-            // Expand to the right as long as the next cell is the same color
-            while (dim3 + width < cols && !visited[dim1][dim2][dim3 + width] &&
-                   mask.data[dim1][dim2][dim3 + width].has_value() &&
-                   mask.data[dim1][dim2][dim3 + width].value() == color) {
-              ++width;
-            }
-            // Find maximal height
-            size_t height = 1;
-            // Expand downwards as long as the next row is the same color
-            // (uses width specified above)
-            bool can_expand = true;
-            while (dim2 + height < rows && can_expand) {
-
-              // the whole row must be the the same colour for the increase in
-              // height so we end up with squares
-              for (size_t w = 0; w < width; ++w) {
-                if (visited[dim1][dim2 + height][dim3 + w] ||
-                    !mask.data[dim1][dim2 + height][dim3 + w].has_value() ||
-                    mask.data[dim1][dim2 + height][dim3 + w].value() != color) {
-                  can_expand = false;
-                  break;
-                }
+          if (visited[dim1 - lower.x][dim2 - lower.y][dim3 - lower.z] ||
+              !mask.data[dim1][dim2][dim3].has_value())
+            continue;
+          const sf::Color seed_color = mask.data[dim1][dim2][dim3].value();
+
+          // Find maximal width
+          int width = 1;
+          // Expand to the right as long as the next cell can merge
+          while (dim3 + width < upper.z &&
+                 can_merge(dim1, dim2, dim3 + width, seed_color)) {
+            ++width;
+          }
+          // Find maximal height
+          int height = 1;
+          // Expand downwards as long as the next row can merge (uses width
+          // specified above)
+          bool can_expand = true;
+          while (dim2 + height < upper.y && can_expand) {
+
+            // the whole row must merge for the increase in height so we end
+            // up with rectangles
+            for (int w = 0; w < width; ++w) {
+              if (!can_merge(dim1, dim2 + height, dim3 + w, seed_color)) {
+                can_expand = false;
+                break;
               }
-              if (can_expand)
-                ++height;
             }
+            if (can_expand)
+              ++height;
+          }
 
-            // Mark all cells in the quad as visited
-            for (size_t dy = 0; dy < height; ++dy)
-              for (size_t dx = 0; dx < width; ++dx)
-                visited[dim1][dim2 + dy][dim3 + dx] = true;
-
-            // create two triangles to add to the model data
-            Triangle triangle1, triangle2;
-            switch (mask.direction) {
-            case Direction::X_POSITIVE:
-              // TODO: Fill in correct triangle creation for greedy meshing
-              break;
-            case Direction::X_NEGATIVE:
-              // TODO: Fill in correct triangle creation for greedy meshing
-              break;
-            case Direction::Y_POSITIVE:
-              // TODO: Fill in correct triangle creation for greedy meshing
-              break;
-            case Direction::Y_NEGATIVE:
-              // TODO: Fill in correct triangle creation for greedy meshing
-              break;
-            case Direction::Z_POSITIVE:
-              // TODO: Fill in correct triangle creation for greedy meshing
-              break;
-            case Direction::Z_NEGATIVE:
-              // TODO: Fill in correct triangle creation for greedy meshing
-              break;
-            default:
-              std::cout << "[DEBUG] Unknown mask direction in GreedyMeshing: "
-                        << (int)mask.direction << std::endl;
-              continue;
+          // Mark all cells in the quad as visited and average their colours
+          // so a tolerant merge is represented by its mean colour
+          std::array<unsigned, 4> color_sum{0, 0, 0, 0};
+          for (int dy = 0; dy < height; ++dy) {
+            for (int dx = 0; dx < width; ++dx) {
+              visited[dim1 - lower.x][dim2 + dy - lower.y]
+                     [dim3 + dx - lower.z] = true;
+              const sf::Color &cell =
+                  mask.data[dim1][dim2 + dy][dim3 + dx].value();
+              color_sum[0] += cell.r;
+              color_sum[1] += cell.g;
+              color_sum[2] += cell.b;
+              color_sum[3] += cell.a;
             }
+          }
+          const unsigned cell_count = static_cast<unsigned>(width * height);
+          const sf::Color color(
+              static_cast<std::uint8_t>((color_sum[0] + cell_count / 2) /
+                                        cell_count),
+              static_cast<std::uint8_t>((color_sum[1] + cell_count / 2) /
+                                        cell_count),
+              static_cast<std::uint8_t>((color_sum[2] + cell_count / 2) /
+                                        cell_count),
+              static_cast<std::uint8_t>((color_sum[3] + cell_count / 2) /
+                                        cell_count));
 
-            // Split quad into two triangles
-            // Triangle 1: v0, v1, v2 | Triangle 2: v2, v1, v3
-            model_data.triangles.emplace_back(triangle1);
-            model_data.triangles.emplace_back(triangle2);
+          // create two triangles to add to the model data, with the same
+          // winding as CreateTrianglesFromMask but spanning the whole quad
+          const float d1 = static_cast<float>(dim1);
+          const float d2 = static_cast<float>(dim2);
+          const float d3 = static_cast<float>(dim3);
+          const float h = static_cast<float>(height);
+          const float w = static_cast<float>(width);
+          Triangle triangle1, triangle2;
+          switch (mask.direction) {
+          case Direction::X_POSITIVE:
+            // x = dim1 + 1, y spans height, z spans width
+            triangle1 = Triangle(glm::vec3(d1 + 1, d2, d3),
+                                 glm::vec3(d1 + 1, d2 + h, d3),
+                                 glm::vec3(d1 + 1, d2, d3 + w), color,
+                                 mask.direction);
+            triangle2 = Triangle(glm::vec3(d1 + 1, d2 + h, d3),
+                                 glm::vec3(d1 + 1, d2 + h, d3 + w),
+                                 glm::vec3(d1 + 1, d2, d3 + w), color,
+                                 mask.direction);
+            break;
+          case Direction::X_NEGATIVE:
+            // x = dim1, y spans height, z spans width
+            triangle1 = Triangle(glm::vec3(d1, d2, d3),
+                                 glm::vec3(d1, d2, d3 + w),
+                                 glm::vec3(d1, d2 + h, d3), color,
+                                 mask.direction);
+            triangle2 = Triangle(glm::vec3(d1, d2 + h, d3),
+                                 glm::vec3(d1, d2, d3 + w),
+                                 glm::vec3(d1, d2 + h, d3 + w), color,
+                                 mask.direction);
+            break;
+          case Direction::Y_POSITIVE:
+            // y = dim1 + 1, z spans height, x spans width
+            triangle1 = Triangle(glm::vec3(d3, d1 + 1, d2),
+                                 glm::vec3(d3 + w, d1 + 1, d2),
+                                 glm::vec3(d3, d1 + 1, d2 + h), color,
+                                 mask.direction);
+            triangle2 = Triangle(glm::vec3(d3 + w, d1 + 1, d2),
+                                 glm::vec3(d3 + w, d1 + 1, d2 + h),
+                                 glm::vec3(d3, d1 + 1, d2 + h), color,
+                                 mask.direction);
+            break;
+          case Direction::Y_NEGATIVE:
+            // y = dim1, z spans height, x spans width
+            triangle1 = Triangle(glm::vec3(d3, d1, d2),
+                                 glm::vec3(d3, d1, d2 + h),
+                                 glm::vec3(d3 + w, d1, d2), color,
+                                 mask.direction);
+            triangle2 = Triangle(glm::vec3(d3 + w, d1, d2),
+                                 glm::vec3(d3, d1, d2 + h),
+                                 glm::vec3(d3 + w, d1, d2 + h), color,
+                                 mask.direction);
+            break;
+          case Direction::Z_POSITIVE:
+            // z = dim1 + 1, x spans height, y spans width
+            triangle1 = Triangle(glm::vec3(d2, d3, d1 + 1),
+                                 glm::vec3(d2 + h, d3, d1 + 1),
+                                 glm::vec3(d2, d3 + w, d1 + 1), color,
+                                 mask.direction);
+            triangle2 = Triangle(glm::vec3(d2 + h, d3, d1 + 1),
+                                 glm::vec3(d2 + h, d3 + w, d1 + 1),
+                                 glm::vec3(d2, d3 + w, d1 + 1), color,
+                                 mask.direction);
+            break;
+          case Direction::Z_NEGATIVE:
+            // z = dim1, x spans height, y spans width
+            triangle1 = Triangle(glm::vec3(d2, d3, d1),
+                                 glm::vec3(d2, d3 + w, d1),
+                                 glm::vec3(d2 + h, d3, d1), color,
+                                 mask.direction);
+            triangle2 = Triangle(glm::vec3(d2 + h, d3, d1),
+                                 glm::vec3(d2, d3 + w, d1),
+                                 glm::vec3(d2 + h, d3 + w, d1), color,
+                                 mask.direction);
+            break;
+          default:
+            continue;
           }
+
+          // Split quad into two triangles
+          triangles.emplace_back(triangle1);
+          triangles.emplace_back(triangle2);
         }
       }
     }
-    ++mask_index;
   }
-  std::cout << "[DEBUG] Finished GreedyMeshing()" << std::endl;
 }
 } // namespace hollow_lantern
@@ -14,33 +14,207 @@ namespace hollow_lantern {
 class VoxManipulator {
 
 private:
+  /////////////////////////////////////////////////
+  /// @brief Options controlling how masks are turned into triangles
+  /////////////////////////////////////////////////
+  MeshingOptions meshing_options;
+
   /////////////////////////////////////////////////
   /// @brief Creates a hollowed-out version of the given VoxData and stores it
   /// in the same VoxData object.
   ///
   /// @param vox_data VoxData object to be manipulated.
+  /// @param region Voxel positions to re-evaluate
+  /////////////////////////////////////////////////
+  void HollowOut(ModelData &model_data, const Bounds &region);
+
+  /////////////////////////////////////////////////
+  /// @brief Flood fill empty space from outside the model
+  ///
+  /// Fills ModelData::exterior_air. Every empty cell on the edge of the view
+  /// is exterior, as is every empty cell connected to one through faces.
+  ///
+  /// @param view Voxels to evaluate
+  /// @param target ModelData sized like the view, with its occupancy recorded
+  /////////////////////////////////////////////////
+  void MarkExteriorAir(const ModelView &view, ModelData &target);
+
+  /////////////////////////////////////////////////
+  /// @brief Count the visible voxels of a view into ModelData::occupancy
+  ///
+  /// Run before every full mesh, as voxel_data may have been edited directly
+  /// since VoxReader or Downsample recorded it.
+  ///
+  /// @param view Voxels to count
+  /// @param target ModelData whose occupancy is overwritten
   /////////////////////////////////////////////////
-  void HollowOut(ModelData &model_data);
+  void RecordOccupancy(const ModelView &view, ModelData &target);
+
+  /////////////////////////////////////////////////
+  /// @brief Shrink a region to the part that can hold visible voxels
+  ///
+  /// @param model_data ModelData with a recorded occupancy
+  /// @param region Voxel positions to clamp
+  /// @return Intersection of the region and the occupied bounds
+  /////////////////////////////////////////////////
+  Bounds ClampToOccupied(const ModelData &model_data,
+                         const Bounds &region) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Size the masks to match the model, one cell per voxel, all
+  /// empty
+  ///
+  /// @param model_data ModelData object containing the masks to resize
+  /////////////////////////////////////////////////
+  void ResizeMasks(ModelData &model_data);
 
   /////////////////////////////////////////////////
   /// @brief Generate masks from voxel data and store them in the ModelData
   ///
-  /// @param model_data  ModelData object containing voxel data and masks
+  /// Voxels outside the view count as empty, so faces on the edge of a crop
+  /// are kept.
+  ///
+  /// @param view Voxels to read
+  /// @param target ModelData sized like the view, holding the masks, exterior
+  /// air and occupancy
+  /// @param region Positions, local to the view, whose mask cells are
+  /// regenerated
   /////////////////////////////////////////////////
-  void CreateMasks(ModelData &model_data);
+  void CreateMasks(const ModelView &view, ModelData &target,
+                   const Bounds &region);
   /////////////////////////////////////////////////
   /// @brief Manipulates the mask data to generate triangles
   ///
+  /// Neighbouring cells are merged into one quad while their colour is within
+  /// MeshingOptions::color_tolerance of the cell the quad started from, or
+  /// regardless of colour for GREEDY_ATLAS. The quad is coloured with the mean
+  /// of the merged cells.
+  ///
   /// @param model_data ModelData object containing voxel data and masks
+  /// @param region Voxel positions whose mask cells are meshed
+  /// @param triangles Vector the generated triangles are appended to
   /////////////////////////////////////////////////
-  void GreedyMeshing(ModelData &model_data);
+  void GreedyMeshing(const ModelData &model_data, const Bounds &region,
+                     std::vector<Triangle> &triangles);
+
+  /////////////////////////////////////////////////
+  /// @brief Pack the colours under every greedy quad into the colour atlas
+  ///
+  /// Expects ModelData::triangles to be quads from GreedyMeshing, two
+  /// triangles each. Tile colours are read back from the masks, so the atlas
+  /// can be repacked after any remesh. Sets the tex_coords of every triangle.
+  ///
+  /// @param model_data ModelData with greedy quads and their masks
+  /////////////////////////////////////////////////
+  void BuildColorAtlas(ModelData &model_data);
+
+  /////////////////////////////////////////////////
+  /// @brief Clear a chunk's tiles out of the colour atlas
+  ///
+  /// Tiles are found from the tex_coords of the chunk's current triangles,
+  /// so this has to run before they are replaced. Their texels are added to
+  /// ColorAtlas::free_space.
+  ///
+  /// @param model_data ModelData with the packed atlas
+  /// @param chunk Chunk about to be remeshed
+  /////////////////////////////////////////////////
+  void FreeAtlasTiles(ModelData &model_data, const Chunk &chunk);
+
+  /////////////////////////////////////////////////
+  /// @brief Pack the tiles of some chunks into the atlas' free space
+  ///
+  /// Tiles of other chunks stay where they are. The atlas grows downwards
+  /// when no free space is big enough, as rows added at the bottom leave
+  /// every texel where it was.
+  ///
+  /// @param model_data ModelData with greedy quads, masks and a packed atlas
+  /// @param chunk_indices Chunks whose quads have no tiles yet
+  /// @return False if the atlas should be packed again from scratch instead,
+  /// because a tile is wider than it or most of it has been left free
+  /////////////////////////////////////////////////
+  bool PackAtlasTiles(ModelData &model_data,
+                      const std::vector<size_t> &chunk_indices);
+
+  /////////////////////////////////////////////////
+  /// @brief Perceptual distance between two colours
+  ///
+  /// @return 0 for identical colours, roughly 765 for black to white
+  /////////////////////////////////////////////////
+  float ColorDistance(const sf::Color &lhs, const sf::Color &rhs) const;
 
   /////////////////////////////////////////////////
   /// @brief Create triangles from the mask data without any greey meshing
   ///
-  /// @param model_data [TODO:parameter]
+  /// @param model_data ModelData object containing the masks
+  /// @param region Voxel positions whose mask cells are meshed
+  /// @param triangles Vector the generated triangles are appended to
+  /////////////////////////////////////////////////
+  void CreateTrianglesFromMask(const ModelData &model_data,
+                               const Bounds &region,
+                               std::vector<Triangle> &triangles);
+
+  /////////////////////////////////////////////////
+  /// @brief Split the model into chunks of ModelData::chunk_size, all dirty
+  ///
+  /// @param model_data ModelData object to chunk
+  /////////////////////////////////////////////////
+  void CreateChunks(ModelData &model_data);
+
+  /////////////////////////////////////////////////
+  /// @brief Mark the chunks whose faces depend on a voxel as dirty
+  ///
+  /// This is the chunk holding the voxel and any chunk holding one of its six
+  /// neighbours, as their faces towards the voxel may appear or disappear.
+  ///
+  /// @param model_data ModelData object containing the chunks
+  /// @param position Position of the edited voxel
   /////////////////////////////////////////////////
-  void CreateTrianglesFromMask(ModelData &model_data);
+  void MarkChunksDirty(ModelData &model_data, const sf::Vector3i &position);
+
+  /////////////////////////////////////////////////
+  /// @brief Check ModelData::exterior_air was filled for the model's size
+  /////////////////////////////////////////////////
+  bool ExteriorAirMatches(const ModelData &model_data) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Grow the exterior air into a voxel that has just been cleared
+  ///
+  /// Clearing a voxel can only open space up, so if it touches exterior air
+  /// the fill starts from it and only visits cells that become exterior,
+  /// such as a cavity it breaks into. Chunks next to every changed cell are
+  /// marked dirty.
+  ///
+  /// @param model_data ModelData with exterior_air filled
+  /// @param position Position of the cleared voxel
+  /////////////////////////////////////////////////
+  void OpenExteriorAir(ModelData &model_data, const sf::Vector3i &position);
+
+  /////////////////////////////////////////////////
+  /// @brief Take back exterior air sealed off by a voxel that has just been
+  /// set
+  ///
+  /// Only air touching the voxel can lose its way out. A search starts from
+  /// each exterior neighbour and they take turns a cell at a time, merging
+  /// when they meet. A search stops once it reaches the edge of the model or
+  /// is the only one left that could have, so only pockets that really are
+  /// sealed get visited in full. Chunks next to every changed cell are
+  /// marked dirty.
+  ///
+  /// @param model_data ModelData with exterior_air filled
+  /// @param position Position of the set voxel
+  /////////////////////////////////////////////////
+  void SealExteriorAir(ModelData &model_data, const sf::Vector3i &position);
+
+  /////////////////////////////////////////////////
+  /// @brief Halve the resolution of a model
+  ///
+  /// Each 2x2x2 block becomes one voxel, visible if any voxel in the block is
+  /// visible and coloured with the most common colour in the block.
+  ///
+  /// @param model_data ModelData to downsample
+  /// @return ModelData with voxel data only, not yet meshed
+  /////////////////////////////////////////////////
+  ModelData Downsample(const ModelData &model_data) const;
 
 public:
   /////////////////////////////////////////////////
@@ -48,13 +222,93 @@ public:
   /////////////////////////////////////////////////
   VoxManipulator() = default;
 
+  /////////////////////////////////////////////////
+  /// @brief Construct a VoxManipulator with non-default meshing
+  ///
+  /// @param meshing_options Options used by every mesh and remesh
+  /////////////////////////////////////////////////
+  explicit VoxManipulator(const MeshingOptions &meshing_options);
+
   /////////////////////////////////////////////////
   /// @brief A workflow function that collates a set of operations
   ///
   /// @param model_data ModelData needed for the manipulations
   /////////////////////////////////////////////////
   void HollowAndMesh(ModelData &model_data);
-  ;
+
+  /////////////////////////////////////////////////
+  /// @brief Hollow and mesh an axis-aligned box of a model on its own
+  ///
+  /// Voxels outside the box count as empty, so the crop is closed off where it
+  /// cuts through the model. The model's voxels are read in place. The result
+  /// holds masks, exterior air and triangles for the box only, positioned
+  /// relative to the box with ModelData::origin recording where it sits. It
+  /// has no voxel data, so it can be projected but not edited or remeshed.
+  ///
+  /// @param model_data Model to crop, left unchanged
+  /// @param crop Voxel positions to mesh, clamped to the model
+  /// @return Meshed crop ready for the Projector
+  /////////////////////////////////////////////////
+  ModelData CropAndMesh(const ModelData &model_data, const Bounds &crop);
+
+  /////////////////////////////////////////////////
+  /// @brief Turn a voxel on with the given colour
+  ///
+  /// Only marks the affected chunks as dirty, call Remesh to update triangles.
+  /// Exterior air the voxel seals off is taken back here.
+  ///
+  /// @param model_data ModelData containing the voxel
+  /// @param position Position of the voxel to set
+  /// @param color New colour of the voxel
+  /// @return False if the position is outside the model
+  /////////////////////////////////////////////////
+  bool SetVoxel(ModelData &model_data, const sf::Vector3i &position,
+                const sf::Color &color);
+
+  /////////////////////////////////////////////////
+  /// @brief Turn a voxel off
+  ///
+  /// Only marks the affected chunks as dirty, call Remesh to update triangles.
+  /// Exterior air spreads into the voxel, and any cavity it opens, here.
+  ///
+  /// @param model_data ModelData containing the voxel
+  /// @param position Position of the voxel to clear
+  /// @return False if the position is outside the model
+  /////////////////////////////////////////////////
+  bool ClearVoxel(ModelData &model_data, const sf::Vector3i &position);
+
+  /////////////////////////////////////////////////
+  /// @brief Apply a batch of edits, skipping any outside the model
+  ///
+  /// @param model_data ModelData containing the voxels
+  /// @param edits Edits to apply in order
+  /////////////////////////////////////////////////
+  void ApplyVoxelEdits(ModelData &model_data,
+                       const std::vector<VoxelEdit> &edits);
+
+  /////////////////////////////////////////////////
+  /// @brief Rebuild the triangles of dirty chunks only
+  ///
+  /// Clean chunks keep their existing triangles. If the model has not been
+  /// chunked yet the whole model is meshed. ModelData::exterior_air is kept
+  /// up to date by SetVoxel and ClearVoxel, so it is only flood filled here
+  /// when the whole model is meshed. In GREEDY_ATLAS mode only the dirty
+  /// chunks' tiles are repacked, into the space their old tiles leave.
+  ///
+  /// @param model_data ModelData to remesh
+  /////////////////////////////////////////////////
+  void Remesh(ModelData &model_data);
+
+  /////////////////////////////////////////////////
+  /// @brief Fill ModelData::levels_of_detail with meshed, coarser copies
+  ///
+  /// Each level halves the resolution of the previous one, so three levels are
+  /// 2x, 4x and 8x coarser than the source model.
+  ///
+  /// @param model_data ModelData to generate levels for
+  /// @param level_count Number of levels to generate
+  /////////////////////////////////////////////////
+  void GenerateLevelsOfDetail(ModelData &model_data, size_t level_count = 3);
 };
 
 } // namespace hollow_lantern
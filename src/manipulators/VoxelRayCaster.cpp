@@ -0,0 +1,294 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Implementation of the VoxelRayCaster class
+/////////////////////////////////////////////////
+
+#include "VoxelRayCaster.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace hollow_lantern {
+
+/////////////////////////////////////////////////
+VoxelRayCaster::VoxelRayCaster(const ModelData &model_data,
+                               float rays_per_voxel)
+    : model(&model_data), rays_per_voxel(rays_per_voxel) {
+  const sf::Vector3i &size = model->size;
+  brick_count = {(size.x + brick_size - 1) / brick_size,
+                 (size.y + brick_size - 1) / brick_size,
+                 (size.z + brick_size - 1) / brick_size};
+  brick_occupied.assign(static_cast<size_t>(brick_count.x) * brick_count.y *
+                            brick_count.z,
+                        0);
+
+  // only the occupied box can hold visible voxels
+  Bounds region{{0, 0, 0}, size};
+  if (model->occupancy.Matches(size))
+    region = model->occupancy.bounds;
+  for (int x = region.min.x; x < region.max.x; ++x) {
+    for (int y = region.min.y; y < region.max.y; ++y) {
+      for (int z = region.min.z; z < region.max.z; ++z) {
+        if (!model->voxel_data[x][y][z].is_visible)
+          continue;
+        const size_t brick = (static_cast<size_t>(x / brick_size) *
+                                  brick_count.y +
+                              y / brick_size) *
+                                 brick_count.z +
+                             z / brick_size;
+        brick_occupied[brick] = 1;
+      }
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+FaceHits VoxelRayCaster::CastRays(const glm::mat4 &rotation) const {
+  const sf::Vector3i &size = model->size;
+  FaceHits hits;
+  hits.size = size;
+
+  Bounds region{{0, 0, 0}, size};
+  if (model->occupancy.Matches(size))
+    region = model->occupancy.bounds;
+  if (region.IsEmpty())
+    return hits;
+
+  // the rotation is orthonormal, so its rows are the screen axes and the
+  // view direction in model space. glm matrices are indexed [column][row]
+  glm::vec3 right(rotation[0][0], rotation[1][0], rotation[2][0]);
+  glm::vec3 up(rotation[0][1], rotation[1][1], rotation[2][1]);
+  glm::vec3 forward(rotation[0][2], rotation[1][2], rotation[2][2]);
+  right = glm::normalize(right);
+  up = glm::normalize(up);
+  forward = glm::normalize(forward);
+
+  // screen rectangle and depth range covered by the occupied box
+  constexpr float infinity = std::numeric_limits<float>::infinity();
+  glm::vec3 lower(infinity);
+  glm::vec3 upper(-infinity);
+  for (int corner = 0; corner < 8; ++corner) {
+    const glm::vec3 point(
+        static_cast<float>(corner & 1 ? region.max.x : region.min.x),
+        static_cast<float>(corner & 2 ? region.max.y : region.min.y),
+        static_cast<float>(corner & 4 ? region.max.z : region.min.z));
+    const glm::vec3 on_screen(glm::dot(point, right), glm::dot(point, up),
+                              glm::dot(point, forward));
+    lower = glm::min(lower, on_screen);
+    upper = glm::max(upper, on_screen);
+  }
+
+  const int columns =
+      static_cast<int>(std::ceil((upper.x - lower.x) * rays_per_voxel));
+  const int rows =
+      static_cast<int>(std::ceil((upper.y - lower.y) * rays_per_voxel));
+  for (int row = 0; row < rows; ++row) {
+    const float v = lower.y + (static_cast<float>(row) + 0.5f) / rays_per_voxel;
+    for (int column = 0; column < columns; ++column) {
+      const float u =
+          lower.x + (static_cast<float>(column) + 0.5f) / rays_per_voxel;
+      // start every ray a voxel in front of the nearest corner
+      const glm::vec3 origin =
+          right * u + up * v + forward * (lower.z - 1.0f);
+      CastRay(origin, forward, hits);
+    }
+  }
+  std::sort(hits.faces.begin(), hits.faces.end());
+  hits.faces.erase(std::unique(hits.faces.begin(), hits.faces.end()),
+                   hits.faces.end());
+  return hits;
+}
+
+/////////////////////////////////////////////////
+std::vector<bool>
+VoxelRayCaster::VisibleTriangles(const std::vector<Triangle> &mesh,
+                                 const glm::mat4 &rotation) const {
+  const FaceHits hits = CastRays(rotation);
+  const std::array<int, 3> size{model->size.x, model->size.y, model->size.z};
+
+  std::vector<bool> visible(mesh.size(), false);
+  for (size_t tri_idx = 0; tri_idx < mesh.size(); ++tri_idx) {
+    const Triangle &triangle = mesh[tri_idx];
+    if (triangle.direction == Direction::NONE) {
+      visible[tri_idx] = true; // no face to look up, keep it
+      continue;
+    }
+    // the face sits on the far side of the voxel for positive directions
+    const int direction_idx = static_cast<int>(triangle.direction) - 1;
+    const int axis = direction_idx / 2;
+    const bool is_positive = direction_idx % 2 == 0;
+    const int plane =
+        static_cast<int>(std::lround(triangle.vertices[0][axis]));
+    const int layer = is_positive ? plane - 1 : plane;
+    if (layer < 0 || layer >= size[axis])
+      continue;
+
+    // test the centre of every voxel face under the triangle
+    const int b = (axis + 1) % 3;
+    const int c = (axis + 2) % 3;
+    const glm::vec2 p0(triangle.vertices[0][b], triangle.vertices[0][c]);
+    const glm::vec2 p1(triangle.vertices[1][b], triangle.vertices[1][c]);
+    const glm::vec2 p2(triangle.vertices[2][b], triangle.vertices[2][c]);
+    const float area = (p1.x - p0.x) * (p2.y - p0.y) -
+                       (p1.y - p0.y) * (p2.x - p0.x);
+    if (area == 0.0f)
+      continue;
+    const int b_begin = std::max(0, static_cast<int>(std::floor(
+                                        std::min({p0.x, p1.x, p2.x}))));
+    const int b_end = std::min(
+        size[b], static_cast<int>(std::ceil(std::max({p0.x, p1.x, p2.x}))));
+    const int c_begin = std::max(0, static_cast<int>(std::floor(
+                                        std::min({p0.y, p1.y, p2.y}))));
+    const int c_end = std::min(
+        size[c], static_cast<int>(std::ceil(std::max({p0.y, p1.y, p2.y}))));
+
+    for (int j = b_begin; j < b_end && !visible[tri_idx]; ++j) {
+      for (int k = c_begin; k < c_end; ++k) {
+        const glm::vec2 centre(static_cast<float>(j) + 0.5f,
+                               static_cast<float>(k) + 0.5f);
+        // inclusive edges, so both halves of a split quad claim the diagonal
+        const float w0 = ((p1.x - centre.x) * (p2.y - centre.y) -
+                          (p1.y - centre.y) * (p2.x - centre.x)) /
+                         area;
+        const float w1 = ((p2.x - centre.x) * (p0.y - centre.y) -
+                          (p2.y - centre.y) * (p0.x - centre.x)) /
+                         area;
+        const float w2 = 1.0f - w0 - w1;
+        if (w0 < -1e-6f || w1 < -1e-6f || w2 < -1e-6f)
+          continue;
+        std::array<int, 3> cell{};
+        cell[axis] = layer;
+        cell[b] = j;
+        cell[c] = k;
+        if (hits.IsHit(triangle.direction, cell[0], cell[1], cell[2])) {
+          visible[tri_idx] = true;
+          break;
+        }
+      }
+    }
+  }
+  return visible;
+}
+
+/////////////////////////////////////////////////
+bool VoxelRayCaster::IsBrickOccupied(const std::array<int, 3> &cell) const {
+  const size_t brick =
+      (static_cast<size_t>(cell[0] / brick_size) * brick_count.y +
+       cell[1] / brick_size) *
+          brick_count.z +
+      cell[2] / brick_size;
+  return brick_occupied[brick] != 0;
+}
+
+/////////////////////////////////////////////////
+void VoxelRayCaster::CastRay(const glm::vec3 &origin,
+                             const glm::vec3 &direction,
+                             FaceHits &hits) const {
+  constexpr float infinity = std::numeric_limits<float>::infinity();
+  const std::array<int, 3> size{model->size.x, model->size.y, model->size.z};
+  const std::array<float, 3> o{origin.x, origin.y, origin.z};
+  const std::array<float, 3> d{direction.x, direction.y, direction.z};
+
+  // clip the ray to the grid, remembering which side it comes in through
+  float t_enter = -infinity;
+  float t_leave = infinity;
+  int entry_axis = -1;
+  std::array<int, 3> step{0, 0, 0};
+  for (int axis = 0; axis < 3; ++axis) {
+    if (std::abs(d[axis]) < 1e-8f) {
+      if (o[axis] < 0.0f || o[axis] >= static_cast<float>(size[axis]))
+        return; // parallel to the grid and outside it
+      continue;
+    }
+    step[axis] = d[axis] > 0.0f ? 1 : -1;
+    float t_near = (0.0f - o[axis]) / d[axis];
+    float t_far = (static_cast<float>(size[axis]) - o[axis]) / d[axis];
+    if (t_near > t_far)
+      std::swap(t_near, t_far);
+    if (t_near > t_enter) {
+      t_enter = t_near;
+      entry_axis = axis;
+    }
+    t_leave = std::min(t_leave, t_far);
+  }
+  if (entry_axis == -1 || t_enter >= t_leave)
+    return;
+
+  // place the ray in the cell just past a plane it crosses at t
+  std::array<int, 3> cell{};
+  std::array<float, 3> t_max{};
+  auto start_at = [&](float t, int crossed_axis, int boundary) {
+    for (int axis = 0; axis < 3; ++axis) {
+      if (axis == crossed_axis) {
+        cell[axis] = step[axis] > 0 ? boundary : boundary - 1;
+      } else {
+        cell[axis] = std::clamp(
+            static_cast<int>(std::floor(o[axis] + t * d[axis])), 0,
+            size[axis] - 1);
+      }
+      t_max[axis] = step[axis] == 0
+                        ? infinity
+                        : (static_cast<float>(cell[axis] + (step[axis] > 0)) -
+                           o[axis]) /
+                              d[axis];
+    }
+  };
+  auto is_inside = [&]() {
+    return cell[0] >= 0 && cell[0] < size[0] && cell[1] >= 0 &&
+           cell[1] < size[1] && cell[2] >= 0 && cell[2] < size[2];
+  };
+
+  start_at(t_enter, entry_axis, step[entry_axis] > 0 ? 0 : size[entry_axis]);
+  int last_axis = entry_axis;
+  while (is_inside()) {
+    if (!IsBrickOccupied(cell)) {
+      // jump to wherever the ray leaves this brick
+      float t_exit = infinity;
+      int exit_axis = -1;
+      int exit_boundary = 0;
+      for (int axis = 0; axis < 3; ++axis) {
+        if (step[axis] == 0)
+          continue;
+        const int brick_start = cell[axis] / brick_size * brick_size;
+        const int boundary =
+            step[axis] > 0 ? std::min(brick_start + brick_size, size[axis])
+                           : brick_start;
+        const float t =
+            (static_cast<float>(boundary) - o[axis]) / d[axis];
+        if (t < t_exit) {
+          t_exit = t;
+          exit_axis = axis;
+          exit_boundary = boundary;
+        }
+      }
+      start_at(t_exit, exit_axis, exit_boundary);
+      last_axis = exit_axis;
+      continue;
+    }
+
+    if (model->voxel_data[cell[0]][cell[1]][cell[2]].is_visible) {
+      // the face struck points back along the step that entered the voxel
+      const int direction_idx = last_axis * 2 + (step[last_axis] > 0 ? 1 : 0);
+      const uint64_t key = hits.Key(direction_idx, cell[0], cell[1], cell[2]);
+      // neighbouring rays mostly strike the same face, so repeats of the
+      // last face are dropped before the list is sorted
+      if (hits.faces.empty() || hits.faces.back() != key)
+        hits.faces.push_back(key);
+      return;
+    }
+
+    // step into whichever neighbour the ray reaches first
+    int axis = 0;
+    if (t_max[1] < t_max[axis])
+      axis = 1;
+    if (t_max[2] < t_max[axis])
+      axis = 2;
+    cell[axis] += step[axis];
+    t_max[axis] += std::abs(1.0f / d[axis]);
+    last_axis = axis;
+  }
+}
+
+} // namespace hollow_lantern
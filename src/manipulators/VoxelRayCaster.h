@@ -0,0 +1,130 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the VoxelRayCaster class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "ModelData.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <vector>
+
+namespace hollow_lantern {
+
+/////////////////////////////////////////////////
+/// @brief Voxel faces struck by at least one ray of a view
+///
+/// Only the faces struck are kept, as a sorted list of keys, so memory grows
+/// with the rays cast rather than the volume of the model. A face's key is
+/// its voxel, indexed (x * size.y + y) * size.z + z, times six plus its
+/// direction, ordered X+, X-, Y+, Y-, Z+, Z- to match the Direction enum.
+/////////////////////////////////////////////////
+struct FaceHits {
+  sf::Vector3i size{0, 0, 0};
+  std::vector<uint64_t> faces;
+
+  uint64_t Key(size_t direction_idx, int x, int y, int z) const {
+    return ((static_cast<uint64_t>(x) * size.y + y) * size.z + z) * 6 +
+           direction_idx;
+  };
+
+  bool IsHit(Direction direction, int x, int y, int z) const {
+    return std::binary_search(
+        faces.begin(), faces.end(),
+        Key(static_cast<size_t>(direction) - 1, x, y, z));
+  };
+};
+
+class VoxelRayCaster {
+
+private:
+  /////////////////////////////////////////////////
+  /// @brief Edge length (in voxels) of the bricks used to skip empty space
+  /////////////////////////////////////////////////
+  static constexpr int brick_size{4};
+
+  /////////////////////////////////////////////////
+  /// @brief Model the rays are cast through, must outlive the caster
+  /////////////////////////////////////////////////
+  const ModelData *model;
+
+  /////////////////////////////////////////////////
+  /// @brief Rays per voxel along each screen axis
+  /////////////////////////////////////////////////
+  float rays_per_voxel;
+
+  /////////////////////////////////////////////////
+  /// @brief Number of bricks along each axis
+  /////////////////////////////////////////////////
+  sf::Vector3i brick_count{0, 0, 0};
+
+  /////////////////////////////////////////////////
+  /// @brief 1 for bricks holding any visible voxel, indexed
+  /// (x * brick_count.y + y) * brick_count.z + z
+  /////////////////////////////////////////////////
+  std::vector<uint8_t> brick_occupied;
+
+  /////////////////////////////////////////////////
+  /// @brief Check whether the brick holding a voxel has anything in it
+  /////////////////////////////////////////////////
+  bool IsBrickOccupied(const std::array<int, 3> &cell) const;
+
+  /////////////////////////////////////////////////
+  /// @brief March one ray through the grid and mark the face it hits first
+  ///
+  /// Uses a 3D-DDA, stepping one voxel at a time through occupied bricks and
+  /// jumping straight to the far side of empty ones.
+  ///
+  /// @param origin Start of the ray in voxel units, outside the grid
+  /// @param direction Unit direction of the ray
+  /// @param hits Receives the face struck, if any, unsorted
+  /////////////////////////////////////////////////
+  void CastRay(const glm::vec3 &origin, const glm::vec3 &direction,
+               FaceHits &hits) const;
+
+public:
+  /////////////////////////////////////////////////
+  /// @brief Prepare to cast rays through a model
+  ///
+  /// @param model_data Model with voxel_data, kept by reference
+  /// @param rays_per_voxel Rays per voxel along each screen axis
+  /////////////////////////////////////////////////
+  explicit VoxelRayCaster(const ModelData &model_data,
+                          float rays_per_voxel = 4.0f);
+
+  /////////////////////////////////////////////////
+  /// @brief Cast a grid of parallel rays for one view
+  ///
+  /// The camera looks down +z after rotation, like Projector's views. Rays
+  /// are spaced evenly on screen, so the work grows with the view's size on
+  /// screen rather than with the surface area of the model.
+  ///
+  /// @param rotation Matrix rotating the model into view, translation and
+  /// uniform scale are ignored
+  /// @return Every face struck by a ray
+  /////////////////////////////////////////////////
+  FaceHits CastRays(const glm::mat4 &rotation) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Work out which triangles of a mesh a view can see
+  ///
+  /// A triangle is visible if the centre of any voxel face it covers was hit.
+  /// Faces so thin on screen that no ray lands on them are reported hidden.
+  ///
+  /// @param mesh Triangles meshed from the model, in voxel units
+  /// @param rotation Matrix rotating the model into view
+  /// @return One flag per triangle of mesh
+  /////////////////////////////////////////////////
+  std::vector<bool> VisibleTriangles(const std::vector<Triangle> &mesh,
+                                     const glm::mat4 &rotation) const;
+};
+} // namespace hollow_lantern
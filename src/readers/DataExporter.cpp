@@ -7,19 +7,34 @@
 /// Headers
 /////////////////////////////////////////////////
 #include "DataExporter.h"
+#include "ViewFile.h"
 #include "directory_paths.h"
+#include <SFML/Graphics/PrimitiveType.hpp>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <filesystem>
 #include <fstream>
 #include <nlohmann/json.hpp>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
 
 namespace hollow_lantern {
 
 using json = nlohmann::json;
+
+namespace {
 /////////////////////////////////////////////////
-void DataExporter::ExportToJSON(const ModelData &model_data) {
+/// @brief Text is handed to the file in chunks of about this many bytes
+/////////////////////////////////////////////////
+constexpr size_t write_chunk_size = 1 << 20;
 
-  // construct the export path
-  const auto export_path =
-      config::getExportFolder() / (model_data.name + ".json");
+/////////////////////////////////////////////////
+/// @brief Open the export file for a model, creating the folder if needed
+/////////////////////////////////////////////////
+std::ofstream OpenExportFile(const std::filesystem::path &export_path) {
   // create the export folder if it does not exist
   std::filesystem::create_directories(export_path.parent_path());
   // open the file for writing
@@ -28,63 +43,194 @@ void DataExporter::ExportToJSON(const ModelData &model_data) {
     throw std::runtime_error("Failed to open file for writing: " +
                              export_path.string());
   }
-  // create the json data from the model data
-  json json_data;
-  json_data["name"] = model_data.name;
-  json_data["projections"] = json::array();
-
-  for (const auto &projection : model_data.projected_data) {
-    json projection_json;
-    projection_json["triangles"] = json::array();
-
-    for (size_t i = 0; i < projection.getVertexCount(); i++) {
-
-      json vertices = json::array();
-      // vertex one of the triangle
-      json vertex_one;
-      vertex_one["x"] = projection[i].position.x;
-      vertex_one["y"] = projection[i].position.y;
-      vertex_one["r"] = projection[i].color.r;
-      vertex_one["g"] = projection[i].color.g;
-      vertex_one["b"] = projection[i].color.b;
-      vertex_one["a"] = projection[i].color.a;
-      vertices.push_back(vertex_one);
-
-      if (i + 1 >= projection.getVertexCount()) {
-        break; // avoid out of bounds access
+  return file;
+}
+
+/////////////////////////////////////////////////
+/// @brief Writes the export document one view at a time
+///
+/// Text goes into a buffer that is handed to the file whenever it fills, so
+/// no more than one chunk is ever held, however large the model. Indented
+/// output is laid out the same as nlohmann::json::dump(4) and compact output
+/// the same as dump(), with keys in the same sorted order.
+/////////////////////////////////////////////////
+class ProjectionStreamWriter {
+
+private:
+  std::ostream &file;
+  bool compact;
+  std::string buffer;
+  bool is_first_projection{true};
+
+  /////////////////////////////////////////////////
+  /// @brief Start a new line at a nesting depth, nothing when compact
+  /////////////////////////////////////////////////
+  void WriteNewLine(size_t depth) {
+    if (compact)
+      return;
+    buffer += '\n';
+    buffer.append(depth * 4, ' ');
+  };
+
+  void WriteKey(const char *key) {
+    buffer += '"';
+    buffer += key;
+    buffer += compact ? "\":" : "\": ";
+  };
+
+  /////////////////////////////////////////////////
+  /// @brief Shortest text that reads back as the same float
+  /////////////////////////////////////////////////
+  void WriteNumber(float value) {
+    if (!std::isfinite(value)) {
+      buffer += "null"; // as nlohmann::json writes it
+      return;
+    }
+    std::array<char, 32> text;
+    const std::to_chars_result result =
+        std::to_chars(text.data(), text.data() + text.size(), value);
+    const std::string_view digits(text.data(), result.ptr - text.data());
+    buffer += digits;
+    // keep whole numbers floats, e.g. 2.0 rather than 2
+    if (digits.find_first_of(".e") == std::string_view::npos)
+      buffer += ".0";
+  };
+
+  void WriteVertex(const sf::Vertex &vertex, size_t depth) {
+    const std::array<std::pair<const char *, int>, 4> channels{
+        {{"a", vertex.color.a},
+         {"b", vertex.color.b},
+         {"g", vertex.color.g},
+         {"r", vertex.color.r}}};
+    buffer += '{';
+    for (const auto &[key, value] : channels) {
+      WriteNewLine(depth + 1);
+      WriteKey(key);
+      buffer += std::to_string(value);
+      buffer += ',';
+    }
+    WriteNewLine(depth + 1);
+    WriteKey("x");
+    WriteNumber(vertex.position.x);
+    buffer += ',';
+    WriteNewLine(depth + 1);
+    WriteKey("y");
+    WriteNumber(vertex.position.y);
+    WriteNewLine(depth);
+    buffer += '}';
+  };
+
+  /////////////////////////////////////////////////
+  /// @brief Hand the buffer to the file once it is a chunk long
+  /////////////////////////////////////////////////
+  void FlushIfFull() {
+    if (buffer.size() >= write_chunk_size)
+      Flush();
+  };
+
+public:
+  ProjectionStreamWriter(std::ostream &file, bool compact)
+      : file(file), compact(compact) {
+    buffer.reserve(write_chunk_size + 4096);
+  };
+
+  void BeginDocument(const std::string &name) {
+    buffer += '{';
+    WriteNewLine(1);
+    WriteKey("name");
+    buffer += json(name).dump();
+    buffer += ',';
+    WriteNewLine(1);
+    WriteKey("projections");
+    buffer += '[';
+  };
+
+  /////////////////////////////////////////////////
+  /// @brief Write one view, three vertices a triangle, or one flat list of
+  /// vertices for a triangle strip
+  /////////////////////////////////////////////////
+  void WriteProjection(const sf::VertexArray &projection) {
+    if (!is_first_projection)
+      buffer += ',';
+    is_first_projection = false;
+    WriteNewLine(2);
+    buffer += '{';
+    WriteNewLine(3);
+
+    const size_t count = projection.getVertexCount();
+    bool is_empty = true;
+    if (projection.getPrimitiveType() == sf::PrimitiveType::TriangleStrip) {
+      // every vertex after the first two adds a triangle
+      WriteKey("triangle_strip");
+      buffer += '[';
+      for (size_t i = 0; i < count; i++) {
+        buffer += is_empty ? "" : ",";
+        is_empty = false;
+        WriteNewLine(4);
+        WriteVertex(projection[i], 4);
+        FlushIfFull();
       }
-      i++;
-      // vertex two of the triangle
-      json vertex_two;
-      vertex_two["x"] = projection[i].position.x;
-      vertex_two["y"] = projection[i].position.y;
-      vertex_two["r"] = projection[i].color.r;
-      vertex_two["g"] = projection[i].color.g;
-      vertex_two["b"] = projection[i].color.b;
-      vertex_two["a"] = projection[i].color.a;
-      vertices.push_back(vertex_two);
-
-      if (i + 1 >= projection.getVertexCount()) {
-        break; // avoid out of bounds access
+    } else {
+      WriteKey("triangles");
+      buffer += '[';
+      // a trailing partial triangle is left out
+      for (size_t i = 0; i + 2 < count; i += 3) {
+        buffer += is_empty ? "" : ",";
+        is_empty = false;
+        WriteNewLine(4);
+        buffer += '[';
+        for (size_t corner = 0; corner < 3; ++corner) {
+          buffer += corner == 0 ? "" : ",";
+          WriteNewLine(5);
+          WriteVertex(projection[i + corner], 5);
+        }
+        WriteNewLine(4);
+        buffer += ']';
+        FlushIfFull();
       }
-      i++;
-      // vertex three of the triangle
-      json vertex_three;
-      vertex_three["x"] = projection[i].position.x;
-      vertex_three["y"] = projection[i].position.y;
-      vertex_three["r"] = projection[i].color.r;
-      vertex_three["g"] = projection[i].color.g;
-      vertex_three["b"] = projection[i].color.b;
-      vertex_three["a"] = projection[i].color.a;
-      vertices.push_back(vertex_three);
-      // add the vertices to the projection json
-      projection_json["triangles"].push_back(vertices);
     }
+    if (!is_empty)
+      WriteNewLine(3);
+    buffer += ']';
+    WriteNewLine(2);
+    buffer += '}';
+    FlushIfFull();
+  };
 
-    json_data["projections"].push_back(projection_json);
-  }
+  void EndDocument() {
+    if (!is_first_projection)
+      WriteNewLine(1);
+    buffer += ']';
+    WriteNewLine(0);
+    buffer += '}';
+    Flush();
+  };
+
+  void Flush() {
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+  };
+};
+} // namespace
+
+/////////////////////////////////////////////////
+DataExporter::DataExporter(const ExportOptions &options) : options(options) {}
+
+/////////////////////////////////////////////////
+void DataExporter::ExportToJSON(const ModelData &model_data) {
+
+  // construct the export path
+  const auto export_path =
+      config::getExportFolder() / (model_data.name + ".json");
+  std::ofstream file = OpenExportFile(export_path);
+
+  // views are written straight from the model, nothing is built up first
+  ProjectionStreamWriter writer(file, options.compact_json);
+  writer.BeginDocument(model_data.name);
+  for (const auto &projection : model_data.projected_data)
+    writer.WriteProjection(projection);
+  writer.EndDocument();
 
-  file << json_data.dump(4); // write the json data to the file
   // check if the file was written successfully
   if (!file) {
     throw std::runtime_error("Failed to write to file: " +
@@ -93,4 +239,47 @@ void DataExporter::ExportToJSON(const ModelData &model_data) {
   // close the file
   file.close();
 }
+
+/////////////////////////////////////////////////
+void DataExporter::ExportToJSON(
+    const std::string &name,
+    const std::function<bool(sf::VertexArray &)> &next_view) {
+
+  const auto export_path = config::getExportFolder() / (name + ".json");
+  std::ofstream file = OpenExportFile(export_path);
+
+  ProjectionStreamWriter writer(file, options.compact_json);
+  writer.BeginDocument(name);
+  sf::VertexArray projection;
+  while (next_view(projection))
+    writer.WriteProjection(projection);
+  writer.EndDocument();
+
+  // check if the file was written successfully
+  if (!file) {
+    throw std::runtime_error("Failed to write to file: " +
+                             export_path.string());
+  }
+  file.close();
+}
+
+/////////////////////////////////////////////////
+void DataExporter::ExportToBinary(const ModelData &model_data) {
+
+  const auto export_path =
+      config::getExportFolder() / (model_data.name + ".hlviews");
+  ViewFile::Write(export_path, model_data.name, model_data.projected_data);
+}
+
+/////////////////////////////////////////////////
+void DataExporter::ExportSpriteSheet(const std::string &name,
+                                     const sf::Image &sheet) {
+
+  const auto export_path = config::getExportFolder() / (name + "_sheet.png");
+  std::filesystem::create_directories(export_path.parent_path());
+  if (!sheet.saveToFile(export_path)) {
+    throw std::runtime_error("Failed to write to file: " +
+                             export_path.string());
+  }
+}
 } // namespace hollow_lantern
@@ -12,19 +12,78 @@
 /// Headers
 /////////////////////////////////////////////////
 #include "ModelData.h"
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
+#include <functional>
+#include <string>
 namespace hollow_lantern {
 
+/////////////////////////////////////////////////
+/// @brief Options controlling how exported files are written
+/////////////////////////////////////////////////
+struct ExportOptions {
+  /////////////////////////////////////////////////
+  /// @brief Write JSON without indentation or line breaks
+  /////////////////////////////////////////////////
+  bool compact_json{false};
+};
+
 class DataExporter {
 
 private:
+  ExportOptions options;
+
 public:
   DataExporter() = default;
 
+  /////////////////////////////////////////////////
+  /// @brief Construct a DataExporter with the given options
+  /////////////////////////////////////////////////
+  explicit DataExporter(const ExportOptions &options);
+
   /////////////////////////////////////////////////
   /// @brief Exports model data to a JSON file
   ///
+  /// Views are written out one at a time through a fixed size buffer, no
+  /// document is built in memory first.
+  ///
+  /// Views written as triangle strips are exported as a "triangle_strip"
+  /// list of vertices instead of a "triangles" list of vertex triples.
+  ///
   /// @param model_data ModelData object containing the data to export
   /////////////////////////////////////////////////
   void ExportToJSON(const ModelData &model_data);
+
+  /////////////////////////////////////////////////
+  /// @brief Exports views to a JSON file as they are produced
+  ///
+  /// Writes the same file as ExportToJSON, but each view is written out and
+  /// dropped before the next one is asked for, e.g. from a
+  /// ProjectionSequence, so the views never all need to be in memory.
+  ///
+  /// @param name Name of the model, used for the file name
+  /// @param next_view Overwrites its argument with the next view and returns
+  /// true, or returns false once there are no more
+  /////////////////////////////////////////////////
+  void ExportToJSON(const std::string &name,
+                    const std::function<bool(sf::VertexArray &)> &next_view);
+
+  /////////////////////////////////////////////////
+  /// @brief Exports model data to a binary .hlviews file
+  ///
+  /// Holds the same views as ExportToJSON, laid out so ViewFile can map it
+  /// and use the views without parsing.
+  ///
+  /// @param model_data ModelData object containing the data to export
+  /////////////////////////////////////////////////
+  void ExportToBinary(const ModelData &model_data);
+
+  /////////////////////////////////////////////////
+  /// @brief Exports a rasterised sprite sheet to a PNG file
+  ///
+  /// @param name Name of the model, the file is called <name>_sheet.png
+  /// @param sheet Image to write, e.g. from SpriteRasterizer
+  /////////////////////////////////////////////////
+  void ExportSpriteSheet(const std::string &name, const sf::Image &sheet);
 };
 } // namespace hollow_lantern
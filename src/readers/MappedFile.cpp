@@ -0,0 +1,110 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Implementation of the MappedFile class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "MappedFile.h"
+#include <fstream>
+#include <iostream>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define HOLLOW_LANTERN_HAS_MMAP 1
+#endif
+
+namespace hollow_lantern {
+
+/////////////////////////////////////////////////
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : data(std::exchange(other.data, nullptr)),
+      size(std::exchange(other.size, 0)),
+      fallback_buffer(std::move(other.fallback_buffer)) {}
+
+/////////////////////////////////////////////////
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this != &other) {
+    Close();
+    data = std::exchange(other.data, nullptr);
+    size = std::exchange(other.size, 0);
+    fallback_buffer = std::move(other.fallback_buffer);
+  }
+  return *this;
+}
+
+/////////////////////////////////////////////////
+MappedFile::~MappedFile() { Close(); }
+
+/////////////////////////////////////////////////
+bool MappedFile::Open(const std::filesystem::path &path) {
+  Close();
+
+#ifdef HOLLOW_LANTERN_HAS_MMAP
+  int file_descriptor = ::open(path.c_str(), O_RDONLY);
+  if (file_descriptor < 0) {
+    std::cerr << "[DEBUG] Could not open " << path << " for mapping."
+              << std::endl;
+    return false;
+  }
+  struct stat file_stats{};
+  if (::fstat(file_descriptor, &file_stats) != 0) {
+    ::close(file_descriptor);
+    return false;
+  }
+  const size_t file_size = static_cast<size_t>(file_stats.st_size);
+  if (file_size == 0) {
+    // mmap rejects empty files, an empty span describes them just as well
+    ::close(file_descriptor);
+    return true;
+  }
+  void *mapping =
+      ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+  // the mapping keeps its own reference to the file
+  ::close(file_descriptor);
+  if (mapping == MAP_FAILED) {
+    std::cerr << "[DEBUG] mmap failed for " << path << std::endl;
+    return false;
+  }
+  data = static_cast<const std::byte *>(mapping);
+  size = file_size;
+  return true;
+#else
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file) {
+    std::cerr << "[DEBUG] Could not open " << path << " for reading."
+              << std::endl;
+    return false;
+  }
+  fallback_buffer.resize(static_cast<size_t>(file.tellg()));
+  file.seekg(0, std::ios::beg);
+  file.read(reinterpret_cast<char *>(fallback_buffer.data()),
+            static_cast<std::streamsize>(fallback_buffer.size()));
+  if (!file) {
+    fallback_buffer.clear();
+    return false;
+  }
+  data = fallback_buffer.data();
+  size = fallback_buffer.size();
+  return true;
+#endif
+}
+
+/////////////////////////////////////////////////
+void MappedFile::Close() {
+#ifdef HOLLOW_LANTERN_HAS_MMAP
+  if (data != nullptr && fallback_buffer.empty()) {
+    ::munmap(const_cast<std::byte *>(data), size);
+  }
+#endif
+  fallback_buffer.clear();
+  data = nullptr;
+  size = 0;
+}
+
+} // namespace hollow_lantern
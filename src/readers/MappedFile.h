@@ -0,0 +1,78 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the MappedFile class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+namespace hollow_lantern {
+
+/////////////////////////////////////////////////
+/// @brief Read-only view of a whole file mapped into memory
+///
+/// Uses mmap where available, otherwise the file is read into a buffer owned
+/// by the MappedFile. Either way the bytes stay valid until Close() or
+/// destruction.
+/////////////////////////////////////////////////
+class MappedFile {
+
+private:
+  /////////////////////////////////////////////////
+  /// @brief Start of the mapping, nullptr when nothing is open
+  /////////////////////////////////////////////////
+  const std::byte *data{nullptr};
+
+  /////////////////////////////////////////////////
+  /// @brief Number of bytes in the mapping
+  /////////////////////////////////////////////////
+  size_t size{0};
+
+  /////////////////////////////////////////////////
+  /// @brief Holds the file contents on platforms without mmap
+  /////////////////////////////////////////////////
+  std::vector<std::byte> fallback_buffer;
+
+public:
+  /////////////////////////////////////////////////
+  /// @brief Default constructor, nothing is mapped
+  /////////////////////////////////////////////////
+  MappedFile() = default;
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+
+  ~MappedFile();
+
+  /////////////////////////////////////////////////
+  /// @brief Map a file, closing anything already mapped
+  ///
+  /// @param path Path of the file to map
+  /// @return False if the file could not be opened or mapped
+  /////////////////////////////////////////////////
+  bool Open(const std::filesystem::path &path);
+
+  /////////////////////////////////////////////////
+  /// @brief Unmap the file
+  /////////////////////////////////////////////////
+  void Close();
+
+  /////////////////////////////////////////////////
+  /// @brief Bytes of the mapped file, empty if nothing is open
+  /////////////////////////////////////////////////
+  std::span<const std::byte> Bytes() const { return {data, size}; };
+};
+
+} // namespace hollow_lantern
@@ -0,0 +1,307 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Implementation of the MeshCache class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "MeshCache.h"
+#include "MappedFile.h"
+#include <array>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+namespace hollow_lantern {
+
+namespace {
+
+constexpr std::array<char, 4> cache_magic{'H', 'L', 'M', 'C'};
+constexpr uint64_t fnv_offset_basis{14695981039346656037ull};
+constexpr uint64_t fnv_prime{1099511628211ull};
+
+/////////////////////////////////////////////////
+/// @brief Fold raw bytes into an FNV-1a hash
+/////////////////////////////////////////////////
+uint64_t HashBytes(uint64_t hash, std::span<const std::byte> bytes) {
+  for (std::byte byte : bytes) {
+    hash ^= static_cast<uint64_t>(byte);
+    hash *= fnv_prime;
+  }
+  return hash;
+}
+
+/////////////////////////////////////////////////
+/// @brief Fold a trivially copyable value into an FNV-1a hash
+/////////////////////////////////////////////////
+template <typename T> uint64_t HashValue(uint64_t hash, const T &value) {
+  static_assert(std::is_trivially_copyable_v<T>);
+  return HashBytes(hash, std::as_bytes(std::span{&value, 1}));
+}
+
+/////////////////////////////////////////////////
+/// @brief Append a trivially copyable value to a byte buffer
+/////////////////////////////////////////////////
+template <typename T>
+void AppendValue(std::vector<std::byte> &buffer, const T &value) {
+  static_assert(std::is_trivially_copyable_v<T>);
+  const size_t offset = buffer.size();
+  buffer.resize(offset + sizeof(T));
+  std::memcpy(buffer.data() + offset, &value, sizeof(T));
+}
+
+/////////////////////////////////////////////////
+/// @brief Bounds-checked cursor over the bytes of a cache entry
+/////////////////////////////////////////////////
+struct ByteCursor {
+  std::span<const std::byte> bytes;
+  size_t offset{0};
+
+  bool CanRead(size_t count) const { return bytes.size() - offset >= count; }
+
+  template <typename T> bool Read(T &value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    if (!CanRead(sizeof(T))) {
+      return false;
+    }
+    std::memcpy(&value, bytes.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return true;
+  }
+};
+
+/////////////////////////////////////////////////
+/// @brief Fixed-size on-disk form of a Triangle
+/////////////////////////////////////////////////
+struct TriangleRecord {
+  std::array<float, 9> vertices;
+  std::array<float, 6> tex_coords;
+  std::array<uint8_t, 4> color;
+  uint32_t direction;
+};
+static_assert(std::is_trivially_copyable_v<TriangleRecord>);
+
+} // namespace
+
+/////////////////////////////////////////////////
+MeshCache::MeshCache(std::filesystem::path cache_folder)
+    : cache_folder(std::move(cache_folder)) {}
+
+/////////////////////////////////////////////////
+std::optional<uint64_t>
+MeshCache::HashSource(const std::filesystem::path &vox_path,
+                      const MeshingOptions &meshing_options) const {
+  MappedFile vox_file;
+  if (!vox_file.Open(vox_path)) {
+    return std::nullopt;
+  }
+  uint64_t hash = HashBytes(fnv_offset_basis, vox_file.Bytes());
+  hash = HashValue(hash, static_cast<int32_t>(meshing_options.mode));
+  hash = HashValue(hash, meshing_options.color_tolerance);
+  hash = HashValue(hash, format_version);
+  return hash;
+}
+
+/////////////////////////////////////////////////
+std::filesystem::path
+MeshCache::ProvideEntryPath(const std::string &model_name,
+                            uint64_t hash) const {
+  return cache_folder / std::format("{}_{:016x}.hlmesh", model_name, hash);
+}
+
+/////////////////////////////////////////////////
+std::optional<ModelData>
+MeshCache::ProvideMeshedModel(const std::string &model_name,
+                              const MeshingOptions &meshing_options,
+                              bool testing) const {
+  std::optional<uint64_t> hash =
+      HashSource(vox_reader.ProvideVoxPath(model_name, testing),
+                 meshing_options);
+  if (!hash) {
+    return std::nullopt;
+  }
+
+  std::filesystem::path entry_path = ProvideEntryPath(model_name, *hash);
+  if (!std::filesystem::exists(entry_path)) {
+    std::cout << "[DEBUG] Mesh cache miss for " << model_name << std::endl;
+    return std::nullopt;
+  }
+
+  MappedFile entry;
+  if (!entry.Open(entry_path)) {
+    return std::nullopt;
+  }
+  std::optional<ModelData> model_data = Deserialize(entry.Bytes(), *hash);
+  if (!model_data) {
+    std::cerr << "[DEBUG] Ignoring malformed cache entry " << entry_path
+              << std::endl;
+    return std::nullopt;
+  }
+  std::cout << "[DEBUG] Mesh cache hit for " << model_name << " with "
+            << model_data->triangles.size() << " triangles." << std::endl;
+  return model_data;
+}
+
+/////////////////////////////////////////////////
+std::optional<ModelData>
+MeshCache::Deserialize(std::span<const std::byte> bytes, uint64_t hash) const {
+  ByteCursor cursor{bytes};
+
+  std::array<char, 4> magic{};
+  uint32_t version{0};
+  uint64_t stored_hash{0};
+  if (!cursor.Read(magic) || magic != cache_magic || !cursor.Read(version) ||
+      version != format_version || !cursor.Read(stored_hash) ||
+      stored_hash != hash) {
+    return std::nullopt;
+  }
+
+  ModelData model_data;
+  uint32_t name_length{0};
+  uint64_t triangle_count{0};
+  if (!cursor.Read(model_data.size) || !cursor.Read(model_data.voxel_scale) ||
+      !cursor.Read(model_data.color_atlas.size) ||
+      !cursor.Read(triangle_count) || !cursor.Read(name_length) ||
+      !cursor.CanRead(name_length)) {
+    return std::nullopt;
+  }
+  model_data.name.assign(
+      reinterpret_cast<const char *>(bytes.data() + cursor.offset),
+      name_length);
+  cursor.offset += name_length;
+
+  // check the payload sizes up front so a truncated entry cannot trigger a
+  // huge allocation
+  const uint64_t pixel_count = static_cast<uint64_t>(
+                                   model_data.color_atlas.size.x) *
+                               model_data.color_atlas.size.y;
+  const uint64_t remaining = cursor.bytes.size() - cursor.offset;
+  if (triangle_count > remaining / sizeof(TriangleRecord) ||
+      pixel_count > remaining / 4 ||
+      !cursor.CanRead(triangle_count * sizeof(TriangleRecord) +
+                      pixel_count * 4)) {
+    return std::nullopt;
+  }
+
+  model_data.triangles.resize(triangle_count);
+  for (Triangle &triangle : model_data.triangles) {
+    TriangleRecord record;
+    cursor.Read(record);
+    for (size_t i = 0; i < 3; ++i) {
+      triangle.vertices[i] = {record.vertices[i * 3],
+                              record.vertices[i * 3 + 1],
+                              record.vertices[i * 3 + 2]};
+      triangle.tex_coords[i] = {record.tex_coords[i * 2],
+                                record.tex_coords[i * 2 + 1]};
+    }
+    triangle.color = sf::Color(record.color[0], record.color[1],
+                               record.color[2], record.color[3]);
+    // directions index the per-direction masks and facing flags
+    if (record.direction > static_cast<uint32_t>(Direction::Z_NEGATIVE))
+      return std::nullopt;
+    triangle.direction = static_cast<Direction>(record.direction);
+  }
+
+  model_data.color_atlas.pixels.resize(pixel_count);
+  for (sf::Color &pixel : model_data.color_atlas.pixels) {
+    std::array<uint8_t, 4> rgba;
+    cursor.Read(rgba);
+    pixel = sf::Color(rgba[0], rgba[1], rgba[2], rgba[3]);
+  }
+
+  return model_data;
+}
+
+/////////////////////////////////////////////////
+void MeshCache::StoreMeshedModel(const ModelData &model_data,
+                                 const MeshingOptions &meshing_options,
+                                 bool testing) const {
+  std::optional<uint64_t> hash =
+      HashSource(vox_reader.ProvideVoxPath(model_data.name, testing),
+                 meshing_options);
+  if (!hash) {
+    throw std::runtime_error("Cannot cache model without a source file: " +
+                             model_data.name);
+  }
+
+  std::vector<std::byte> buffer;
+  buffer.reserve(64 + model_data.name.size() +
+                 model_data.triangles.size() * sizeof(TriangleRecord) +
+                 model_data.color_atlas.pixels.size() * 4);
+  AppendValue(buffer, cache_magic);
+  AppendValue(buffer, format_version);
+  AppendValue(buffer, *hash);
+  AppendValue(buffer, model_data.size);
+  AppendValue(buffer, model_data.voxel_scale);
+  AppendValue(buffer, model_data.color_atlas.size);
+  AppendValue(buffer, static_cast<uint64_t>(model_data.triangles.size()));
+  AppendValue(buffer, static_cast<uint32_t>(model_data.name.size()));
+  for (char character : model_data.name) {
+    AppendValue(buffer, character);
+  }
+
+  for (const Triangle &triangle : model_data.triangles) {
+    TriangleRecord record;
+    for (size_t i = 0; i < 3; ++i) {
+      record.vertices[i * 3] = triangle.vertices[i].x;
+      record.vertices[i * 3 + 1] = triangle.vertices[i].y;
+      record.vertices[i * 3 + 2] = triangle.vertices[i].z;
+      record.tex_coords[i * 2] = triangle.tex_coords[i].x;
+      record.tex_coords[i * 2 + 1] = triangle.tex_coords[i].y;
+    }
+    record.color = {triangle.color.r, triangle.color.g, triangle.color.b,
+                    triangle.color.a};
+    record.direction = static_cast<uint32_t>(triangle.direction);
+    AppendValue(buffer, record);
+  }
+
+  for (const sf::Color &pixel : model_data.color_atlas.pixels) {
+    AppendValue(buffer, std::array<uint8_t, 4>{pixel.r, pixel.g, pixel.b,
+                                               pixel.a});
+  }
+
+  std::filesystem::create_directories(cache_folder);
+
+  // entries are mapped on load, so write beside the entry and move it over
+  // rather than let a reader see it half written
+  std::filesystem::path entry_path = ProvideEntryPath(model_data.name, *hash);
+  std::filesystem::path temporary_path = entry_path;
+  temporary_path += ".tmp";
+  std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to open file for writing: " +
+                             temporary_path.string());
+  }
+  file.write(reinterpret_cast<const char *>(buffer.data()),
+             static_cast<std::streamsize>(buffer.size()));
+  file.close();
+  if (!file) {
+    throw std::runtime_error("Failed to write to file: " +
+                             temporary_path.string());
+  }
+  std::filesystem::rename(temporary_path, entry_path);
+
+  // entries for older versions of the model can never be hit again, the
+  // length check stops "knight" from removing the entries of "knight_big"
+  const std::string prefix = model_data.name + "_";
+  const size_t entry_name_length = prefix.size() + 16 + 7;
+  std::error_code error_code;
+  for (const auto &entry :
+       std::filesystem::directory_iterator(cache_folder, error_code)) {
+    const std::string file_name = entry.path().filename().string();
+    if (file_name.size() == entry_name_length &&
+        file_name.starts_with(prefix) && file_name.ends_with(".hlmesh") &&
+        entry.path() != entry_path) {
+      std::filesystem::remove(entry.path(), error_code);
+    }
+  }
+  std::cout << "[DEBUG] Stored mesh cache entry " << entry_path << std::endl;
+}
+
+} // namespace hollow_lantern
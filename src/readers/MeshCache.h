@@ -0,0 +1,116 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the MeshCache class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+
+#include "ModelData.h"
+#include "VoxReader.h"
+#include "directory_paths.h"
+
+namespace hollow_lantern {
+
+/////////////////////////////////////////////////
+/// @brief On-disk cache of meshed models
+///
+/// Entries hold the output of VoxManipulator::HollowAndMesh and are keyed on
+/// a hash of the .vox bytes and the MeshingOptions, so an edited model or a
+/// change of options is a miss rather than a stale hit. A cached ModelData
+/// carries the name, size, voxel_scale, triangles and color_atlas, which is
+/// everything the Projector needs; voxel_data, masks and chunks are left
+/// empty, so models that are edited must be read and meshed as usual.
+/////////////////////////////////////////////////
+class MeshCache {
+
+private:
+  /////////////////////////////////////////////////
+  /// @brief Folder the .hlmesh files live in
+  /////////////////////////////////////////////////
+  std::filesystem::path cache_folder;
+
+  /////////////////////////////////////////////////
+  /// @brief Used to locate the .vox file behind a model name
+  /////////////////////////////////////////////////
+  VoxReader vox_reader;
+
+  /////////////////////////////////////////////////
+  /// @brief Hash the bytes of a .vox file together with the meshing options
+  ///
+  /// @param vox_path Path of the .vox file
+  /// @param meshing_options Options the model is meshed with
+  /// @return FNV-1a hash, or nullopt if the .vox file could not be read
+  /////////////////////////////////////////////////
+  std::optional<uint64_t>
+  HashSource(const std::filesystem::path &vox_path,
+             const MeshingOptions &meshing_options) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Path of the cache entry for a model and hash
+  /////////////////////////////////////////////////
+  std::filesystem::path ProvideEntryPath(const std::string &model_name,
+                                         uint64_t hash) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Rebuild a ModelData from the bytes of a cache entry
+  ///
+  /// @param bytes Contents of the .hlmesh file
+  /// @param hash Hash the entry is expected to carry
+  /// @return The cached model, or nullopt if the entry is malformed
+  /////////////////////////////////////////////////
+  std::optional<ModelData> Deserialize(std::span<const std::byte> bytes,
+                                       uint64_t hash) const;
+
+public:
+  /////////////////////////////////////////////////
+  /// @brief Version of the .hlmesh layout, bump whenever it or the meshing
+  /// output changes so old entries stop matching
+  /////////////////////////////////////////////////
+  static constexpr uint32_t format_version{1};
+
+  /////////////////////////////////////////////////
+  /// @brief Construct a MeshCache
+  ///
+  /// @param cache_folder Folder to keep entries in, created on first store
+  /////////////////////////////////////////////////
+  explicit MeshCache(std::filesystem::path cache_folder =
+                         config::getCacheFolder());
+
+  /////////////////////////////////////////////////
+  /// @brief Look up a meshed model
+  ///
+  /// @param model_name name of the .vox file without extension
+  /// @param meshing_options Options the model would be meshed with
+  /// @param testing look for the .vox file in the test data folder instead
+  /// @return The meshed model, or nullopt on a miss
+  /////////////////////////////////////////////////
+  std::optional<ModelData>
+  ProvideMeshedModel(const std::string &model_name,
+                     const MeshingOptions &meshing_options,
+                     bool testing = false) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Store a meshed model, replacing older entries for the same name
+  ///
+  /// @param model_data Model after VoxManipulator::HollowAndMesh
+  /// @param meshing_options Options the model was meshed with
+  /// @param testing the .vox file lives in the test data folder
+  /////////////////////////////////////////////////
+  void StoreMeshedModel(const ModelData &model_data,
+                        const MeshingOptions &meshing_options,
+                        bool testing = false) const;
+};
+
+} // namespace hollow_lantern
@@ -0,0 +1,278 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Implementation of the ViewFile class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "ViewFile.h"
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace hollow_lantern {
+
+namespace {
+
+constexpr std::array<char, 4> view_file_magic{'H', 'L', 'V', 'W'};
+
+/////////////////////////////////////////////////
+/// @brief Reads back as another value when the byte order differs
+/////////////////////////////////////////////////
+constexpr uint32_t byte_order_mark{0x01020304};
+
+/////////////////////////////////////////////////
+/// @brief Alignment of the position and colour arrays within the file
+/////////////////////////////////////////////////
+constexpr uint64_t array_alignment{16};
+
+/////////////////////////////////////////////////
+/// @brief Fixed-size start of every .hlviews file
+/////////////////////////////////////////////////
+struct FileHeader {
+  std::array<char, 4> magic;
+  uint32_t version;
+  uint32_t byte_order;
+  uint32_t view_count;
+  uint64_t vertex_count;
+  uint32_t name_length;
+  uint32_t reserved;
+  uint64_t positions_offset;
+  uint64_t colors_offset;
+};
+static_assert(std::is_trivially_copyable_v<FileHeader>);
+
+// the arrays are handed out as spans of these types, so they must be packed
+static_assert(sizeof(sf::Vector2f) == 2 * sizeof(float) &&
+              std::is_standard_layout_v<sf::Vector2f>);
+static_assert(sizeof(sf::Color) == 4 && std::is_standard_layout_v<sf::Color>);
+
+/////////////////////////////////////////////////
+/// @brief Round an offset up to the next array boundary
+/////////////////////////////////////////////////
+uint64_t AlignOffset(uint64_t offset) {
+  return (offset + array_alignment - 1) / array_alignment * array_alignment;
+}
+
+/////////////////////////////////////////////////
+/// @brief Write the raw bytes of a range of trivially copyable values
+/////////////////////////////////////////////////
+template <typename T>
+void WriteValues(std::ofstream &file, std::span<T> values) {
+  static_assert(std::is_trivially_copyable_v<T>);
+  file.write(reinterpret_cast<const char *>(values.data()),
+             static_cast<std::streamsize>(values.size_bytes()));
+}
+
+/////////////////////////////////////////////////
+/// @brief Pad the file with zeros up to an offset
+/////////////////////////////////////////////////
+void WritePadding(std::ofstream &file, uint64_t from, uint64_t to) {
+  const std::array<char, array_alignment> zeros{};
+  file.write(zeros.data(), static_cast<std::streamsize>(to - from));
+}
+
+} // namespace
+
+/////////////////////////////////////////////////
+void ViewFile::Write(const std::filesystem::path &path,
+                     const std::string &model_name,
+                     const std::vector<sf::VertexArray> &projections) {
+  FileHeader header{};
+  header.magic = view_file_magic;
+  header.version = format_version;
+  header.byte_order = byte_order_mark;
+  header.view_count = static_cast<uint32_t>(projections.size());
+  header.name_length = static_cast<uint32_t>(model_name.size());
+
+  std::vector<ViewRecord> records;
+  records.reserve(projections.size());
+  for (const sf::VertexArray &projection : projections) {
+    records.push_back({static_cast<uint32_t>(projection.getPrimitiveType()),
+                       0, header.vertex_count,
+                       projection.getVertexCount()});
+    header.vertex_count += projection.getVertexCount();
+  }
+
+  const uint64_t name_end = sizeof(FileHeader) +
+                            records.size() * sizeof(ViewRecord) +
+                            model_name.size();
+  header.positions_offset = AlignOffset(name_end);
+  const uint64_t positions_end =
+      header.positions_offset + header.vertex_count * sizeof(sf::Vector2f);
+  header.colors_offset = AlignOffset(positions_end);
+
+  // write beside the target and move it over, so a reader mapping the old
+  // file never sees it truncated under it
+  std::filesystem::create_directories(path.parent_path());
+  std::filesystem::path temporary_path = path;
+  temporary_path += ".tmp";
+  std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to open file for writing: " +
+                             temporary_path.string());
+  }
+
+  WriteValues(file, std::span{&header, 1});
+  WriteValues(file, std::span<const ViewRecord>{records});
+  file.write(model_name.data(),
+             static_cast<std::streamsize>(model_name.size()));
+  WritePadding(file, name_end, header.positions_offset);
+
+  // vertices interleave position and colour, so each view is split into the
+  // two arrays one at a time
+  std::vector<sf::Vector2f> view_positions;
+  for (const sf::VertexArray &projection : projections) {
+    view_positions.resize(projection.getVertexCount());
+    for (size_t i = 0; i < projection.getVertexCount(); ++i)
+      view_positions[i] = projection[i].position;
+    WriteValues(file, std::span<const sf::Vector2f>{view_positions});
+  }
+  WritePadding(file, positions_end, header.colors_offset);
+
+  std::vector<sf::Color> view_colors;
+  for (const sf::VertexArray &projection : projections) {
+    view_colors.resize(projection.getVertexCount());
+    for (size_t i = 0; i < projection.getVertexCount(); ++i)
+      view_colors[i] = projection[i].color;
+    WriteValues(file, std::span<const sf::Color>{view_colors});
+  }
+
+  file.close();
+  if (!file) {
+    throw std::runtime_error("Failed to write to file: " +
+                             temporary_path.string());
+  }
+  std::filesystem::rename(temporary_path, path);
+  std::cout << "[DEBUG] Wrote " << projections.size() << " views with "
+            << header.vertex_count << " vertices to " << path << std::endl;
+}
+
+/////////////////////////////////////////////////
+bool ViewFile::Open(const std::filesystem::path &path) {
+  Close();
+  if (!file.Open(path)) {
+    return false;
+  }
+  if (!Validate()) {
+    std::cerr << "[DEBUG] Ignoring malformed view file " << path << std::endl;
+    Close();
+    return false;
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////
+void ViewFile::Close() {
+  file.Close();
+  name = {};
+  views = {};
+  positions = {};
+  colors = {};
+}
+
+/////////////////////////////////////////////////
+bool ViewFile::Validate() {
+  const std::span<const std::byte> bytes = file.Bytes();
+  FileHeader header;
+  if (bytes.size() < sizeof(FileHeader)) {
+    return false;
+  }
+  std::memcpy(&header, bytes.data(), sizeof(FileHeader));
+  if (header.magic != view_file_magic ||
+      header.byte_order != byte_order_mark ||
+      header.version != format_version) {
+    return false;
+  }
+
+  // the table and arrays are used in place, so the mapping has to be
+  // aligned for them, which mmap and operator new both guarantee
+  if (reinterpret_cast<uintptr_t>(bytes.data()) % alignof(ViewRecord) != 0) {
+    return false;
+  }
+
+  // check every size against what is left of the file before multiplying,
+  // so a corrupt count cannot overflow past the checks
+  const uint64_t size = bytes.size();
+  const uint64_t table_offset = sizeof(FileHeader);
+  if (header.view_count > (size - table_offset) / sizeof(ViewRecord)) {
+    return false;
+  }
+  const uint64_t name_offset =
+      table_offset + uint64_t{header.view_count} * sizeof(ViewRecord);
+  if (header.name_length > size - name_offset ||
+      header.positions_offset < name_offset + header.name_length ||
+      header.positions_offset % array_alignment != 0 ||
+      header.positions_offset > size ||
+      header.vertex_count >
+          (size - header.positions_offset) / sizeof(sf::Vector2f)) {
+    return false;
+  }
+  const uint64_t positions_end =
+      header.positions_offset + header.vertex_count * sizeof(sf::Vector2f);
+  if (header.colors_offset < positions_end ||
+      header.colors_offset % array_alignment != 0 ||
+      header.colors_offset > size ||
+      header.vertex_count > (size - header.colors_offset) / sizeof(sf::Color)) {
+    return false;
+  }
+
+  const std::span<const ViewRecord> records(
+      reinterpret_cast<const ViewRecord *>(bytes.data() + table_offset),
+      header.view_count);
+  for (const ViewRecord &record : records) {
+    if (record.primitive_type >
+            static_cast<uint32_t>(sf::PrimitiveType::TriangleFan) ||
+        record.first_vertex > header.vertex_count ||
+        record.vertex_count > header.vertex_count - record.first_vertex) {
+      return false;
+    }
+  }
+
+  views = records;
+  name = std::string_view(
+      reinterpret_cast<const char *>(bytes.data() + name_offset),
+      header.name_length);
+  positions = std::span<const sf::Vector2f>(
+      reinterpret_cast<const sf::Vector2f *>(bytes.data() +
+                                             header.positions_offset),
+      header.vertex_count);
+  colors = std::span<const sf::Color>(
+      reinterpret_cast<const sf::Color *>(bytes.data() + header.colors_offset),
+      header.vertex_count);
+  return true;
+}
+
+/////////////////////////////////////////////////
+sf::PrimitiveType ViewFile::PrimitiveType(size_t view) const {
+  return static_cast<sf::PrimitiveType>(views[view].primitive_type);
+}
+
+/////////////////////////////////////////////////
+std::span<const sf::Vector2f> ViewFile::Positions(size_t view) const {
+  return positions.subspan(views[view].first_vertex,
+                           views[view].vertex_count);
+}
+
+/////////////////////////////////////////////////
+std::span<const sf::Color> ViewFile::Colors(size_t view) const {
+  return colors.subspan(views[view].first_vertex, views[view].vertex_count);
+}
+
+/////////////////////////////////////////////////
+sf::VertexArray ViewFile::ProvideVertexArray(size_t view) const {
+  const std::span<const sf::Vector2f> view_positions = Positions(view);
+  const std::span<const sf::Color> view_colors = Colors(view);
+  sf::VertexArray vertex_array(PrimitiveType(view), view_positions.size());
+  for (size_t i = 0; i < view_positions.size(); ++i) {
+    vertex_array[i].position = view_positions[i];
+    vertex_array[i].color = view_colors[i];
+  }
+  return vertex_array;
+}
+
+} // namespace hollow_lantern
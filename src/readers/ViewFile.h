@@ -0,0 +1,153 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the ViewFile class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/PrimitiveType.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "MappedFile.h"
+
+namespace hollow_lantern {
+
+/////////////////////////////////////////////////
+/// @brief Projected views in a binary file that is used straight from memory
+///
+/// A .hlviews file holds a header, a table with the primitive type and
+/// vertex range of every view, the model name, then the positions of every
+/// vertex of every view as packed float pairs and their colours as packed
+/// RGBA bytes, each array starting on a 16 byte boundary. Opening a file
+/// maps it and checks the header and table against the file size, after
+/// which views are spans into the mapping: nothing is parsed or copied.
+///
+/// Values are in the byte order of the machine that wrote the file, files
+/// from a machine of the other order are rejected as malformed.
+/////////////////////////////////////////////////
+class ViewFile {
+
+private:
+  /////////////////////////////////////////////////
+  /// @brief Bytes of the open file
+  /////////////////////////////////////////////////
+  MappedFile file;
+
+  /////////////////////////////////////////////////
+  /// @brief Model name, points into the mapping
+  /////////////////////////////////////////////////
+  std::string_view name;
+
+  /////////////////////////////////////////////////
+  /// @brief Primitive type and vertex range of every view
+  /////////////////////////////////////////////////
+  struct ViewRecord {
+    uint32_t primitive_type;
+    uint32_t reserved;
+    uint64_t first_vertex;
+    uint64_t vertex_count;
+  };
+
+  /////////////////////////////////////////////////
+  /// @brief View table, points into the mapping
+  /////////////////////////////////////////////////
+  std::span<const ViewRecord> views;
+
+  /////////////////////////////////////////////////
+  /// @brief Positions of all views, points into the mapping
+  /////////////////////////////////////////////////
+  std::span<const sf::Vector2f> positions;
+
+  /////////////////////////////////////////////////
+  /// @brief Colours of all views, points into the mapping
+  /////////////////////////////////////////////////
+  std::span<const sf::Color> colors;
+
+  /////////////////////////////////////////////////
+  /// @brief Check the layout of a mapped file and point the spans into it
+  ///
+  /// @return False if the file is malformed or from another version
+  /////////////////////////////////////////////////
+  bool Validate();
+
+public:
+  /////////////////////////////////////////////////
+  /// @brief Version of the .hlviews layout, bump whenever it changes
+  /////////////////////////////////////////////////
+  static constexpr uint32_t format_version{1};
+
+  /////////////////////////////////////////////////
+  /// @brief Default constructor, nothing is open
+  /////////////////////////////////////////////////
+  ViewFile() = default;
+
+  /////////////////////////////////////////////////
+  /// @brief Write views to a .hlviews file
+  ///
+  /// @param path Path of the file, replaced if it exists
+  /// @param model_name Name stored in the file
+  /// @param projections Views to write, e.g. ModelData::projected_data
+  /////////////////////////////////////////////////
+  static void Write(const std::filesystem::path &path,
+                    const std::string &model_name,
+                    const std::vector<sf::VertexArray> &projections);
+
+  /////////////////////////////////////////////////
+  /// @brief Map a .hlviews file, closing anything already open
+  ///
+  /// @param path Path of the file
+  /// @return False if the file could not be mapped or is malformed
+  /////////////////////////////////////////////////
+  bool Open(const std::filesystem::path &path);
+
+  /////////////////////////////////////////////////
+  /// @brief Unmap the file, invalidating every span handed out
+  /////////////////////////////////////////////////
+  void Close();
+
+  /////////////////////////////////////////////////
+  /// @brief Name of the model the views were projected from
+  /////////////////////////////////////////////////
+  std::string_view Name() const { return name; };
+
+  /////////////////////////////////////////////////
+  /// @brief Number of views in the file, 0 if nothing is open
+  /////////////////////////////////////////////////
+  size_t ViewCount() const { return views.size(); };
+
+  /////////////////////////////////////////////////
+  /// @brief Primitive type a view is drawn with
+  /////////////////////////////////////////////////
+  sf::PrimitiveType PrimitiveType(size_t view) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Vertex positions of a view, valid until the file is closed
+  /////////////////////////////////////////////////
+  std::span<const sf::Vector2f> Positions(size_t view) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Vertex colours of a view, valid until the file is closed
+  /////////////////////////////////////////////////
+  std::span<const sf::Color> Colors(size_t view) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Copy a view into a vertex array, for drawing with SFML
+  /////////////////////////////////////////////////
+  sf::VertexArray ProvideVertexArray(size_t view) const;
+};
+
+} // namespace hollow_lantern
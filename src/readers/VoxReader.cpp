@@ -65,13 +65,7 @@ static const uint32_t default_palette[256] = {
 std::expected<ModelData, std::string>
 VoxReader::ProvideVoxData(std::string model_name, bool testing) {
   // create path to the model file
-  std::filesystem::path model_path;
-
-  if (testing) {
-    model_path = config::getTestDataFolder() / "vox" / (model_name + ".vox");
-  } else {
-    model_path = config::getDataFolder() / "vox" / (model_name + ".vox");
-  }
+  std::filesystem::path model_path = ProvideVoxPath(model_name, testing);
 
   if (!CheckVoxFileExists(model_path)) {
     std::cerr << "[DEBUG] File not found: " << model_path << std::endl;
@@ -140,10 +134,24 @@ VoxReader::ProvideVoxData(std::string model_name, bool testing) {
   }
   std::cout << "[DEBUG] Model size: " << model_data.size.x << "x"
             << model_data.size.y << "x" << model_data.size.z << std::endl;
+  const Bounds &occupied = model_data.occupancy.bounds;
+  std::cout << "[DEBUG] Occupied bounds: (" << occupied.min.x << ", "
+            << occupied.min.y << ", " << occupied.min.z << ") to ("
+            << occupied.max.x << ", " << occupied.max.y << ", "
+            << occupied.max.z << ")" << std::endl;
 
   return model_data;
 }
 
+/////////////////////////////////////////////////
+std::filesystem::path VoxReader::ProvideVoxPath(const std::string &model_name,
+                                                bool testing) const {
+  if (testing) {
+    return config::getTestDataFolder() / "vox" / (model_name + ".vox");
+  }
+  return config::getDataFolder() / "vox" / (model_name + ".vox");
+}
+
 /////////////////////////////////////////////////
 bool VoxReader::CheckVoxFileExists(
     const std::filesystem::path &model_path) const {
@@ -300,6 +308,7 @@ void VoxReader::ExtractVoxels(std::ifstream &file,
           model_data.voxel_data[i][j].resize(z);
         }
       }
+      model_data.occupancy.Reset(model_data.size);
       std::cout << "[DEBUG] Found SIZE chunk: " << x << "x" << y << "x" << z
                 << std::endl;
 
@@ -339,6 +348,9 @@ void VoxReader::ExtractVoxels(std::ifstream &file,
                   << std::dec << " to voxel at (" << x << ", " << y << ", " << z
                   << ")" << std::endl;
         model_data.voxel_data[x][y][z].color = color;
+        // a voxel listed twice must only be counted once
+        if (!model_data.voxel_data[x][y][z].is_visible)
+          model_data.occupancy.Add(x, y, z);
         std::cout << "assigning visible flag to voxel at (" << x << ", " << y
                   << ", " << z << ")" << std::endl;
         model_data.voxel_data[x][y][z].is_visible = true;
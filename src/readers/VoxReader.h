@@ -85,6 +85,16 @@ public:
   /////////////////////////////////////////////////
   VoxReader() = default;
 
+  /////////////////////////////////////////////////
+  /// @brief Provide the path of a Vox file from its model name
+  ///
+  /// @param model_name name of the file without extension
+  /// @param testing look in the test data folder instead
+  /// @return Path to the .vox file, which may not exist
+  /////////////////////////////////////////////////
+  std::filesystem::path ProvideVoxPath(const std::string &model_name,
+                                       bool testing = false) const;
+
   /////////////////////////////////////////////////
   /// @brief Provide a VoxData object from file
   ///
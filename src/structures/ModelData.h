@@ -16,8 +16,12 @@
 #include <SFML/Graphics.hpp>
 #include <SFML/Graphics/Color.hpp>
 #include <SFML/System/Vector3.hpp>
+#include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <vector>
@@ -34,6 +38,28 @@ enum class Direction {
   Z_NEGATIVE
 };
 
+enum class MeshingMode {
+  PER_VOXEL,   // two triangles per visible voxel face
+  GREEDY,      // coplanar faces merged into larger quads
+  GREEDY_ATLAS // coplanar faces merged regardless of colour, colours are
+               // looked up in ModelData::color_atlas
+};
+
+struct MeshingOptions {
+  /////////////////////////////////////////////////
+  /// @brief How faces from the masks are turned into triangles
+  /////////////////////////////////////////////////
+  MeshingMode mode{MeshingMode::PER_VOXEL};
+
+  /////////////////////////////////////////////////
+  /// @brief Largest colour distance merged into one greedy quad
+  ///
+  /// 0 only merges identical colours. Distances are "redmean" weighted RGB,
+  /// around 10 to 20 is hard to see on small sprites.
+  /////////////////////////////////////////////////
+  float color_tolerance{0.0f};
+};
+
 struct Voxel {
   /////////////////////////////////////////////////
   /// @brief Color of the voxel
@@ -84,12 +110,189 @@ struct Triangle {
   /////////////////////////////////////////////////
   Direction direction{Direction::NONE};
 
+  /////////////////////////////////////////////////
+  /// @brief Texel coordinates of each vertex in ModelData::color_atlas
+  ///
+  /// Only set by MeshingMode::GREEDY_ATLAS, color then holds the mean colour
+  /// of the quad as an untextured fallback
+  /////////////////////////////////////////////////
+  std::array<glm::vec2, 3> tex_coords{};
+
   Triangle() = default;
   Triangle(const glm::vec3 &v1, const glm::vec3 &v2, const glm::vec3 &v3,
            const sf::Color &col, Direction dir)
       : vertices{v1, v2, v3}, color(col), direction(dir) {};
 };
+/////////////////////////////////////////////////
+/// @brief Rectangle of texels in a ColorAtlas
+/////////////////////////////////////////////////
+struct AtlasSpace {
+  sf::Vector2u position{0, 0};
+  sf::Vector2u size{0, 0};
+};
+
+struct ColorAtlas {
+  /////////////////////////////////////////////////
+  /// @brief Width and height of the atlas in texels
+  /////////////////////////////////////////////////
+  sf::Vector2u size{0, 0};
+
+  /////////////////////////////////////////////////
+  /// @brief Row-major texels, one per voxel face covered by a quad
+  /////////////////////////////////////////////////
+  std::vector<sf::Color> pixels;
+
+  /////////////////////////////////////////////////
+  /// @brief Texels no tile covers, where Remesh packs the tiles of the
+  /// chunks it remeshes
+  ///
+  /// Spaces are split as tiles go in but never merged back together
+  /////////////////////////////////////////////////
+  std::vector<AtlasSpace> free_space;
+};
+
+/////////////////////////////////////////////////
+/// @brief Axis-aligned box of voxel positions
+///
+/// min is inclusive and max is exclusive, so a box covering a whole model is
+/// {0,0,0} to size
+/////////////////////////////////////////////////
+struct Bounds {
+  sf::Vector3i min{0, 0, 0};
+  sf::Vector3i max{0, 0, 0};
+
+  bool IsEmpty() const {
+    return min.x >= max.x || min.y >= max.y || min.z >= max.z;
+  };
+
+  bool Contains(int x, int y, int z) const {
+    return x >= min.x && x < max.x && y >= min.y && y < max.y && z >= min.z &&
+           z < max.z;
+  };
+};
+
+struct Chunk {
+  /////////////////////////////////////////////////
+  /// @brief Voxel positions covered by the chunk
+  /////////////////////////////////////////////////
+  Bounds bounds;
+
+  /////////////////////////////////////////////////
+  /// @brief Range of ModelData::triangles meshed from faces in this chunk
+  /////////////////////////////////////////////////
+  size_t triangle_offset{0};
+  size_t triangle_count{0};
+
+  /////////////////////////////////////////////////
+  /// @brief Set when an edit has invalidated the chunk's triangles
+  /////////////////////////////////////////////////
+  bool is_dirty{true};
+};
+
+struct Occupancy {
+  /////////////////////////////////////////////////
+  /// @brief Tight bounds of the visible voxels, empty if there are none
+  /////////////////////////////////////////////////
+  Bounds bounds;
+
+  /////////////////////////////////////////////////
+  /// @brief Visible voxels in each slice, indexed [axis][slice] with axis 0,
+  /// 1, 2 for x, y, z
+  /////////////////////////////////////////////////
+  std::array<std::vector<int>, 3> slice_counts;
+
+  /////////////////////////////////////////////////
+  /// @brief Visible voxels in each row, laid out like the mask dimensions:
+  /// [0][x][y] counts along z, [1][y][z] along x and [2][z][x] along y
+  /////////////////////////////////////////////////
+  std::array<std::vector<std::vector<int>>, 3> row_counts;
+
+  /////////////////////////////////////////////////
+  /// @brief Size the counts for a model and zero them
+  /////////////////////////////////////////////////
+  void Reset(const sf::Vector3i &size) {
+    bounds = Bounds{};
+    slice_counts = {std::vector<int>(size.x, 0), std::vector<int>(size.y, 0),
+                    std::vector<int>(size.z, 0)};
+    row_counts = {
+        std::vector<std::vector<int>>(size.x, std::vector<int>(size.y, 0)),
+        std::vector<std::vector<int>>(size.y, std::vector<int>(size.z, 0)),
+        std::vector<std::vector<int>>(size.z, std::vector<int>(size.x, 0))};
+  };
+
+  /////////////////////////////////////////////////
+  /// @brief Check the counts were sized for a model of this size
+  /////////////////////////////////////////////////
+  bool Matches(const sf::Vector3i &size) const {
+    return slice_counts[0].size() == static_cast<size_t>(size.x) &&
+           slice_counts[1].size() == static_cast<size_t>(size.y) &&
+           slice_counts[2].size() == static_cast<size_t>(size.z);
+  };
+
+  /////////////////////////////////////////////////
+  /// @brief Count a voxel that has just become visible
+  /////////////////////////////////////////////////
+  void Add(int x, int y, int z) {
+    ++slice_counts[0][x];
+    ++slice_counts[1][y];
+    ++slice_counts[2][z];
+    ++row_counts[0][x][y];
+    ++row_counts[1][y][z];
+    ++row_counts[2][z][x];
+    if (bounds.IsEmpty()) {
+      bounds = {{x, y, z}, {x + 1, y + 1, z + 1}};
+      return;
+    }
+    bounds.min = {std::min(bounds.min.x, x), std::min(bounds.min.y, y),
+                  std::min(bounds.min.z, z)};
+    bounds.max = {std::max(bounds.max.x, x + 1), std::max(bounds.max.y, y + 1),
+                  std::max(bounds.max.z, z + 1)};
+  };
+
+  /////////////////////////////////////////////////
+  /// @brief Uncount a voxel that has just been hidden
+  /////////////////////////////////////////////////
+  void Remove(int x, int y, int z) {
+    --slice_counts[0][x];
+    --slice_counts[1][y];
+    --slice_counts[2][z];
+    --row_counts[0][x][y];
+    --row_counts[1][y][z];
+    --row_counts[2][z][x];
+
+    // the bounds can only shrink if a slice on their edge is now empty
+    auto shrink = [](const std::vector<int> &counts, int &lower, int &upper) {
+      while (lower < upper && counts[lower] == 0)
+        ++lower;
+      while (upper > lower && counts[upper - 1] == 0)
+        --upper;
+    };
+    shrink(slice_counts[0], bounds.min.x, bounds.max.x);
+    shrink(slice_counts[1], bounds.min.y, bounds.max.y);
+    shrink(slice_counts[2], bounds.min.z, bounds.max.z);
+    if (bounds.IsEmpty())
+      bounds = Bounds{};
+  };
+};
+
+struct VoxelEdit {
+  /////////////////////////////////////////////////
+  /// @brief Position of the voxel to edit
+  /////////////////////////////////////////////////
+  sf::Vector3i position{0, 0, 0};
+
+  /////////////////////////////////////////////////
+  /// @brief New colour of the voxel, std::nullopt clears the voxel
+  /////////////////////////////////////////////////
+  std::optional<sf::Color> color;
+};
+
 struct ModelData {
+  /////////////////////////////////////////////////
+  /// @brief Edge length (in voxels) of the chunks the mesh is split into
+  /////////////////////////////////////////////////
+  static constexpr int chunk_size{16};
+
   /////////////////////////////////////////////////
   /// @brief Name of the Vox model, taken from the filename
   /////////////////////////////////////////////////
@@ -100,13 +303,59 @@ struct ModelData {
   /////////////////////////////////////////////////
   sf::Vector3i size{0, 0, 0};
 
+  /////////////////////////////////////////////////
+  /// @brief Edge length of one voxel in units of the source model
+  ///
+  /// 1 for models read from file, 2, 4, 8... for downsampled levels of detail
+  /////////////////////////////////////////////////
+  int voxel_scale{1};
+
+  /////////////////////////////////////////////////
+  /// @brief Position of voxel (0,0,0) in the model this one was cropped from
+  /////////////////////////////////////////////////
+  sf::Vector3i origin{0, 0, 0};
+
   std::vector<std::vector<std::vector<Voxel>>> voxel_data;
 
+  /////////////////////////////////////////////////
+  /// @brief Where the visible voxels are, so loops can skip empty space
+  ///
+  /// Recorded by VoxReader and kept up to date by VoxManipulator's edits.
+  /////////////////////////////////////////////////
+  Occupancy occupancy;
+
+  /////////////////////////////////////////////////
+  /// @brief Marks empty cells connected to the space around the model
+  ///
+  /// Empty cells that are not exterior are sealed cavities, their faces can
+  /// never be seen from outside so they are left out of the masks. Kept up
+  /// to date by VoxManipulator::SetVoxel and VoxManipulator::ClearVoxel.
+  /////////////////////////////////////////////////
+  std::vector<std::vector<std::vector<bool>>> exterior_air;
+
   /////////////////////////////////////////////////
   /// @brief point data for the model in 2D space
   /////////////////////////////////////////////////
   std::vector<sf::VertexArray> projected_data;
 
+  /////////////////////////////////////////////////
+  /// @brief Index into triangles of the face behind each projected triangle
+  ///
+  /// One list per view of projected_data, with an entry for every triangle
+  /// of a strip, joins included. A list is empty when the view's triangles
+  /// did not come straight from this mesh, e.g. merged regions.
+  /////////////////////////////////////////////////
+  std::vector<std::vector<uint32_t>> projected_sources;
+
+  /////////////////////////////////////////////////
+  /// @brief Depth of every vertex of each view, smaller is nearer
+  ///
+  /// One list per view of projected_data, lined up with its vertices. A list
+  /// is empty when ProjectionOptions::keep_depth was off or the view's
+  /// triangles cannot overlap, e.g. merged regions or front layers.
+  /////////////////////////////////////////////////
+  std::vector<std::vector<float>> projected_depths;
+
   std::vector<sf::VertexArray> triangle_data;
 
   std::array<Mask, 6> masks{
@@ -115,5 +364,62 @@ struct ModelData {
       Mask(Direction::Z_POSITIVE), Mask(Direction::Z_NEGATIVE)};
 
   std::vector<Triangle> triangles;
+
+  /////////////////////////////////////////////////
+  /// @brief Colour tiles of every quad when meshed with GREEDY_ATLAS
+  /////////////////////////////////////////////////
+  ColorAtlas color_atlas;
+
+  /////////////////////////////////////////////////
+  /// @brief Number of chunks along each axis
+  /////////////////////////////////////////////////
+  sf::Vector3i chunk_count{0, 0, 0};
+
+  /////////////////////////////////////////////////
+  /// @brief Chunks of the model, indexed [x][y][z] flattened like voxel_data
+  /////////////////////////////////////////////////
+  std::vector<Chunk> chunks;
+
+  /////////////////////////////////////////////////
+  /// @brief Downsampled copies of the model, each half the resolution of the
+  /// one before it
+  /////////////////////////////////////////////////
+  std::vector<ModelData> levels_of_detail;
+};
+
+/////////////////////////////////////////////////
+/// @brief Read-only window onto an axis-aligned box of a model's voxels
+///
+/// Positions are local to the box, so (0,0,0) is bounds.min of the model.
+/// Nothing is copied, the model must outlive the view.
+/////////////////////////////////////////////////
+struct ModelView {
+  const ModelData *model{nullptr};
+  Bounds bounds;
+
+  explicit ModelView(const ModelData &model_data)
+      : model(&model_data), bounds{{0, 0, 0}, model_data.size} {};
+
+  /////////////////////////////////////////////////
+  /// @brief View part of a model, the box is clamped to the model's size
+  /////////////////////////////////////////////////
+  ModelView(const ModelData &model_data, const Bounds &box)
+      : model(&model_data),
+        bounds{{std::clamp(box.min.x, 0, model_data.size.x),
+                std::clamp(box.min.y, 0, model_data.size.y),
+                std::clamp(box.min.z, 0, model_data.size.z)},
+               {std::clamp(box.max.x, 0, model_data.size.x),
+                std::clamp(box.max.y, 0, model_data.size.y),
+                std::clamp(box.max.z, 0, model_data.size.z)}} {
+    if (bounds.IsEmpty())
+      bounds.max = bounds.min;
+  };
+
+  sf::Vector3i Size() const { return bounds.max - bounds.min; };
+
+  const Voxel &At(int x, int y, int z) const {
+    return model->voxel_data[x + bounds.min.x][y + bounds.min.y]
+                            [z + bounds.min.z];
+  };
 };
 } // namespace hollow_lantern
@@ -18,4 +18,5 @@ TEST_CASE("Test directory paths in configuration",
   REQUIRE(config::getSchemaFolder().string() != "@data_path@/schema");
   REQUIRE(config::getTestDataFolder().string() != "");
   REQUIRE(config::getTestDataFolder().string() != "@data_path@/test_data");
+  REQUIRE(config::getCacheFolder().parent_path() == config::getDataFolder());
 }
@@ -0,0 +1,37 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Unit tests for the ParallelFor helper
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "ParallelFor.h"
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <stdexcept>
+#include <vector>
+
+TEST_CASE("ParallelFor runs every index exactly once", "[ParallelFor]") {
+  std::vector<std::atomic<int>> runs(1000);
+  hollow_lantern::ParallelFor(runs.size(), 4,
+                              [&](size_t idx) { runs[idx].fetch_add(1); });
+  for (const auto &count : runs) {
+    REQUIRE(count.load() == 1);
+  }
+
+  // nothing to do is fine, as is a single thread
+  hollow_lantern::ParallelFor(0, 0, [](size_t) { FAIL("no indices"); });
+  std::vector<size_t> order;
+  hollow_lantern::ParallelFor(3, 1, [&](size_t idx) { order.push_back(idx); });
+  REQUIRE(order == std::vector<size_t>{0, 1, 2});
+}
+
+TEST_CASE("ParallelFor rethrows exceptions from the body", "[ParallelFor]") {
+  auto body = [](size_t idx) {
+    if (idx == 42)
+      throw std::runtime_error("bad view");
+  };
+  REQUIRE_THROWS_AS(hollow_lantern::ParallelFor(100, 4, body),
+                    std::runtime_error);
+}
@@ -0,0 +1,144 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Unit tests for the ProjectionIndex class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "ProjectionIndex.h"
+#include "Projector.h"
+#include "TestViews.h"
+#include "VoxManipulator.h"
+#include <SFML/Graphics/VertexArray.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <set>
+#include <tuple>
+#include <vector>
+
+using hollow_lantern::testing::AppendRectangle;
+
+TEST_CASE("ProjectionIndex picks the triangle drawn on top",
+          "[ProjectionIndex]") {
+  // blue drawn first, red drawn over its right half
+  sf::VertexArray view(sf::PrimitiveType::Triangles);
+  AppendRectangle(view, 0.0f, 0.0f, 4.0f, 2.0f, sf::Color::Blue);
+  AppendRectangle(view, 2.0f, 0.0f, 2.0f, 2.0f, sf::Color::Red);
+  const hollow_lantern::ProjectionIndex index(view, {10, 11, 12, 13});
+  REQUIRE(index.Size() == 4);
+
+  const auto blue = index.Pick({1.0f, 1.5f});
+  REQUIRE(blue.has_value());
+  REQUIRE(blue->triangle < 2);
+  REQUIRE(blue->source == 10 + blue->triangle);
+
+  const auto red = index.Pick({3.0f, 0.5f});
+  REQUIRE(red.has_value());
+  REQUIRE(red->triangle >= 2);
+  REQUIRE(view[red->triangle * 3].color == sf::Color::Red);
+
+  REQUIRE_FALSE(index.Pick({5.0f, 1.0f}).has_value());
+  REQUIRE_FALSE(index.Pick({1.0f, -0.5f}).has_value());
+}
+
+TEST_CASE("ProjectionIndex finds triangles overlapping a rectangle",
+          "[ProjectionIndex]") {
+  // a row of eight unit squares
+  sf::VertexArray view(sf::PrimitiveType::Triangles);
+  for (int x = 0; x < 8; ++x)
+    AppendRectangle(view, static_cast<float>(x), 0.0f, 1.0f, 1.0f,
+                    sf::Color::Green);
+  const hollow_lantern::ProjectionIndex index(view);
+
+  // inside the third square only
+  REQUIRE(index.Query(sf::FloatRect({2.25f, 0.25f}, {0.5f, 0.5f})) ==
+          std::vector<size_t>{4, 5});
+  // spanning the fourth and fifth squares, in draw order
+  REQUIRE(index.Query(sf::FloatRect({3.5f, 0.25f}, {1.0f, 0.5f})) ==
+          std::vector<size_t>{6, 7, 8, 9});
+  // the bottom left corner of a square only touches its lower triangle
+  REQUIRE(index.Query(sf::FloatRect({0.0f, 0.9f}, {0.05f, 0.05f})) ==
+          std::vector<size_t>{1});
+  REQUIRE(index.Query(sf::FloatRect({0.0f, 2.0f}, {8.0f, 1.0f})).empty());
+}
+
+TEST_CASE("ProjectionIndex picks voxels of a projected model",
+          "[ProjectionIndex]") {
+  // a red voxel in front of a blue one, and a green one off to the side
+  hollow_lantern::ModelData model_data;
+  model_data.size = {2, 1, 4};
+  model_data.voxel_data.assign(
+      2, std::vector<std::vector<hollow_lantern::Voxel>>(
+             1, std::vector<hollow_lantern::Voxel>(4)));
+  model_data.voxel_data[0][0][0] = {sf::Color::Red, true};
+  model_data.voxel_data[0][0][2] = {sf::Color::Blue, true};
+  model_data.voxel_data[1][0][3] = {sf::Color::Green, true};
+  hollow_lantern::VoxManipulator().HollowAndMesh(model_data);
+
+  hollow_lantern::ProjectionOptions options;
+  options.remove_hidden_surfaces = true;
+  hollow_lantern::Projector(options).BasicProjection(
+      model_data, {0.0f, 0.0f, 0.0f}, 1, {0.0f, 1.0f, 0.0f});
+  REQUIRE(model_data.projected_sources.size() == 1);
+  REQUIRE(model_data.projected_sources[0].size() ==
+          model_data.projected_data[0].getVertexCount() / 3);
+
+  // the view is centred on the model, the left column is x = 0
+  const hollow_lantern::ProjectionIndex index(model_data.projected_data[0],
+                                              model_data.projected_sources[0]);
+  REQUIRE(index.PickVoxel(model_data.triangles, {-0.5f, 0.0f}) ==
+          sf::Vector3i(0, 0, 0));
+  REQUIRE(index.PickVoxel(model_data.triangles, {0.5f, 0.25f}) ==
+          sf::Vector3i(1, 0, 3));
+  REQUIRE_FALSE(
+      index.PickVoxel(model_data.triangles, {0.5f, 2.0f}).has_value());
+}
+
+TEST_CASE("ProjectionIndex picks voxels through triangle strips",
+          "[ProjectionIndex]") {
+  // a 4 by 3 wall, greedy meshed so each side is one quad of many voxels
+  hollow_lantern::ModelData model_data;
+  model_data.size = {4, 3, 1};
+  model_data.voxel_data.assign(
+      4, std::vector<std::vector<hollow_lantern::Voxel>>(
+             3, std::vector<hollow_lantern::Voxel>(1, {sf::Color::Red, true})));
+  hollow_lantern::MeshingOptions greedy;
+  greedy.mode = hollow_lantern::MeshingMode::GREEDY;
+  hollow_lantern::VoxManipulator(greedy).HollowAndMesh(model_data);
+
+  // four views round the wall as lists, then the same four as strips
+  hollow_lantern::ProjectionOptions options;
+  hollow_lantern::Projector(options).BasicProjection(
+      model_data, {0.0f, 0.0f, 0.0f}, 4, {0.0f, 1.0f, 0.0f});
+  options.triangle_strips = true;
+  hollow_lantern::Projector(options).BasicProjection(
+      model_data, {0.0f, 0.0f, 0.0f}, 4, {0.0f, 1.0f, 0.0f});
+  REQUIRE(model_data.projected_data.size() == 8);
+
+  std::set<std::tuple<int, int, int>> picked;
+  for (size_t view = 0; view < 4; ++view) {
+    const sf::VertexArray &strip = model_data.projected_data[view + 4];
+    REQUIRE(strip.getPrimitiveType() == sf::PrimitiveType::TriangleStrip);
+    // one source per strip triangle, the joins included
+    REQUIRE(model_data.projected_sources[view + 4].size() ==
+            strip.getVertexCount() - 2);
+
+    const hollow_lantern::ProjectionIndex list_index(
+        model_data.projected_data[view], model_data.projected_sources[view]);
+    const hollow_lantern::ProjectionIndex strip_index(
+        strip, model_data.projected_sources[view + 4]);
+    // every quarter voxel across the widest side, both halves of each quad
+    for (float x = -2.375f; x < 2.5f; x += 0.25f) {
+      for (float y = -1.375f; y < 1.5f; y += 0.25f) {
+        const auto expected =
+            list_index.PickVoxel(model_data.triangles, {x, y});
+        REQUIRE(strip_index.PickVoxel(model_data.triangles, {x, y}) ==
+                expected);
+        if (expected.has_value())
+          picked.insert({expected->x, expected->y, expected->z});
+      }
+    }
+  }
+  // every voxel of the wall can be picked
+  REQUIRE(picked.size() == 12);
+}
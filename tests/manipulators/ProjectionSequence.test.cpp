@@ -0,0 +1,76 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Unit tests for the ProjectionSequence class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "ProjectionSequence.h"
+#include "Projector.h"
+#include "VoxManipulator.h"
+#include "VoxReader.h"
+#include <SFML/Graphics/VertexArray.hpp>
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+TEST_CASE("ProjectionSequence produces BasicProjection's views one by one",
+          "[ProjectionSequence]") {
+  hollow_lantern::VoxReader vox_reader;
+  auto result = vox_reader.ProvideVoxData("chr_knight", true);
+  REQUIRE(result.has_value());
+  hollow_lantern::ModelData model_data = result.value();
+  hollow_lantern::VoxManipulator().HollowAndMesh(model_data);
+
+  const hollow_lantern::Projector projector(1);
+  hollow_lantern::ModelData eager = model_data;
+  projector.BasicProjection(eager, {30.0f, 0.0f, 0.0f}, 12,
+                            {0.0f, 1.0f, 0.0f});
+
+  auto require_same = [](const sf::VertexArray &actual,
+                         const sf::VertexArray &expected) {
+    REQUIRE(actual.getVertexCount() == expected.getVertexCount());
+    for (size_t idx = 0; idx < expected.getVertexCount(); ++idx) {
+      REQUIRE(actual[idx].position == expected[idx].position);
+      REQUIRE(actual[idx].color == expected[idx].color);
+    }
+  };
+
+  SECTION("pulled into a reused buffer") {
+    auto sequence = projector.LazyProjection(model_data, {30.0f, 0.0f, 0.0f},
+                                             12, {0.0f, 1.0f, 0.0f});
+    REQUIRE(sequence.Size() == 12);
+    // sized for the largest view, so no view should need new storage
+    size_t largest = 0;
+    for (const sf::VertexArray &expected : eager.projected_data)
+      largest = std::max(largest, expected.getVertexCount());
+    REQUIRE(largest > 0);
+    sf::VertexArray view(sf::PrimitiveType::Points, largest);
+    const sf::Vertex *storage = &view[0];
+    std::vector<float> depths;
+    for (size_t idx = 0; idx < 12; ++idx) {
+      REQUIRE(sequence.Next(view, &depths));
+      require_same(view, eager.projected_data[idx]);
+      REQUIRE(depths == eager.projected_depths[idx]);
+      REQUIRE(view.getPrimitiveType() == sf::PrimitiveType::Triangles);
+      if (view.getVertexCount() > 0)
+        REQUIRE(&view[0] == storage);
+    }
+    REQUIRE_FALSE(sequence.Next(view));
+    // nothing is accumulated on the model
+    REQUIRE(model_data.projected_data.empty());
+  }
+
+  SECTION("read with a range for loop") {
+    auto sequence = projector.LazyProjection(model_data, {30.0f, 0.0f, 0.0f},
+                                             12, {0.0f, 1.0f, 0.0f});
+    size_t idx = 0;
+    for (const sf::VertexArray &view : sequence) {
+      REQUIRE(idx < eager.projected_data.size());
+      require_same(view, eager.projected_data[idx]);
+      ++idx;
+    }
+    REQUIRE(idx == 12);
+  }
+}
@@ -6,9 +6,604 @@
 /////////////////////////////////////////////////
 /// Headers
 /////////////////////////////////////////////////
+#include "Projector.h"
+#include "SpriteRasterizer.h"
+#include "VoxManipulator.h"
+#include "VoxReader.h"
 #include <SFML/Graphics/VertexArray.hpp>
+#include <catch2/catch_approx.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/glm.hpp>
+#include <map>
+#include <set>
 
 TEST_CASE("Projector projects 3D models onto 2D planes", "[Projector]") {
   REQUIRE(true); // Placeholder for actual test implementation
 }
+
+TEST_CASE("Projector picks a level of detail for the on-screen voxel size",
+          "[Projector]") {
+  hollow_lantern::VoxReader vox_reader;
+  auto result = vox_reader.ProvideVoxData("simple_cube", true);
+  REQUIRE(result.has_value());
+  hollow_lantern::ModelData model_data = result.value();
+
+  hollow_lantern::VoxManipulator manipulator;
+  manipulator.HollowAndMesh(model_data);
+  manipulator.GenerateLevelsOfDetail(model_data);
+
+  hollow_lantern::Projector projector;
+  // full resolution while a voxel covers at least a pixel
+  REQUIRE(projector.SelectLevelOfDetail(model_data, 1.0f, 1.0f) == 0);
+  // a quarter pixel per voxel needs 4x coarser voxels
+  REQUIRE(projector.SelectLevelOfDetail(model_data, 0.25f, 1.0f) == 2);
+  // falls back to the coarsest level
+  REQUIRE(projector.SelectLevelOfDetail(model_data, 0.01f, 1.0f) == 3);
+
+  // coarse views land on the source model and keep its extent
+  projector.LevelOfDetailProjection(model_data, {0.0f, 0.0f, 0.0f}, 4,
+                                    {0.0f, 1.0f, 0.0f}, 0.25f, 1.0f);
+  REQUIRE(model_data.projected_data.size() == 4);
+  REQUIRE(model_data.levels_of_detail[1].projected_data.empty());
+  const sf::FloatRect bounds = model_data.projected_data[0].getBounds();
+  REQUIRE(bounds.size.x == Catch::Approx(12.0f));
+  REQUIRE(bounds.size.y == Catch::Approx(12.0f));
+}
+
+TEST_CASE("Projector projects views in parallel in interval order",
+          "[Projector]") {
+  hollow_lantern::VoxReader vox_reader;
+  auto result = vox_reader.ProvideVoxData("chr_knight", true);
+  REQUIRE(result.has_value());
+  hollow_lantern::ModelData serial = result.value();
+  hollow_lantern::VoxManipulator().HollowAndMesh(serial);
+  hollow_lantern::ModelData parallel = serial;
+
+  hollow_lantern::Projector(1).BasicProjection(serial, {30.0f, 0.0f, 0.0f}, 16,
+                                               {0.0f, 1.0f, 0.0f});
+  hollow_lantern::Projector(4).BasicProjection(
+      parallel, {30.0f, 0.0f, 0.0f}, 16, {0.0f, 1.0f, 0.0f});
+
+  REQUIRE(parallel.projected_data.size() == 16);
+  for (size_t view = 0; view < 16; ++view) {
+    const auto &expected = serial.projected_data[view];
+    const auto &actual = parallel.projected_data[view];
+    REQUIRE(actual.getVertexCount() == expected.getVertexCount());
+    for (size_t idx = 0; idx < expected.getVertexCount(); ++idx) {
+      REQUIRE(actual[idx].position == expected[idx].position);
+      REQUIRE(actual[idx].color == expected[idx].color);
+    }
+  }
+}
+
+TEST_CASE("Projector culls faces before projecting and keeps mesh order",
+          "[Projector]") {
+  hollow_lantern::VoxReader vox_reader;
+  auto result = vox_reader.ProvideVoxData("chr_knight", true);
+  REQUIRE(result.has_value());
+  hollow_lantern::ModelData model_data = result.value();
+  hollow_lantern::VoxManipulator().HollowAndMesh(model_data);
+
+  // facing straight down -z only the Z_NEGATIVE faces are visible
+  hollow_lantern::Projector(1).BasicProjection(
+      model_data, {0.0f, 0.0f, 0.0f}, 4, {0.0f, 1.0f, 0.0f});
+  std::vector<hollow_lantern::Triangle> front;
+  for (const auto &triangle : model_data.triangles) {
+    if (triangle.direction == hollow_lantern::Direction::Z_NEGATIVE)
+      front.push_back(triangle);
+  }
+  REQUIRE_FALSE(front.empty());
+  const auto &view = model_data.projected_data[0];
+  REQUIRE(view.getVertexCount() == front.size() * 3);
+
+  // unrotated, the view is the model centred on the origin
+  const glm::vec2 center(static_cast<float>(model_data.size.x) * 0.5f,
+                         static_cast<float>(model_data.size.y) * 0.5f);
+  for (size_t idx = 0; idx < front.size(); ++idx) {
+    for (size_t vert = 0; vert < 3; ++vert) {
+      const auto &vertex = view[idx * 3 + vert];
+      REQUIRE(vertex.color == front[idx].color);
+      REQUIRE(vertex.position.x ==
+              Catch::Approx(front[idx].vertices[vert].x - center.x));
+      REQUIRE(vertex.position.y ==
+              Catch::Approx(front[idx].vertices[vert].y - center.y));
+    }
+  }
+}
+
+TEST_CASE("Projector views sharing a visibility signature keep the same faces",
+          "[Projector]") {
+  hollow_lantern::VoxReader vox_reader;
+  auto result = vox_reader.ProvideVoxData("chr_knight", true);
+  REQUIRE(result.has_value());
+  hollow_lantern::ModelData model_data = result.value();
+  hollow_lantern::VoxManipulator().HollowAndMesh(model_data);
+
+  std::array<size_t, 6> direction_counts{};
+  for (const auto &triangle : model_data.triangles) {
+    ++direction_counts[static_cast<size_t>(triangle.direction) - 1];
+  }
+
+  const size_t intervals = 32;
+  hollow_lantern::Projector().BasicProjection(
+      model_data, {30.0f, 0.0f, 0.0f}, intervals, {0.0f, 1.0f, 0.0f});
+  REQUIRE(model_data.projected_data.size() == intervals);
+
+  const std::array<glm::vec3, 6> normals{
+      glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f),
+      glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f),
+      glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f)};
+  const glm::mat4 tilt = glm::rotate(glm::mat4(1.0f), glm::radians(30.0f),
+                                     glm::vec3(1.0f, 0.0f, 0.0f));
+  for (size_t view = 0; view < intervals; ++view) {
+    const float angle = static_cast<float>(view) * 360.0f / intervals;
+    const glm::mat4 rotation =
+        glm::rotate(glm::mat4(1.0f), glm::radians(angle),
+                    glm::vec3(0.0f, 1.0f, 0.0f)) *
+        tilt;
+    // a face is kept when its rotated normal points down -z
+    size_t expected = 0;
+    for (size_t dir = 0; dir < normals.size(); ++dir) {
+      const glm::vec4 normal = rotation * glm::vec4(normals[dir], 0.0f);
+      if (normal.z < 0.0f)
+        expected += direction_counts[dir] * 3;
+    }
+    REQUIRE(model_data.projected_data[view].getVertexCount() == expected);
+  }
+}
+
+TEST_CASE("Projector remaps quarter turn views exactly", "[Projector]") {
+  hollow_lantern::VoxReader vox_reader;
+  auto result = vox_reader.ProvideVoxData("chr_knight", true);
+  REQUIRE(result.has_value());
+  hollow_lantern::ModelData model_data = result.value();
+  hollow_lantern::VoxManipulator().HollowAndMesh(model_data);
+
+  hollow_lantern::Projector(1).BasicProjection(
+      model_data, {0.0f, 0.0f, 0.0f}, 4, {0.0f, 1.0f, 0.0f});
+  REQUIRE(model_data.projected_data.size() == 4);
+
+  // turning about y by 0, 90, 180 and 270 degrees shows one face each, with
+  // screen x taken from a signed source axis and screen y always source y
+  const std::array<hollow_lantern::Direction, 4> seen{
+      hollow_lantern::Direction::Z_NEGATIVE,
+      hollow_lantern::Direction::X_POSITIVE,
+      hollow_lantern::Direction::Z_POSITIVE,
+      hollow_lantern::Direction::X_NEGATIVE};
+  const std::array<int, 4> screen_x_axis{0, 2, 0, 2};
+  const std::array<float, 4> screen_x_sign{1.0f, 1.0f, -1.0f, -1.0f};
+  const glm::vec3 center(static_cast<float>(model_data.size.x) * 0.5f,
+                         static_cast<float>(model_data.size.y) * 0.5f,
+                         static_cast<float>(model_data.size.z) * 0.5f);
+
+  for (size_t view = 0; view < 4; ++view) {
+    std::vector<hollow_lantern::Triangle> faces;
+    for (const auto &triangle : model_data.triangles) {
+      if (triangle.direction == seen[view])
+        faces.push_back(triangle);
+    }
+    const auto &projection = model_data.projected_data[view];
+    REQUIRE(projection.getVertexCount() == faces.size() * 3);
+    const int axis = screen_x_axis[view];
+    for (size_t idx = 0; idx < faces.size(); ++idx) {
+      for (size_t vert = 0; vert < 3; ++vert) {
+        const glm::vec3 &source = faces[idx].vertices[vert];
+        const auto &position = projection[idx * 3 + vert].position;
+        // compared exactly, quarter turns must not pick up float noise
+        REQUIRE(position.x ==
+                screen_x_sign[view] * (source[axis] - center[axis]));
+        REQUIRE(position.y == source.y - center.y);
+      }
+    }
+  }
+}
+
+TEST_CASE("Projector builds axis aligned views from the front mask layer",
+          "[Projector]") {
+  hollow_lantern::VoxReader vox_reader;
+  auto result = vox_reader.ProvideVoxData("chr_knight", true);
+  REQUIRE(result.has_value());
+  hollow_lantern::ModelData model_data = result.value();
+  hollow_lantern::VoxManipulator().HollowAndMesh(model_data);
+  const sf::Vector3i size = model_data.size;
+
+  hollow_lantern::Projector projector;
+  REQUIRE_FALSE(projector.AxisAlignedProjection(
+      model_data, hollow_lantern::Direction::NONE));
+  REQUIRE(model_data.projected_data.empty());
+
+  // fill a screen cell grid from the quads of a view, cells are one voxel
+  auto paint = [](const sf::VertexArray &view, int width, int height,
+                  float center_x, float center_y) {
+    std::vector<std::optional<sf::Color>> cells(width * height);
+    REQUIRE(view.getVertexCount() % 6 == 0);
+    for (size_t quad = 0; quad < view.getVertexCount(); quad += 6) {
+      float min_x = view[quad].position.x, max_x = min_x;
+      float min_y = view[quad].position.y, max_y = min_y;
+      for (size_t vert = quad; vert < quad + 6; ++vert) {
+        min_x = std::min(min_x, view[vert].position.x);
+        max_x = std::max(max_x, view[vert].position.x);
+        min_y = std::min(min_y, view[vert].position.y);
+        max_y = std::max(max_y, view[vert].position.y);
+      }
+      for (int v = static_cast<int>(min_y + center_y);
+           v < static_cast<int>(max_y + center_y); ++v) {
+        for (int u = static_cast<int>(min_x + center_x);
+             u < static_cast<int>(max_x + center_x); ++u) {
+          // quads of one view never overlap
+          REQUIRE_FALSE(cells[v * width + u].has_value());
+          cells[v * width + u] = view[quad].color;
+        }
+      }
+    }
+    return cells;
+  };
+
+  SECTION("front view sees the lowest z voxel of every ray") {
+    REQUIRE(projector.AxisAlignedProjection(
+        model_data, hollow_lantern::Direction::Z_NEGATIVE));
+    const auto cells =
+        paint(model_data.projected_data.back(), size.x, size.y,
+              static_cast<float>(size.x) * 0.5f,
+              static_cast<float>(size.y) * 0.5f);
+    for (int y = 0; y < size.y; ++y) {
+      for (int x = 0; x < size.x; ++x) {
+        std::optional<sf::Color> expected;
+        for (int z = 0; z < size.z && !expected; ++z) {
+          if (model_data.voxel_data[x][y][z].is_visible)
+            expected = model_data.voxel_data[x][y][z].color;
+        }
+        REQUIRE(cells[y * size.x + x] == expected);
+      }
+    }
+  }
+
+  SECTION("side view sees the highest x voxel of every ray") {
+    REQUIRE(projector.AxisAlignedProjection(
+        model_data, hollow_lantern::Direction::X_POSITIVE));
+    // turned 90 degrees about y, screen x runs along z
+    const auto cells =
+        paint(model_data.projected_data.back(), size.z, size.y,
+              static_cast<float>(size.z) * 0.5f,
+              static_cast<float>(size.y) * 0.5f);
+    for (int y = 0; y < size.y; ++y) {
+      for (int z = 0; z < size.z; ++z) {
+        std::optional<sf::Color> expected;
+        for (int x = size.x - 1; x >= 0 && !expected; --x) {
+          if (model_data.voxel_data[x][y][z].is_visible)
+            expected = model_data.voxel_data[x][y][z].color;
+        }
+        REQUIRE(cells[y * size.z + z] == expected);
+      }
+    }
+  }
+
+  SECTION("front layers are batched by colour and written as strips") {
+    REQUIRE(projector.AxisAlignedProjection(
+        model_data, hollow_lantern::Direction::Z_NEGATIVE));
+    const sf::VertexArray plain = model_data.projected_data.back();
+    const float center_x = static_cast<float>(size.x) * 0.5f;
+    const float center_y = static_cast<float>(size.y) * 0.5f;
+
+    hollow_lantern::ProjectionOptions batching;
+    batching.batch_by_color = true;
+    const hollow_lantern::Projector batcher(batching);
+    REQUIRE(batcher.AxisAlignedProjection(
+        model_data, hollow_lantern::Direction::Z_NEGATIVE));
+    const sf::VertexArray &batched = model_data.projected_data.back();
+    // the same cells are covered, with one run per colour
+    REQUIRE(paint(batched, size.x, size.y, center_x, center_y) ==
+            paint(plain, size.x, size.y, center_x, center_y));
+    std::set<uint32_t> colors;
+    for (size_t vertex = 0; vertex < plain.getVertexCount(); ++vertex)
+      colors.insert(plain[vertex].color.toInteger());
+    REQUIRE(batcher.ColorBatches(batched).size() == colors.size());
+
+    hollow_lantern::ProjectionOptions stripping;
+    stripping.triangle_strips = true;
+    const hollow_lantern::Projector stripper(stripping);
+    REQUIRE(stripper.AxisAlignedProjection(
+        model_data, hollow_lantern::Direction::Z_NEGATIVE));
+    const sf::VertexArray &strip = model_data.projected_data.back();
+    REQUIRE(strip.getPrimitiveType() == sf::PrimitiveType::TriangleStrip);
+    REQUIRE(strip.getVertexCount() < plain.getVertexCount());
+    REQUIRE(model_data.projected_sources.back().empty());
+  }
+
+  SECTION("models without masks fall back to the mesh") {
+    for (auto &mask : model_data.masks)
+      mask.data.clear();
+    REQUIRE(projector.AxisAlignedProjection(
+        model_data, hollow_lantern::Direction::X_POSITIVE));
+    size_t side_faces = 0;
+    for (const auto &triangle : model_data.triangles) {
+      if (triangle.direction == hollow_lantern::Direction::X_POSITIVE)
+        ++side_faces;
+    }
+    REQUIRE(model_data.projected_data.back().getVertexCount() ==
+            side_faces * 3);
+  }
+}
+
+TEST_CASE("Projector removes hidden surfaces and draws back to front",
+          "[Projector]") {
+  // a red voxel at z = 0 in front of a blue one at z = 2, and a green one off
+  // to the side at z = 3 that nothing covers
+  hollow_lantern::ModelData model_data;
+  model_data.size = {2, 1, 4};
+  model_data.voxel_data.assign(
+      2, std::vector<std::vector<hollow_lantern::Voxel>>(
+             1, std::vector<hollow_lantern::Voxel>(4)));
+  model_data.voxel_data[0][0][0] = {sf::Color::Red, true};
+  model_data.voxel_data[0][0][2] = {sf::Color::Blue, true};
+  model_data.voxel_data[1][0][3] = {sf::Color::Green, true};
+  hollow_lantern::VoxManipulator().HollowAndMesh(model_data);
+
+  hollow_lantern::ProjectionOptions options;
+  options.thread_count = 1;
+  hollow_lantern::Projector(options).BasicProjection(
+      model_data, {0.0f, 0.0f, 0.0f}, 1, {0.0f, 1.0f, 0.0f});
+  options.remove_hidden_surfaces = true;
+  hollow_lantern::Projector(options).BasicProjection(
+      model_data, {0.0f, 0.0f, 0.0f}, 1, {0.0f, 1.0f, 0.0f});
+  REQUIRE(model_data.projected_data.size() == 2);
+
+  // every front face is kept without hidden surface removal
+  REQUIRE(model_data.projected_data[0].getVertexCount() == 18);
+
+  // the blue face is gone and the further green face is drawn first
+  const auto &view = model_data.projected_data[1];
+  REQUIRE(view.getVertexCount() == 12);
+  for (size_t vert = 0; vert < 6; ++vert) {
+    REQUIRE(view[vert].color == sf::Color::Green);
+    REQUIRE(view[vert + 6].color == sf::Color::Red);
+  }
+}
+
+TEST_CASE("Projector hidden surface removal only ever drops faces",
+          "[Projector]") {
+  hollow_lantern::VoxReader vox_reader;
+  auto result = vox_reader.ProvideVoxData("chr_knight", true);
+  REQUIRE(result.has_value());
+  hollow_lantern::ModelData model_data = result.value();
+  hollow_lantern::VoxManipulator().HollowAndMesh(model_data);
+
+  hollow_lantern::ProjectionOptions options;
+  hollow_lantern::Projector(options).BasicProjection(
+      model_data, {30.0f, 0.0f, 0.0f}, 8, {0.0f, 1.0f, 0.0f});
+  options.remove_hidden_surfaces = true;
+  hollow_lantern::Projector(options).BasicProjection(
+      model_data, {30.0f, 0.0f, 0.0f}, 8, {0.0f, 1.0f, 0.0f});
+  REQUIRE(model_data.projected_data.size() == 16);
+
+  for (size_t view = 0; view < 8; ++view) {
+    const auto &all = model_data.projected_data[view];
+    const auto &kept = model_data.projected_data[view + 8];
+    REQUIRE(kept.getVertexCount() > 0);
+    REQUIRE(kept.getVertexCount() < all.getVertexCount());
+  }
+}
+
+TEST_CASE("Projector ray casts views down to the faces they can see",
+          "[Projector]") {
+  hollow_lantern::VoxReader vox_reader;
+  auto result = vox_reader.ProvideVoxData("chr_knight", true);
+  REQUIRE(result.has_value());
+  hollow_lantern::ModelData model_data = result.value();
+  hollow_lantern::VoxManipulator().HollowAndMesh(model_data);
+
+  hollow_lantern::ProjectionOptions options;
+  hollow_lantern::Projector(options).BasicProjection(
+      model_data, {30.0f, 0.0f, 0.0f}, 4, {0.0f, 1.0f, 0.0f});
+  options.ray_cast_visibility = true;
+  hollow_lantern::Projector(options).BasicProjection(
+      model_data, {30.0f, 0.0f, 0.0f}, 4, {0.0f, 1.0f, 0.0f});
+  REQUIRE(model_data.projected_data.size() == 8);
+  for (size_t view = 0; view < 4; ++view) {
+    const auto &all = model_data.projected_data[view];
+    const auto &seen = model_data.projected_data[view + 4];
+    REQUIRE(seen.getVertexCount() > 0);
+    REQUIRE(seen.getVertexCount() < all.getVertexCount());
+  }
+
+  // without voxels every front face is kept
+  model_data.voxel_data.clear();
+  hollow_lantern::Projector(options).BasicProjection(
+      model_data, {30.0f, 0.0f, 0.0f}, 4, {0.0f, 1.0f, 0.0f});
+  REQUIRE(model_data.projected_data[8].getVertexCount() ==
+          model_data.projected_data[0].getVertexCount());
+}
+
+TEST_CASE("Projector projects batches of rotations in one pass",
+          "[Projector]") {
+  hollow_lantern::VoxReader vox_reader;
+  auto result = vox_reader.ProvideVoxData("chr_knight", true);
+  REQUIRE(result.has_value());
+  hollow_lantern::ModelData model_data = result.value();
+  hollow_lantern::VoxManipulator().HollowAndMesh(model_data);
+  const hollow_lantern::Projector projector(1);
+
+  auto require_same = [](const sf::VertexArray &actual,
+                         const sf::VertexArray &expected) {
+    REQUIRE(actual.getVertexCount() == expected.getVertexCount());
+    for (size_t idx = 0; idx < expected.getVertexCount(); ++idx) {
+      REQUIRE(actual[idx].position == expected[idx].position);
+      REQUIRE(actual[idx].color == expected[idx].color);
+    }
+  };
+
+  SECTION("a list of rotations matches the turntable") {
+    hollow_lantern::ModelData turntable = model_data;
+    projector.BasicProjection(turntable, {0.0f, 0.0f, 0.0f}, 6,
+                              {0.0f, 1.0f, 0.0f});
+    std::vector<glm::vec3> rotations;
+    for (size_t i = 0; i < 6; ++i)
+      rotations.emplace_back(0.0f, static_cast<float>(i) * 60.0f, 0.0f);
+    projector.BatchProjection(model_data, rotations);
+    REQUIRE(model_data.projected_data.size() == 6);
+    for (size_t view = 0; view < 6; ++view)
+      require_same(model_data.projected_data[view],
+                   turntable.projected_data[view]);
+  }
+
+  SECTION("a grid matches one turntable per pitch") {
+    const std::vector<float> pitches{0.0f, 30.0f, 60.0f};
+    projector.GridProjection(model_data, pitches, 8);
+    REQUIRE(model_data.projected_data.size() == 24);
+    for (size_t pitch = 0; pitch < pitches.size(); ++pitch) {
+      hollow_lantern::ModelData turntable = model_data;
+      turntable.projected_data.clear();
+      projector.BasicProjection(turntable, {pitches[pitch], 0.0f, 0.0f}, 8,
+                                {0.0f, 1.0f, 0.0f});
+      for (size_t yaw = 0; yaw < 8; ++yaw)
+        require_same(model_data.projected_data[pitch * 8 + yaw],
+                     turntable.projected_data[yaw]);
+    }
+  }
+}
+
+TEST_CASE("Projector batches each view into runs of one colour",
+          "[Projector]") {
+  hollow_lantern::VoxReader vox_reader;
+  auto result = vox_reader.ProvideVoxData("chr_knight", true);
+  REQUIRE(result.has_value());
+  hollow_lantern::ModelData model_data = result.value();
+  hollow_lantern::VoxManipulator().HollowAndMesh(model_data);
+
+  hollow_lantern::ProjectionOptions options;
+  options.remove_hidden_surfaces = true;
+  const hollow_lantern::Projector projector(options);
+  projector.BasicProjection(model_data, {30.0f, 0.0f, 0.0f}, 4,
+                            {0.0f, 1.0f, 0.0f});
+  options.batch_by_color = true;
+  hollow_lantern::Projector(options).BasicProjection(
+      model_data, {30.0f, 0.0f, 0.0f}, 4, {0.0f, 1.0f, 0.0f});
+  REQUIRE(model_data.projected_data.size() == 8);
+
+  for (size_t view = 0; view < 4; ++view) {
+    const auto &interleaved = model_data.projected_data[view];
+    const auto &batched = model_data.projected_data[view + 4];
+    REQUIRE(batched.getVertexCount() == interleaved.getVertexCount());
+
+    // the same triangles in far fewer runs
+    const auto batches = projector.ColorBatches(batched);
+    REQUIRE(batches.size() < projector.ColorBatches(interleaved).size());
+    std::map<uint32_t, size_t> batched_counts;
+    size_t next_vertex = 0;
+    for (const auto &batch : batches) {
+      REQUIRE(batch.first_vertex == next_vertex);
+      next_vertex += batch.vertex_count;
+      batched_counts[batch.color.toInteger()] += batch.vertex_count;
+    }
+    REQUIRE(next_vertex == batched.getVertexCount());
+    std::map<uint32_t, size_t> interleaved_counts;
+    for (const auto &batch : projector.ColorBatches(interleaved))
+      interleaved_counts[batch.color.toInteger()] += batch.vertex_count;
+    REQUIRE(batched_counts == interleaved_counts);
+
+    // drawn in order, faces on top stay on top
+    hollow_lantern::SpriteSheetOptions sheet;
+    sheet.pixels_per_unit = 2.0f;
+    const hollow_lantern::SpriteRasterizer rasterizer(sheet);
+    const sf::Image batched_image = rasterizer.RasterizeSheet({batched});
+    const sf::Image interleaved_image =
+        rasterizer.RasterizeSheet({interleaved});
+    REQUIRE(batched_image.getSize() == interleaved_image.getSize());
+    REQUIRE(std::equal(batched_image.getPixelsPtr(),
+                       batched_image.getPixelsPtr() +
+                           batched_image.getSize().x *
+                               batched_image.getSize().y * 4,
+                       interleaved_image.getPixelsPtr()));
+
+    // sources follow their triangles
+    const auto &sources = model_data.projected_sources[view + 4];
+    REQUIRE(sources.size() * 3 == batched.getVertexCount());
+    for (size_t tri = 0; tri < sources.size(); ++tri)
+      REQUIRE(model_data.triangles[sources[tri]].color ==
+              batched[tri * 3].color);
+  }
+}
+
+TEST_CASE("Projector keeps overlapping colours in order when batching",
+          "[Projector]") {
+  // red, blue and red voxels one behind the other, so from the front their
+  // faces cover each other. Red is drawn first but blue is drawn between red
+  // faces, so red cannot be drawn in one run without swapping an overlap
+  hollow_lantern::ModelData model_data;
+  model_data.size = {1, 1, 5};
+  model_data.voxel_data.assign(
+      1, std::vector<std::vector<hollow_lantern::Voxel>>(
+             1, std::vector<hollow_lantern::Voxel>(5)));
+  model_data.voxel_data[0][0][0] = {sf::Color::Red, true};
+  model_data.voxel_data[0][0][2] = {sf::Color::Blue, true};
+  model_data.voxel_data[0][0][4] = {sf::Color::Red, true};
+  hollow_lantern::VoxManipulator().HollowAndMesh(model_data);
+
+  hollow_lantern::ProjectionOptions options;
+  hollow_lantern::Projector(options).BasicProjection(
+      model_data, {0.0f, 0.0f, 0.0f}, 1, {0.0f, 1.0f, 0.0f});
+  options.batch_by_color = true;
+  const hollow_lantern::Projector batcher(options);
+  batcher.BasicProjection(model_data, {0.0f, 0.0f, 0.0f}, 1,
+                          {0.0f, 1.0f, 0.0f});
+  const sf::VertexArray &plain = model_data.projected_data[0];
+  const sf::VertexArray &batched = model_data.projected_data[1];
+
+  // each face is a run of its own, drawn in the same order
+  REQUIRE(batcher.ColorBatches(plain).size() == 3);
+  const auto batches = batcher.ColorBatches(batched);
+  REQUIRE(batches.size() == 3);
+  for (size_t batch = 0; batch < batches.size(); ++batch)
+    REQUIRE(batches[batch].color == plain[batch * 6].color);
+  REQUIRE(batches[0].color != batches[1].color);
+
+  // a row of the same three further along x, not overlapping them, joins
+  // the runs instead of adding more
+  model_data.size = {2, 1, 5};
+  model_data.voxel_data.push_back(model_data.voxel_data[0]);
+  hollow_lantern::VoxManipulator().HollowAndMesh(model_data);
+  model_data.projected_data.clear();
+  batcher.BasicProjection(model_data, {0.0f, 0.0f, 0.0f}, 1,
+                          {0.0f, 1.0f, 0.0f});
+  REQUIRE(batcher.ColorBatches(model_data.projected_data[0]).size() == 3);
+}
+
+TEST_CASE("Projector writes views as triangle strips", "[Projector]") {
+  hollow_lantern::VoxReader vox_reader;
+  auto result = vox_reader.ProvideVoxData("chr_knight", true);
+  REQUIRE(result.has_value());
+  hollow_lantern::ModelData model_data = result.value();
+  hollow_lantern::VoxManipulator().HollowAndMesh(model_data);
+
+  hollow_lantern::ProjectionOptions options;
+  options.batch_by_color = true;
+  hollow_lantern::Projector(options).BasicProjection(
+      model_data, {0.0f, 0.0f, 0.0f}, 4, {0.0f, 1.0f, 0.0f});
+  options.triangle_strips = true;
+  const hollow_lantern::Projector projector(options);
+  projector.BasicProjection(model_data, {0.0f, 0.0f, 0.0f}, 4,
+                            {0.0f, 1.0f, 0.0f});
+  REQUIRE(model_data.projected_data.size() == 8);
+
+  for (size_t view = 0; view < 4; ++view) {
+    const auto &list = model_data.projected_data[view];
+    const auto &strip = model_data.projected_data[view + 4];
+    REQUIRE(strip.getPrimitiveType() == sf::PrimitiveType::TriangleStrip);
+    REQUIRE(strip.getVertexCount() < list.getVertexCount());
+    // every strip triangle, joins included, keeps a face of its colour
+    const auto &sources = model_data.projected_sources[view + 4];
+    REQUIRE(sources.size() == strip.getVertexCount() - 2);
+    for (size_t tri = 0; tri < sources.size(); ++tri)
+      REQUIRE(model_data.triangles[sources[tri]].color ==
+              strip[tri + 2].color);
+
+    // batches still cover the whole strip, one colour each
+    size_t covered = 0;
+    for (const auto &batch : projector.ColorBatches(strip)) {
+      REQUIRE(batch.first_vertex == covered);
+      covered += batch.vertex_count;
+    }
+    REQUIRE(covered == strip.getVertexCount());
+  }
+}
@@ -0,0 +1,60 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Unit tests for the RegionMerger class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "RegionMerger.h"
+#include "TestViews.h"
+#include <SFML/Graphics/VertexArray.hpp>
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using hollow_lantern::testing::AppendRectangle;
+using hollow_lantern::testing::ColorArea;
+
+TEST_CASE("RegionMerger merges a flat region into two triangles",
+          "[RegionMerger]") {
+  // a 4x4 grid of unit quads, two triangles per voxel face
+  sf::VertexArray view(sf::PrimitiveType::Triangles);
+  for (int x = 0; x < 4; ++x) {
+    for (int y = 0; y < 4; ++y) {
+      AppendRectangle(view, static_cast<float>(x), static_cast<float>(y), 1.0f,
+                      1.0f, sf::Color::Red);
+    }
+  }
+  REQUIRE(view.getVertexCount() == 96);
+
+  const sf::VertexArray merged =
+      hollow_lantern::RegionMerger().MergeRegions(view);
+  REQUIRE(merged.getPrimitiveType() == sf::PrimitiveType::Triangles);
+  REQUIRE(merged.getVertexCount() == 6);
+  REQUIRE(ColorArea(merged, sf::Color::Red) == Catch::Approx(16.0f));
+}
+
+TEST_CASE("RegionMerger keeps what later triangles draw over",
+          "[RegionMerger]") {
+  // blue drawn first, red drawn over its right half
+  sf::VertexArray view(sf::PrimitiveType::Triangles);
+  AppendRectangle(view, 0.0f, 0.0f, 4.0f, 2.0f, sf::Color::Blue);
+  AppendRectangle(view, 2.0f, 0.0f, 4.0f, 2.0f, sf::Color::Red);
+
+  const sf::VertexArray merged =
+      hollow_lantern::RegionMerger().MergeRegions(view);
+  REQUIRE(ColorArea(merged, sf::Color::Blue) == Catch::Approx(4.0f));
+  REQUIRE(ColorArea(merged, sf::Color::Red) == Catch::Approx(8.0f));
+  REQUIRE(merged.getVertexCount() == 12);
+}
+
+TEST_CASE("RegionMerger leaves textured views alone", "[RegionMerger]") {
+  sf::VertexArray view(sf::PrimitiveType::Triangles);
+  AppendRectangle(view, 0.0f, 0.0f, 1.0f, 1.0f, sf::Color::Green);
+  AppendRectangle(view, 1.0f, 0.0f, 1.0f, 1.0f, sf::Color::Green);
+  view[0].texCoords = sf::Vector2f(1.0f, 0.0f);
+
+  const sf::VertexArray merged =
+      hollow_lantern::RegionMerger().MergeRegions(view);
+  REQUIRE(merged.getVertexCount() == view.getVertexCount());
+}
@@ -0,0 +1,152 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Unit tests for the SpriteRasterizer class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "SpriteRasterizer.h"
+#include "Projector.h"
+#include "TestViews.h"
+#include "VoxManipulator.h"
+#include <SFML/Graphics/VertexArray.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+using hollow_lantern::testing::AppendRectangle;
+
+TEST_CASE("SpriteRasterizer packs views into one sheet",
+          "[SpriteRasterizer]") {
+  std::vector<sf::VertexArray> views(
+      2, sf::VertexArray(sf::PrimitiveType::Triangles));
+  AppendRectangle(views[0], 0.0f, 0.0f, 2.0f, 2.0f, sf::Color::Red);
+  // green drawn over the right half of the blue square
+  AppendRectangle(views[1], 0.0f, 0.0f, 2.0f, 2.0f, sf::Color::Blue);
+  AppendRectangle(views[1], 1.0f, 0.0f, 1.0f, 2.0f, sf::Color::Green);
+
+  hollow_lantern::SpriteSheetOptions options;
+  options.pixels_per_unit = 4.0f;
+  options.padding = 1;
+  const sf::Image sheet =
+      hollow_lantern::SpriteRasterizer(options).RasterizeSheet(views);
+
+  // two 8 pixel sprites with a pixel of padding each side, side by side
+  REQUIRE(sheet.getSize() == sf::Vector2u(20, 10));
+  REQUIRE(sheet.getPixel({0, 0}) == sf::Color::Transparent);
+  REQUIRE(sheet.getPixel({1, 1}) == sf::Color::Red);
+  REQUIRE(sheet.getPixel({8, 8}) == sf::Color::Red);
+  REQUIRE(sheet.getPixel({9, 5}) == sf::Color::Transparent);
+  REQUIRE(sheet.getPixel({12, 5}) == sf::Color::Blue);
+  REQUIRE(sheet.getPixel({16, 5}) == sf::Color::Green);
+  REQUIRE(sheet.getPixel({19, 9}) == sf::Color::Transparent);
+}
+
+TEST_CASE("SpriteRasterizer leaves no gaps across tiles",
+          "[SpriteRasterizer]") {
+  // a 10x10 grid of unit quads spans several tiles at 8 pixels a unit
+  std::vector<sf::VertexArray> views(
+      1, sf::VertexArray(sf::PrimitiveType::Triangles));
+  for (int x = 0; x < 10; ++x) {
+    for (int y = 0; y < 10; ++y) {
+      AppendRectangle(views[0], static_cast<float>(x), static_cast<float>(y),
+                      1.0f, 1.0f, sf::Color::Yellow);
+    }
+  }
+
+  hollow_lantern::SpriteSheetOptions options;
+  options.padding = 0;
+  options.thread_count = 4;
+  const sf::Image sheet =
+      hollow_lantern::SpriteRasterizer(options).RasterizeSheet(views);
+
+  REQUIRE(sheet.getSize() == sf::Vector2u(80, 80));
+  size_t filled = 0;
+  for (unsigned int y = 0; y < 80; ++y) {
+    for (unsigned int x = 0; x < 80; ++x) {
+      if (sheet.getPixel({x, y}) == sf::Color::Yellow)
+        ++filled;
+    }
+  }
+  REQUIRE(filled == 80 * 80);
+}
+
+TEST_CASE("SpriteRasterizer keeps the nearest triangle with depths",
+          "[SpriteRasterizer]") {
+  // red drawn first but nearer, blue drawn over it further back, and green
+  // drawn last over the right half level with red
+  std::vector<sf::VertexArray> views(
+      2, sf::VertexArray(sf::PrimitiveType::Triangles));
+  for (sf::VertexArray &view : views) {
+    AppendRectangle(view, 0.0f, 0.0f, 2.0f, 2.0f, sf::Color::Red);
+    AppendRectangle(view, 0.0f, 0.0f, 2.0f, 2.0f, sf::Color::Blue);
+    AppendRectangle(view, 1.0f, 0.0f, 1.0f, 2.0f, sf::Color::Green);
+  }
+  // the second view has no depths and is drawn in order
+  std::vector<std::vector<float>> depths(1);
+  for (const float depth : {1.0f, 5.0f, 1.0f})
+    depths[0].insert(depths[0].end(), 6, depth);
+
+  hollow_lantern::SpriteSheetOptions options;
+  options.pixels_per_unit = 4.0f;
+  options.padding = 0;
+  const sf::Image sheet =
+      hollow_lantern::SpriteRasterizer(options).RasterizeSheet(views, depths);
+
+  REQUIRE(sheet.getSize() == sf::Vector2u(16, 8));
+  REQUIRE(sheet.getPixel({1, 4}) == sf::Color::Red);
+  REQUIRE(sheet.getPixel({6, 4}) == sf::Color::Green);
+  REQUIRE(sheet.getPixel({9, 4}) == sf::Color::Blue);
+  REQUIRE(sheet.getPixel({14, 4}) == sf::Color::Green);
+}
+
+TEST_CASE("SpriteRasterizer draws projected views nearest on top",
+          "[SpriteRasterizer]") {
+  // a red voxel in front of a blue one, the mesh lists red's face first
+  hollow_lantern::ModelData model_data;
+  model_data.size = {1, 1, 3};
+  model_data.voxel_data.assign(
+      1, std::vector<std::vector<hollow_lantern::Voxel>>(
+             1, std::vector<hollow_lantern::Voxel>(3)));
+  model_data.voxel_data[0][0][0] = {sf::Color::Red, true};
+  model_data.voxel_data[0][0][2] = {sf::Color::Blue, true};
+  hollow_lantern::VoxManipulator().HollowAndMesh(model_data);
+
+  // default options keep every face in mesh order, then strips and batches
+  // rewrite the order again
+  hollow_lantern::ProjectionOptions projection;
+  hollow_lantern::Projector(projection).BasicProjection(
+      model_data, {0.0f, 0.0f, 0.0f}, 1, {0.0f, 1.0f, 0.0f});
+  projection.batch_by_color = true;
+  projection.triangle_strips = true;
+  hollow_lantern::Projector(projection).BasicProjection(
+      model_data, {0.0f, 0.0f, 0.0f}, 1, {0.0f, 1.0f, 0.0f});
+  REQUIRE(model_data.projected_depths.size() == 2);
+  for (size_t view = 0; view < 2; ++view) {
+    REQUIRE(model_data.projected_depths[view].size() ==
+            model_data.projected_data[view].getVertexCount());
+  }
+
+  hollow_lantern::SpriteSheetOptions options;
+  options.pixels_per_unit = 4.0f;
+  options.padding = 0;
+  options.columns = 2;
+  const hollow_lantern::SpriteRasterizer rasterizer(options);
+  const sf::Image sheet = rasterizer.RasterizeSheet(
+      model_data.projected_data, model_data.projected_depths);
+  REQUIRE(sheet.getSize() == sf::Vector2u(8, 4));
+  for (unsigned int y = 0; y < 4; ++y) {
+    for (unsigned int x = 0; x < 8; ++x)
+      REQUIRE(sheet.getPixel({x, y}) == sf::Color::Red);
+  }
+
+  // without depths the later blue face is drawn over the nearer red one
+  REQUIRE(rasterizer.RasterizeSheet(model_data.projected_data)
+              .getPixel({1, 1}) == sf::Color::Blue);
+}
+
+TEST_CASE("SpriteRasterizer returns an empty sheet without views",
+          "[SpriteRasterizer]") {
+  const sf::Image sheet = hollow_lantern::SpriteRasterizer().RasterizeSheet({});
+  REQUIRE(sheet.getSize() == sf::Vector2u(0, 0));
+}
@@ -0,0 +1,52 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Helpers shared by the unit tests of projected views
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include <SFML/Graphics/PrimitiveType.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
+#include <cmath>
+
+namespace hollow_lantern::testing {
+
+/////////////////////////////////////////////////
+/// @brief Append a w by h rectangle at (x, y) as two triangles
+/////////////////////////////////////////////////
+inline void AppendRectangle(sf::VertexArray &view, float x, float y, float w,
+                            float h, sf::Color color) {
+  for (const sf::Vector2f &corner :
+       {sf::Vector2f(x, y), sf::Vector2f(x + w, y), sf::Vector2f(x + w, y + h),
+        sf::Vector2f(x, y), sf::Vector2f(x + w, y + h),
+        sf::Vector2f(x, y + h)}) {
+    view.append(sf::Vertex{corner, color});
+  }
+}
+
+/////////////////////////////////////////////////
+/// @brief Area covered by the triangles of a list or strip of one colour
+/////////////////////////////////////////////////
+inline float ColorArea(const sf::VertexArray &view, sf::Color color) {
+  const size_t step =
+      view.getPrimitiveType() == sf::PrimitiveType::TriangleStrip ? 1 : 3;
+  float area = 0.0f;
+  for (size_t vertex = 0; vertex + 2 < view.getVertexCount(); vertex += step) {
+    if (view[vertex].color != color)
+      continue;
+    const sf::Vector2f a = view[vertex].position;
+    const sf::Vector2f b = view[vertex + 1].position;
+    const sf::Vector2f c = view[vertex + 2].position;
+    area += std::abs((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x)) *
+            0.5f;
+  }
+  return area;
+}
+
+} // namespace hollow_lantern::testing
@@ -0,0 +1,94 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Unit tests for the TriangleStripper class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "TriangleStripper.h"
+#include "TestViews.h"
+#include <SFML/Graphics/VertexArray.hpp>
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+namespace {
+/////////////////////////////////////////////////
+/// @brief Append a unit quad at (x, y) split the way the mesher splits it
+/////////////////////////////////////////////////
+void AppendQuad(sf::VertexArray &view, float x, float y, sf::Color color) {
+  const sf::Vector2f a(x, y);
+  const sf::Vector2f b(x + 1.0f, y);
+  const sf::Vector2f c(x, y + 1.0f);
+  const sf::Vector2f d(x + 1.0f, y + 1.0f);
+  for (const sf::Vector2f &corner : {a, b, c, b, d, c})
+    view.append(sf::Vertex{corner, color});
+}
+} // namespace
+
+using hollow_lantern::testing::ColorArea;
+
+TEST_CASE("TriangleStripper turns a run of quads into one strip",
+          "[TriangleStripper]") {
+  sf::VertexArray view(sf::PrimitiveType::Triangles);
+  for (int y = 0; y < 4; ++y)
+    AppendQuad(view, 0.0f, static_cast<float>(y), sf::Color::Red);
+  REQUIRE(view.getVertexCount() == 24);
+
+  std::vector<size_t> origins;
+  const sf::VertexArray strip =
+      hollow_lantern::TriangleStripper().Stripify(view, &origins);
+  REQUIRE(strip.getPrimitiveType() == sf::PrimitiveType::TriangleStrip);
+  // two vertices per quad plus two
+  REQUIRE(strip.getVertexCount() == 10);
+  REQUIRE(ColorArea(strip, sf::Color::Red) == Catch::Approx(4.0f));
+
+  // each strip triangle reads its list triangle's corners in order, the
+  // last two swapped on odd triangles
+  REQUIRE(origins.size() == strip.getVertexCount());
+  for (size_t tri = 0; tri + 2 < strip.getVertexCount(); ++tri) {
+    const size_t list_tri = origins[tri + 2] / 3;
+    REQUIRE(list_tri == tri);
+    const size_t second = tri % 2 == 0 ? 1 : 2;
+    REQUIRE(strip[tri].position == view[list_tri * 3].position);
+    REQUIRE(strip[tri + 1].position == view[list_tri * 3 + second].position);
+    REQUIRE(strip[tri + 2].position ==
+            view[list_tri * 3 + 3 - second].position);
+  }
+}
+
+TEST_CASE("TriangleStripper joins strips without drawing between them",
+          "[TriangleStripper]") {
+  // two runs of different colours side by side
+  sf::VertexArray view(sf::PrimitiveType::Triangles);
+  for (int y = 0; y < 3; ++y)
+    AppendQuad(view, 0.0f, static_cast<float>(y), sf::Color::Red);
+  for (int y = 0; y < 3; ++y)
+    AppendQuad(view, 1.0f, static_cast<float>(y), sf::Color::Blue);
+
+  const sf::VertexArray strip =
+      hollow_lantern::TriangleStripper().Stripify(view);
+  REQUIRE(strip.getPrimitiveType() == sf::PrimitiveType::TriangleStrip);
+  // 8 vertices a run and 2 to join them, against 36 as a list
+  REQUIRE(strip.getVertexCount() == 18);
+  REQUIRE(ColorArea(strip, sf::Color::Red) == Catch::Approx(3.0f));
+  REQUIRE(ColorArea(strip, sf::Color::Blue) == Catch::Approx(3.0f));
+}
+
+TEST_CASE("TriangleStripper keeps lists that would not shrink",
+          "[TriangleStripper]") {
+  // lone triangles cost more as a strip, as every join adds two vertices
+  sf::VertexArray view(sf::PrimitiveType::Triangles);
+  for (const sf::Vector2f &corner :
+       {sf::Vector2f(0.0f, 0.0f), sf::Vector2f(1.0f, 0.0f),
+        sf::Vector2f(0.0f, 1.0f), sf::Vector2f(3.0f, 0.0f),
+        sf::Vector2f(4.0f, 0.0f), sf::Vector2f(3.0f, 1.0f)}) {
+    view.append(sf::Vertex{corner, sf::Color::Red});
+  }
+
+  const sf::VertexArray kept =
+      hollow_lantern::TriangleStripper().Stripify(view);
+  REQUIRE(kept.getPrimitiveType() == sf::PrimitiveType::Triangles);
+  REQUIRE(kept.getVertexCount() == view.getVertexCount());
+}
@@ -0,0 +1,61 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Unit tests for the batched vertex transform kernel
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "VertexTransform.h"
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/glm.hpp>
+
+TEST_CASE("TransformVertices matches glm", "[VertexTransform]") {
+  // an odd count exercises the scalar tail after the SIMD blocks
+  hollow_lantern::VertexBuffer input;
+  for (int idx = 0; idx < 37; ++idx) {
+    input.x.push_back(static_cast<float>(idx) * 0.5f);
+    input.y.push_back(static_cast<float>(idx % 7) - 3.0f);
+    input.z.push_back(static_cast<float>(idx % 5) * 2.0f);
+  }
+  const glm::mat4 matrix =
+      glm::rotate(glm::mat4(1.0f), glm::radians(30.0f),
+                  glm::vec3(1.0f, 0.0f, 0.0f)) *
+      glm::rotate(glm::mat4(1.0f), glm::radians(45.0f),
+                  glm::vec3(0.0f, 1.0f, 0.0f)) *
+      glm::translate(glm::mat4(1.0f), glm::vec3(-4.0f, -2.0f, 1.0f));
+
+  hollow_lantern::VertexBuffer output;
+  hollow_lantern::TransformVertices(matrix, input, output);
+  REQUIRE(output.Size() == input.Size());
+  for (size_t idx = 0; idx < input.Size(); ++idx) {
+    const glm::vec4 expected =
+        matrix * glm::vec4(input.x[idx], input.y[idx], input.z[idx], 1.0f);
+    REQUIRE(output.x[idx] == Catch::Approx(expected.x).margin(1e-5));
+    REQUIRE(output.y[idx] == Catch::Approx(expected.y).margin(1e-5));
+    REQUIRE(output.z[idx] == Catch::Approx(expected.z).margin(1e-5));
+  }
+
+  // x and y only
+  hollow_lantern::VertexBuffer flat;
+  hollow_lantern::TransformVertices(matrix, input, flat, false);
+  REQUIRE(flat.x == output.x);
+  REQUIRE(flat.y == output.y);
+  REQUIRE(flat.z.empty());
+}
+
+TEST_CASE("VertexBuffer gathers triangles vertex by vertex",
+          "[VertexTransform]") {
+  std::vector<hollow_lantern::Triangle> triangles{
+      {{0.f, 1.f, 2.f}, {3.f, 4.f, 5.f}, {6.f, 7.f, 8.f}, sf::Color::Red,
+       hollow_lantern::Direction::X_POSITIVE},
+      {{9.f, 10.f, 11.f}, {12.f, 13.f, 14.f}, {15.f, 16.f, 17.f},
+       sf::Color::Red, hollow_lantern::Direction::X_POSITIVE}};
+  const auto buffer = hollow_lantern::VertexBuffer::FromTriangles(triangles);
+  REQUIRE(buffer.Size() == 6);
+  REQUIRE(buffer.x[4] == 12.f);
+  REQUIRE(buffer.y[4] == 13.f);
+  REQUIRE(buffer.z[4] == 14.f);
+}
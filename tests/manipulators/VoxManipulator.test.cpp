@@ -8,7 +8,11 @@
 /////////////////////////////////////////////////
 #include "VoxManipulator.h"
 #include "VoxReader.h"
+#include "catch2/catch_approx.hpp"
 #include "catch2/catch_test_macros.hpp"
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <array>
 #include <iostream>
 
 TEST_CASE("VoxManipulator provides VoxData object", "[VoxManipulator]") {
@@ -106,3 +110,433 @@ TEST_CASE("VoxManipulator provides VoxData object", "[VoxManipulator]") {
   // should be 200 triangles generated per face so 1000 triangles in total
   REQUIRE(model_data.triangles.size() == 1200);
 }
+
+TEST_CASE("VoxManipulator only remeshes chunks touched by edits",
+          "[VoxManipulator]") {
+  // solid 40x8x8 box, three chunks along x
+  hollow_lantern::ModelData model_data;
+  model_data.size = {40, 8, 8};
+  model_data.voxel_data.resize(40);
+  for (auto &plane : model_data.voxel_data) {
+    plane.resize(8);
+    for (auto &row : plane) {
+      row.resize(8);
+      for (auto &voxel : row) {
+        voxel.color = sf::Color::Red;
+        voxel.is_visible = true;
+      }
+    }
+  }
+
+  hollow_lantern::VoxManipulator manipulator;
+  manipulator.HollowAndMesh(model_data);
+  REQUIRE(model_data.chunks.size() == 3);
+  // 2 * (40*8 + 40*8 + 8*8) faces, two triangles each
+  REQUIRE(model_data.triangles.size() == 2816);
+
+  // clearing a surface voxel on the chunk 0/1 border only dirties those two
+  REQUIRE(manipulator.ClearVoxel(model_data, {16, 0, 3}));
+  REQUIRE(model_data.chunks[0].is_dirty);
+  REQUIRE(model_data.chunks[1].is_dirty);
+  REQUIRE_FALSE(model_data.chunks[2].is_dirty);
+
+  manipulator.Remesh(model_data);
+  // loses one face, exposes five neighbour faces
+  REQUIRE(model_data.triangles.size() == 2824);
+  size_t chunk_triangles = 0;
+  for (const auto &chunk : model_data.chunks) {
+    REQUIRE_FALSE(chunk.is_dirty);
+    REQUIRE(chunk.triangle_offset == chunk_triangles);
+    chunk_triangles += chunk.triangle_count;
+  }
+  REQUIRE(chunk_triangles == model_data.triangles.size());
+
+  // putting the voxel back restores the original mesh
+  manipulator.ApplyVoxelEdits(model_data, {{{16, 0, 3}, sf::Color::Red},
+                                           {{99, 0, 0}, std::nullopt}});
+  manipulator.Remesh(model_data);
+  REQUIRE(model_data.triangles.size() == 2816);
+
+  REQUIRE_FALSE(
+      manipulator.SetVoxel(model_data, {40, 0, 0}, sf::Color::Red));
+}
+
+TEST_CASE("VoxManipulator generates levels of detail", "[VoxManipulator]") {
+  hollow_lantern::VoxReader vox_reader;
+  auto result = vox_reader.ProvideVoxData("simple_cube", true);
+  REQUIRE(result.has_value());
+  hollow_lantern::ModelData model_data = result.value();
+
+  hollow_lantern::VoxManipulator manipulator;
+  manipulator.HollowAndMesh(model_data);
+  manipulator.GenerateLevelsOfDetail(model_data);
+
+  // 10^3 solid cube becomes 5^3, 3^3 and 2^3 cubes
+  REQUIRE(model_data.levels_of_detail.size() == 3);
+  const std::array<int, 3> expected_sizes{5, 3, 2};
+  for (size_t level = 0; level < 3; ++level) {
+    const auto &coarse = model_data.levels_of_detail[level];
+    const int edge = expected_sizes[level];
+    REQUIRE(coarse.voxel_scale == 2 << level);
+    REQUIRE(coarse.size == sf::Vector3i(edge, edge, edge));
+    // one quad per surface voxel face
+    REQUIRE(coarse.triangles.size() ==
+            static_cast<size_t>(6 * edge * edge * 2));
+    REQUIRE(coarse.voxel_data[0][0][0].color ==
+            model_data.voxel_data[0][0][0].color);
+  }
+}
+
+TEST_CASE("VoxManipulator leaves sealed cavities out of the mesh",
+          "[VoxManipulator]") {
+  // solid 8^3 box with a sealed 4^3 air pocket in the middle
+  hollow_lantern::ModelData model_data;
+  model_data.size = {8, 8, 8};
+  model_data.voxel_data.resize(8);
+  for (int x = 0; x < 8; ++x) {
+    model_data.voxel_data[x].resize(8);
+    for (int y = 0; y < 8; ++y) {
+      model_data.voxel_data[x][y].resize(8);
+      for (int z = 0; z < 8; ++z) {
+        auto &voxel = model_data.voxel_data[x][y][z];
+        voxel.color = sf::Color::Blue;
+        voxel.is_visible = !(x >= 2 && x < 6 && y >= 2 && y < 6 && z >= 2 &&
+                             z < 6);
+      }
+    }
+  }
+
+  hollow_lantern::VoxManipulator manipulator;
+  manipulator.HollowAndMesh(model_data);
+  REQUIRE_FALSE(model_data.exterior_air[3][3][3]);
+  // only the outer shell is meshed
+  REQUIRE(model_data.triangles.size() == 6 * 64 * 2);
+
+  // drilling a tunnel into the pocket exposes it
+  manipulator.ClearVoxel(model_data, {0, 3, 3});
+  manipulator.ClearVoxel(model_data, {1, 3, 3});
+  manipulator.Remesh(model_data);
+  REQUIRE(model_data.exterior_air[3][3][3]);
+  // shell loses one face, tunnel adds eight and the pocket shows 95
+  REQUIRE(model_data.triangles.size() == (384 - 1 + 8 + 95) * 2);
+
+  // plugging the tunnel seals the pocket off again, the plugged tunnel end
+  // stays open to the outside
+  manipulator.SetVoxel(model_data, {1, 3, 3}, sf::Color::Blue);
+  REQUIRE_FALSE(model_data.exterior_air[3][3][3]);
+  REQUIRE(model_data.exterior_air[0][3][3]);
+  manipulator.SetVoxel(model_data, {0, 3, 3}, sf::Color::Blue);
+  REQUIRE_FALSE(model_data.exterior_air[0][3][3]);
+  manipulator.Remesh(model_data);
+  REQUIRE(model_data.triangles.size() == 6 * 64 * 2);
+}
+
+TEST_CASE("VoxManipulator greedy meshing merges faces within a tolerance",
+          "[VoxManipulator]") {
+  // sum of triangle areas, to check quads still cover the whole surface
+  auto surface_area = [](const std::vector<hollow_lantern::Triangle> &tris) {
+    float area = 0.0f;
+    for (const auto &tri : tris) {
+      area += 0.5f * glm::length(glm::cross(tri.vertices[1] - tri.vertices[0],
+                                            tri.vertices[2] - tri.vertices[0]));
+    }
+    return area;
+  };
+
+  hollow_lantern::MeshingOptions greedy;
+  greedy.mode = hollow_lantern::MeshingMode::GREEDY;
+
+  // a single coloured cube collapses to one quad per side
+  hollow_lantern::VoxReader vox_reader;
+  auto result = vox_reader.ProvideVoxData("simple_cube", true);
+  REQUIRE(result.has_value());
+  hollow_lantern::ModelData cube = result.value();
+  hollow_lantern::VoxManipulator(greedy).HollowAndMesh(cube);
+  REQUIRE(cube.triangles.size() == 12);
+  REQUIRE(surface_area(cube.triangles) == Catch::Approx(600.0f));
+
+  // 8x8x1 slab dithered between two nearly identical greys
+  hollow_lantern::ModelData slab;
+  slab.size = {8, 8, 1};
+  slab.voxel_data.resize(8);
+  for (int x = 0; x < 8; ++x) {
+    slab.voxel_data[x].resize(8);
+    for (int y = 0; y < 8; ++y) {
+      slab.voxel_data[x][y].resize(1);
+      auto &voxel = slab.voxel_data[x][y][0];
+      voxel.color = (x + y) % 2 == 0 ? sf::Color(100, 100, 100)
+                                     : sf::Color(102, 102, 102);
+      voxel.is_visible = true;
+    }
+  }
+
+  // exact colour matching can't merge a checkerboard at all
+  hollow_lantern::ModelData exact = slab;
+  hollow_lantern::VoxManipulator(greedy).HollowAndMesh(exact);
+  REQUIRE(exact.triangles.size() == (64 * 2 + 32) * 2);
+
+  // with a tolerance every side is one quad in the mean colour
+  greedy.color_tolerance = 10.0f;
+  hollow_lantern::ModelData tolerant = slab;
+  hollow_lantern::VoxManipulator(greedy).HollowAndMesh(tolerant);
+  REQUIRE(tolerant.triangles.size() == 12);
+  REQUIRE(surface_area(tolerant.triangles) == Catch::Approx(160.0f));
+  for (const auto &triangle : tolerant.triangles) {
+    REQUIRE(triangle.color == sf::Color(101, 101, 101));
+  }
+}
+
+TEST_CASE("VoxManipulator atlas meshing ignores colour boundaries",
+          "[VoxManipulator]") {
+  // 8x8x1 slab in a red/blue checkerboard
+  hollow_lantern::ModelData slab;
+  slab.size = {8, 8, 1};
+  slab.voxel_data.resize(8);
+  for (int x = 0; x < 8; ++x) {
+    slab.voxel_data[x].resize(8);
+    for (int y = 0; y < 8; ++y) {
+      slab.voxel_data[x][y].resize(1);
+      auto &voxel = slab.voxel_data[x][y][0];
+      voxel.color = (x + y) % 2 == 0 ? sf::Color::Red : sf::Color::Blue;
+      voxel.is_visible = true;
+    }
+  }
+
+  hollow_lantern::MeshingOptions atlas_meshing;
+  atlas_meshing.mode = hollow_lantern::MeshingMode::GREEDY_ATLAS;
+  hollow_lantern::VoxManipulator(atlas_meshing).HollowAndMesh(slab);
+
+  // one quad per side however it is painted
+  REQUIRE(slab.triangles.size() == 12);
+  const auto &atlas = slab.color_atlas;
+  REQUIRE(atlas.pixels.size() == atlas.size.x * atlas.size.y);
+  REQUIRE(atlas.pixels.size() >= 160);
+
+  for (const auto &triangle : slab.triangles) {
+    if (triangle.direction != hollow_lantern::Direction::Z_POSITIVE)
+      continue;
+    // tile origin is voxel (0,0), columns run along y
+    glm::vec2 origin = triangle.tex_coords[0];
+    for (const auto &tex_coord : triangle.tex_coords) {
+      REQUIRE(tex_coord.x <= static_cast<float>(atlas.size.x));
+      REQUIRE(tex_coord.y <= static_cast<float>(atlas.size.y));
+      origin.x = std::min(origin.x, tex_coord.x);
+      origin.y = std::min(origin.y, tex_coord.y);
+    }
+    const size_t texel = static_cast<size_t>(origin.y) * atlas.size.x +
+                         static_cast<size_t>(origin.x);
+    REQUIRE(atlas.pixels[texel] == sf::Color::Red);
+    REQUIRE(atlas.pixels[texel + 1] == sf::Color::Blue);
+    REQUIRE(atlas.pixels[texel + atlas.size.x] == sf::Color::Blue);
+  }
+}
+
+TEST_CASE("VoxManipulator only repacks the atlas tiles of remeshed chunks",
+          "[VoxManipulator]") {
+  // 40x8x8 box in stripes of three colours, three chunks along x
+  hollow_lantern::ModelData model_data;
+  model_data.size = {40, 8, 8};
+  model_data.voxel_data.resize(40);
+  const std::array<sf::Color, 3> stripes{sf::Color::Red, sf::Color::Green,
+                                         sf::Color::Blue};
+  for (int x = 0; x < 40; ++x) {
+    model_data.voxel_data[x].resize(8);
+    for (int y = 0; y < 8; ++y) {
+      model_data.voxel_data[x][y].resize(8);
+      for (int z = 0; z < 8; ++z) {
+        auto &voxel = model_data.voxel_data[x][y][z];
+        voxel.color = stripes[(x + 2 * y + z) % 3];
+        voxel.is_visible = true;
+      }
+    }
+  }
+
+  hollow_lantern::MeshingOptions atlas_meshing;
+  atlas_meshing.mode = hollow_lantern::MeshingMode::GREEDY_ATLAS;
+  hollow_lantern::VoxManipulator manipulator(atlas_meshing);
+  manipulator.HollowAndMesh(model_data);
+  REQUIRE(model_data.chunks.size() == 3);
+
+  // texels under one quad, found through its tex_coords
+  auto quad_texels = [](const hollow_lantern::ModelData &model,
+                        size_t first_triangle) {
+    glm::vec2 lower = model.triangles[first_triangle].tex_coords[0];
+    glm::vec2 upper = lower;
+    for (size_t tri = first_triangle; tri < first_triangle + 2; ++tri) {
+      for (const auto &tex_coord : model.triangles[tri].tex_coords) {
+        lower = glm::min(lower, tex_coord);
+        upper = glm::max(upper, tex_coord);
+      }
+    }
+    std::vector<sf::Color> texels;
+    for (int v = static_cast<int>(lower.y); v < static_cast<int>(upper.y);
+         ++v) {
+      for (int u = static_cast<int>(lower.x); u < static_cast<int>(upper.x);
+           ++u) {
+        texels.push_back(model.color_atlas.pixels[v * model.color_atlas.size.x +
+                                                  u]);
+      }
+    }
+    return texels;
+  };
+  // every quad shows the same colours as it would after meshing from scratch
+  auto require_fresh_texels = [&](const hollow_lantern::ModelData &model) {
+    hollow_lantern::ModelData fresh;
+    fresh.size = model.size;
+    fresh.voxel_data = model.voxel_data;
+    manipulator.HollowAndMesh(fresh);
+    REQUIRE(model.triangles.size() == fresh.triangles.size());
+    for (size_t idx = 0; idx + 1 < model.triangles.size(); idx += 2)
+      REQUIRE(quad_texels(model, idx) == quad_texels(fresh, idx));
+  };
+  auto chunk_tex_coords = [](const hollow_lantern::ModelData &model,
+                             const hollow_lantern::Chunk &chunk) {
+    std::vector<std::array<glm::vec2, 3>> tex_coords;
+    for (size_t idx = chunk.triangle_offset;
+         idx < chunk.triangle_offset + chunk.triangle_count; ++idx) {
+      tex_coords.push_back(model.triangles[idx].tex_coords);
+    }
+    return tex_coords;
+  };
+
+  const auto atlas_size = model_data.color_atlas.size;
+  const auto untouched = chunk_tex_coords(model_data, model_data.chunks[2]);
+
+  SECTION("repainting a voxel reuses its tiles' space") {
+    REQUIRE(manipulator.SetVoxel(model_data, {3, 0, 3}, sf::Color::White));
+    manipulator.Remesh(model_data);
+    REQUIRE(model_data.color_atlas.size == atlas_size);
+  }
+  SECTION("new faces go in free space or a shelf added below") {
+    REQUIRE(manipulator.ClearVoxel(model_data, {16, 0, 3}));
+    manipulator.Remesh(model_data);
+    REQUIRE(model_data.color_atlas.size.x == atlas_size.x);
+    REQUIRE(model_data.color_atlas.size.y >= atlas_size.y);
+  }
+  REQUIRE(chunk_tex_coords(model_data, model_data.chunks[2]) == untouched);
+  require_fresh_texels(model_data);
+}
+
+TEST_CASE("VoxManipulator only meshes the occupied part of the canvas",
+          "[VoxManipulator]") {
+  // 2x2x2 cube in the far corner of a 40^3 canvas
+  hollow_lantern::ModelData model_data;
+  model_data.size = {40, 40, 40};
+  model_data.voxel_data.assign(
+      40, std::vector<std::vector<hollow_lantern::Voxel>>(
+              40, std::vector<hollow_lantern::Voxel>(40)));
+  for (int x = 36; x < 38; ++x) {
+    for (int y = 36; y < 38; ++y) {
+      for (int z = 36; z < 38; ++z) {
+        model_data.voxel_data[x][y][z].color = sf::Color::Green;
+        model_data.voxel_data[x][y][z].is_visible = true;
+      }
+    }
+  }
+
+  hollow_lantern::VoxManipulator manipulator;
+  manipulator.HollowAndMesh(model_data);
+  const auto &occupancy = model_data.occupancy;
+  REQUIRE(occupancy.bounds.min == sf::Vector3i(36, 36, 36));
+  REQUIRE(occupancy.bounds.max == sf::Vector3i(38, 38, 38));
+  REQUIRE(occupancy.slice_counts[0][36] == 4);
+  REQUIRE(occupancy.slice_counts[0][0] == 0);
+  REQUIRE(occupancy.row_counts[1][37][36] == 2);
+  // 4 faces per side, 6 sides, two triangles each
+  REQUIRE(model_data.triangles.size() == 48);
+
+  // growing the model grows the bounds
+  manipulator.SetVoxel(model_data, {2, 36, 36}, sf::Color::Green);
+  REQUIRE(occupancy.bounds.min == sf::Vector3i(2, 36, 36));
+  manipulator.Remesh(model_data);
+  REQUIRE(model_data.triangles.size() == 60);
+
+  // clearing the outlier shrinks them again and leaves no stale faces
+  manipulator.ClearVoxel(model_data, {2, 36, 36});
+  REQUIRE(occupancy.bounds.min == sf::Vector3i(36, 36, 36));
+  manipulator.Remesh(model_data);
+  REQUIRE(model_data.triangles.size() == 48);
+  for (const auto &triangle : model_data.triangles) {
+    for (const auto &vertex : triangle.vertices) {
+      REQUIRE(vertex.x >= 36.f);
+      REQUIRE(vertex.x <= 38.f);
+    }
+  }
+
+  // clearing everything leaves an empty mesh
+  for (int x = 36; x < 38; ++x) {
+    for (int y = 36; y < 38; ++y) {
+      for (int z = 36; z < 38; ++z) {
+        manipulator.ClearVoxel(model_data, {x, y, z});
+      }
+    }
+  }
+  REQUIRE(occupancy.bounds.IsEmpty());
+  manipulator.Remesh(model_data);
+  REQUIRE(model_data.triangles.empty());
+
+  // voxels edited directly are picked up by meshing again
+  model_data.voxel_data[5][6][7] = {sf::Color::Green, true};
+  model_data.voxel_data[20][20][20] = {sf::Color::Green, true};
+  manipulator.HollowAndMesh(model_data);
+  REQUIRE(occupancy.bounds.min == sf::Vector3i(5, 6, 7));
+  REQUIRE(model_data.triangles.size() == 24);
+
+  // and voxels cleared directly leave nothing behind in the masks, even in
+  // rows that are now empty and skipped
+  model_data.voxel_data[5][6][7].is_visible = false;
+  model_data.voxel_data[4][4][4] = {sf::Color::Green, true};
+  manipulator.HollowAndMesh(model_data);
+  REQUIRE(occupancy.bounds.min == sf::Vector3i(4, 4, 4));
+  REQUIRE(model_data.triangles.size() == 24);
+  REQUIRE_FALSE(model_data.masks[0].data[5][6][7].has_value());
+  REQUIRE_FALSE(model_data.masks[1].data[5][6][7].has_value());
+}
+
+TEST_CASE("VoxManipulator meshes crops without touching the model",
+          "[VoxManipulator]") {
+  // solid 8x8x8 cube
+  hollow_lantern::ModelData model_data;
+  model_data.size = {8, 8, 8};
+  model_data.voxel_data.assign(
+      8, std::vector<std::vector<hollow_lantern::Voxel>>(
+             8, std::vector<hollow_lantern::Voxel>(8)));
+  for (auto &plane : model_data.voxel_data) {
+    for (auto &row : plane) {
+      for (auto &voxel : row) {
+        voxel.color = sf::Color::Red;
+        voxel.is_visible = true;
+      }
+    }
+  }
+  hollow_lantern::VoxManipulator manipulator;
+  manipulator.HollowAndMesh(model_data);
+  const size_t model_triangles = model_data.triangles.size();
+
+  // the middle of the cube is closed off where the crop cuts through it
+  hollow_lantern::ModelData cropped =
+      manipulator.CropAndMesh(model_data, {{2, 2, 2}, {6, 6, 6}});
+  REQUIRE(cropped.size == sf::Vector3i(4, 4, 4));
+  REQUIRE(cropped.origin == sf::Vector3i(2, 2, 2));
+  REQUIRE(cropped.voxel_data.empty());
+  // 16 faces per side, 6 sides, two triangles each
+  REQUIRE(cropped.triangles.size() == 192);
+  for (const auto &triangle : cropped.triangles) {
+    for (const auto &vertex : triangle.vertices) {
+      REQUIRE(vertex.x >= 0.f);
+      REQUIRE(vertex.x <= 4.f);
+    }
+  }
+  REQUIRE(model_data.triangles.size() == model_triangles);
+
+  // a crop covering the whole model matches meshing the model itself
+  hollow_lantern::ModelData whole =
+      manipulator.CropAndMesh(model_data, {{-5, -5, -5}, {20, 20, 20}});
+  REQUIRE(whole.size == model_data.size);
+  REQUIRE(whole.triangles.size() == model_triangles);
+
+  // crops outside the model are empty rather than out of bounds
+  hollow_lantern::ModelData outside =
+      manipulator.CropAndMesh(model_data, {{10, 10, 10}, {12, 12, 12}});
+  REQUIRE(outside.triangles.empty());
+}
@@ -0,0 +1,116 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Unit tests for the VoxelRayCaster class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "VoxManipulator.h"
+#include "VoxReader.h"
+#include "VoxelRayCaster.h"
+#include <catch2/catch_test_macros.hpp>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/glm.hpp>
+
+TEST_CASE("VoxelRayCaster only sees faces in front of everything else",
+          "[VoxelRayCaster]") {
+  // a red voxel at z = 0 in front of a blue one at z = 2, and a green one off
+  // to the side at z = 3 that nothing covers
+  hollow_lantern::ModelData model_data;
+  model_data.size = {2, 1, 4};
+  model_data.voxel_data.assign(
+      2, std::vector<std::vector<hollow_lantern::Voxel>>(
+             1, std::vector<hollow_lantern::Voxel>(4)));
+  model_data.voxel_data[0][0][0] = {sf::Color::Red, true};
+  model_data.voxel_data[0][0][2] = {sf::Color::Blue, true};
+  model_data.voxel_data[1][0][3] = {sf::Color::Green, true};
+  hollow_lantern::VoxManipulator().HollowAndMesh(model_data);
+
+  const hollow_lantern::VoxelRayCaster caster(model_data);
+  const glm::mat4 straight_on(1.0f);
+  const auto hits = caster.CastRays(straight_on);
+  REQUIRE(hits.IsHit(hollow_lantern::Direction::Z_NEGATIVE, 0, 0, 0));
+  REQUIRE(hits.IsHit(hollow_lantern::Direction::Z_NEGATIVE, 1, 0, 3));
+  REQUIRE_FALSE(hits.IsHit(hollow_lantern::Direction::Z_NEGATIVE, 0, 0, 2));
+  // only the two faces struck are kept, however many rays struck them
+  REQUIRE(hits.faces.size() == 2);
+
+  const auto visible = caster.VisibleTriangles(model_data.triangles,
+                                               straight_on);
+  REQUIRE(visible.size() == model_data.triangles.size());
+  for (size_t idx = 0; idx < visible.size(); ++idx) {
+    const auto &triangle = model_data.triangles[idx];
+    const bool expected =
+        triangle.direction == hollow_lantern::Direction::Z_NEGATIVE &&
+        triangle.color != sf::Color::Blue;
+    REQUIRE(visible[idx] == expected);
+  }
+}
+
+TEST_CASE("VoxelRayCaster hits the front voxel of every column",
+          "[VoxelRayCaster]") {
+  hollow_lantern::VoxReader vox_reader;
+  auto result = vox_reader.ProvideVoxData("chr_knight", true);
+  REQUIRE(result.has_value());
+  hollow_lantern::ModelData model_data = result.value();
+  hollow_lantern::VoxManipulator().HollowAndMesh(model_data);
+  const sf::Vector3i size = model_data.size;
+  const hollow_lantern::VoxelRayCaster caster(model_data);
+
+  SECTION("looking straight down +z") {
+    const auto hits = caster.CastRays(glm::mat4(1.0f));
+    for (int x = 0; x < size.x; ++x) {
+      for (int y = 0; y < size.y; ++y) {
+        int front = -1;
+        for (int z = 0; z < size.z && front == -1; ++z) {
+          if (model_data.voxel_data[x][y][z].is_visible)
+            front = z;
+        }
+        for (int z = 0; z < size.z; ++z) {
+          REQUIRE(hits.IsHit(hollow_lantern::Direction::Z_NEGATIVE, x, y, z) ==
+                  (z == front));
+        }
+      }
+    }
+  }
+
+  SECTION("from a tilted angle every hit face is exposed to the camera") {
+    const glm::mat4 rotation =
+        glm::rotate(glm::mat4(1.0f), glm::radians(30.0f),
+                    glm::vec3(1.0f, 0.0f, 0.0f)) *
+        glm::rotate(glm::mat4(1.0f), glm::radians(40.0f),
+                    glm::vec3(0.0f, 1.0f, 0.0f));
+    const auto hits = caster.CastRays(rotation);
+    const std::array<sf::Vector3i, 6> normals{
+        sf::Vector3i(1, 0, 0), sf::Vector3i(-1, 0, 0), sf::Vector3i(0, 1, 0),
+        sf::Vector3i(0, -1, 0), sf::Vector3i(0, 0, 1), sf::Vector3i(0, 0, -1)};
+    size_t hit_count = 0;
+    for (size_t dir = 0; dir < 6; ++dir) {
+      const auto direction = static_cast<hollow_lantern::Direction>(dir + 1);
+      const glm::vec4 normal =
+          rotation * glm::vec4(static_cast<float>(normals[dir].x),
+                               static_cast<float>(normals[dir].y),
+                               static_cast<float>(normals[dir].z), 0.0f);
+      for (int x = 0; x < size.x; ++x) {
+        for (int y = 0; y < size.y; ++y) {
+          for (int z = 0; z < size.z; ++z) {
+            if (!hits.IsHit(direction, x, y, z))
+              continue;
+            ++hit_count;
+            REQUIRE(model_data.voxel_data[x][y][z].is_visible);
+            REQUIRE(normal.z < 0.0f);
+            const sf::Vector3i next = sf::Vector3i(x, y, z) + normals[dir];
+            const bool next_inside = next.x >= 0 && next.x < size.x &&
+                                     next.y >= 0 && next.y < size.y &&
+                                     next.z >= 0 && next.z < size.z;
+            REQUIRE_FALSE(
+                (next_inside &&
+                 model_data.voxel_data[next.x][next.y][next.z].is_visible));
+          }
+        }
+      }
+    }
+    REQUIRE(hit_count > 0);
+  }
+}
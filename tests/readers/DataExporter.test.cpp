@@ -0,0 +1,134 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Unit tests for the DataExporter class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "DataExporter.h"
+#include "directory_paths.h"
+#include <SFML/Graphics/PrimitiveType.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+using json = nlohmann::json;
+
+/////////////////////////////////////////////////
+/// @brief The document ExportToJSON should write, built with nlohmann::json
+/////////////////////////////////////////////////
+json ExpectedDocument(const std::string &name,
+                      const std::vector<sf::VertexArray> &views) {
+  auto vertex_json = [](const sf::Vertex &vertex) {
+    return json{{"r", vertex.color.r}, {"g", vertex.color.g},
+                {"b", vertex.color.b}, {"a", vertex.color.a},
+                {"x", vertex.position.x}, {"y", vertex.position.y}};
+  };
+  json projections = json::array();
+  for (const sf::VertexArray &view : views) {
+    json vertices = json::array();
+    if (view.getPrimitiveType() == sf::PrimitiveType::TriangleStrip) {
+      for (size_t i = 0; i < view.getVertexCount(); ++i)
+        vertices.push_back(vertex_json(view[i]));
+      projections.push_back({{"triangle_strip", vertices}});
+      continue;
+    }
+    for (size_t i = 0; i + 2 < view.getVertexCount(); i += 3) {
+      vertices.push_back({vertex_json(view[i]), vertex_json(view[i + 1]),
+                          vertex_json(view[i + 2])});
+    }
+    projections.push_back({{"triangles", vertices}});
+  }
+  return {{"name", name}, {"projections", projections}};
+}
+
+std::string ReadFile(const std::filesystem::path &path) {
+  std::ifstream file(path);
+  return {std::istreambuf_iterator<char>(file),
+          std::istreambuf_iterator<char>()};
+}
+
+/////////////////////////////////////////////////
+/// @brief Export views through both overloads and compare them with what
+/// nlohmann::json writes for the same document
+/////////////////////////////////////////////////
+void RequireMatchesNlohmann(const std::vector<sf::VertexArray> &views,
+                            bool compact) {
+  const std::string name = "data_exporter_test";
+  const std::filesystem::path path =
+      config::getExportFolder() / (name + ".json");
+  const json expected = ExpectedDocument(name, views);
+  const std::string expected_text =
+      compact ? expected.dump() : expected.dump(4);
+
+  hollow_lantern::ExportOptions options;
+  options.compact_json = compact;
+  hollow_lantern::DataExporter exporter(options);
+
+  hollow_lantern::ModelData model_data;
+  model_data.name = name;
+  model_data.projected_data = views;
+  exporter.ExportToJSON(model_data);
+  std::string text = ReadFile(path);
+  REQUIRE(json::parse(text) == expected);
+  REQUIRE(text == expected_text);
+
+  size_t next = 0;
+  exporter.ExportToJSON(name, [&](sf::VertexArray &view) {
+    if (next == views.size())
+      return false;
+    view = views[next++];
+    return true;
+  });
+  text = ReadFile(path);
+  REQUIRE(json::parse(text) == expected);
+  REQUIRE(text == expected_text);
+  std::filesystem::remove(path);
+}
+} // namespace
+
+TEST_CASE("DataExporter writes the JSON nlohmann::json would",
+          "[DataExporter]") {
+  // positions are exact in float, so both writers print the same digits
+  sf::VertexArray triangles(sf::PrimitiveType::Triangles);
+  triangles.append(sf::Vertex{{0.0f, 0.0f}, sf::Color(10, 20, 30, 40)});
+  triangles.append(sf::Vertex{{1.5f, -0.25f}, sf::Color::Red});
+  triangles.append(sf::Vertex{{2.0f, -2.25f}, sf::Color::Blue});
+  triangles.append(sf::Vertex{{-3.0f, 0.125f}, sf::Color::Green});
+  triangles.append(sf::Vertex{{1024.5f, 7.0f}, sf::Color::Green});
+  triangles.append(sf::Vertex{{0.75f, 8.0f}, sf::Color::White});
+  sf::VertexArray strip(sf::PrimitiveType::TriangleStrip);
+  for (int i = 0; i < 5; ++i) {
+    strip.append(sf::Vertex{
+        {static_cast<float>(i / 2), static_cast<float>(i) * 0.5f},
+        sf::Color::Yellow});
+  }
+  sf::VertexArray empty(sf::PrimitiveType::Triangles);
+  // the trailing two vertices do not make a triangle and are left out
+  sf::VertexArray partial = triangles;
+  partial.append(sf::Vertex{{4.0f, 4.0f}, sf::Color::Black});
+  partial.append(sf::Vertex{{5.0f, 4.0f}, sf::Color::Black});
+
+  for (const bool compact : {false, true}) {
+    SECTION(compact ? "compact" : "indented") {
+      SECTION("a triangle list") {
+        RequireMatchesNlohmann({triangles}, compact);
+      }
+      SECTION("a triangle strip") { RequireMatchesNlohmann({strip}, compact); }
+      SECTION("an empty view") { RequireMatchesNlohmann({empty}, compact); }
+      SECTION("no views") { RequireMatchesNlohmann({}, compact); }
+      SECTION("a trailing partial triangle") {
+        RequireMatchesNlohmann({partial}, compact);
+      }
+      SECTION("several views") {
+        RequireMatchesNlohmann({triangles, empty, strip, partial}, compact);
+      }
+    }
+  }
+}
@@ -0,0 +1,130 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief units tests for MeshCache class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "MeshCache.h"
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <vector>
+
+TEST_CASE("MeshCache round trips meshed models", "[MeshCache]") {
+  std::filesystem::path cache_folder =
+      std::filesystem::temp_directory_path() / "hollow_lantern_mesh_cache";
+  std::filesystem::remove_all(cache_folder);
+  hollow_lantern::MeshCache mesh_cache(cache_folder);
+  bool testing = true;
+
+  // entries are keyed on the .vox file, so the name has to match a real one
+  hollow_lantern::ModelData model_data;
+  model_data.name = "chr_knight";
+  model_data.size = {20, 21, 22};
+  model_data.voxel_scale = 2;
+  hollow_lantern::Triangle triangle(
+      {0.f, 0.f, 1.f}, {1.f, 0.f, 1.f}, {1.f, 1.f, 1.f},
+      sf::Color(10, 20, 30, 40), hollow_lantern::Direction::Z_POSITIVE);
+  triangle.tex_coords = {glm::vec2{0.f, 0.f}, glm::vec2{1.f, 0.f},
+                         glm::vec2{1.f, 1.f}};
+  model_data.triangles = {triangle, triangle};
+  model_data.color_atlas.size = {1, 2};
+  model_data.color_atlas.pixels = {sf::Color::Red, sf::Color::Blue};
+
+  hollow_lantern::MeshingOptions greedy{hollow_lantern::MeshingMode::GREEDY};
+
+  // nothing stored yet
+  REQUIRE_FALSE(
+      mesh_cache.ProvideMeshedModel("chr_knight", greedy, testing).has_value());
+
+  mesh_cache.StoreMeshedModel(model_data, greedy, testing);
+  auto cached = mesh_cache.ProvideMeshedModel("chr_knight", greedy, testing);
+  REQUIRE(cached.has_value());
+  REQUIRE(cached->name == model_data.name);
+  REQUIRE(cached->size == model_data.size);
+  REQUIRE(cached->voxel_scale == 2);
+  REQUIRE(cached->triangles.size() == 2);
+  REQUIRE(cached->triangles[1].vertices == triangle.vertices);
+  REQUIRE(cached->triangles[1].tex_coords == triangle.tex_coords);
+  REQUIRE(cached->triangles[1].color == triangle.color);
+  REQUIRE(cached->triangles[1].direction == triangle.direction);
+  REQUIRE(cached->color_atlas.size == model_data.color_atlas.size);
+  REQUIRE(cached->color_atlas.pixels == model_data.color_atlas.pixels);
+
+  // different options are a different entry
+  hollow_lantern::MeshingOptions tolerant{hollow_lantern::MeshingMode::GREEDY,
+                                          10.f};
+  REQUIRE_FALSE(
+      mesh_cache.ProvideMeshedModel("chr_knight", tolerant, testing)
+          .has_value());
+
+  // storing again replaces the old entry rather than piling up files
+  mesh_cache.StoreMeshedModel(model_data, tolerant, testing);
+  REQUIRE_FALSE(
+      mesh_cache.ProvideMeshedModel("chr_knight", greedy, testing).has_value());
+  REQUIRE(
+      mesh_cache.ProvideMeshedModel("chr_knight", tolerant, testing)
+          .has_value());
+  // and leaves no temporary file behind
+  REQUIRE(std::distance(std::filesystem::directory_iterator(cache_folder),
+                        std::filesystem::directory_iterator()) == 1);
+
+  // models without a .vox file cannot be cached
+  model_data.name = "non_existent_file";
+  REQUIRE_THROWS(mesh_cache.StoreMeshedModel(model_data, greedy, testing));
+
+  std::filesystem::remove_all(cache_folder);
+}
+
+TEST_CASE("MeshCache ignores corrupt entries", "[MeshCache]") {
+  std::filesystem::path cache_folder =
+      std::filesystem::temp_directory_path() / "hollow_lantern_corrupt_cache";
+  std::filesystem::remove_all(cache_folder);
+  hollow_lantern::MeshCache mesh_cache(cache_folder);
+  bool testing = true;
+
+  hollow_lantern::ModelData model_data;
+  model_data.name = "chr_knight";
+  model_data.triangles.resize(1);
+  model_data.triangles[0].direction = hollow_lantern::Direction::Z_NEGATIVE;
+  model_data.color_atlas.size = {1, 1};
+  model_data.color_atlas.pixels = {sf::Color::Red};
+  hollow_lantern::MeshingOptions greedy{hollow_lantern::MeshingMode::GREEDY};
+  mesh_cache.StoreMeshedModel(model_data, greedy, testing);
+  REQUIRE(
+      mesh_cache.ProvideMeshedModel("chr_knight", greedy, testing).has_value());
+
+  std::filesystem::path entry_path =
+      std::filesystem::directory_iterator(cache_folder)->path();
+  auto overwrite = [&](std::streamoff offset, std::vector<uint32_t> values) {
+    std::fstream entry(entry_path,
+                       std::ios::in | std::ios::out | std::ios::binary);
+    entry.seekp(offset);
+    entry.write(reinterpret_cast<const char *>(values.data()),
+                static_cast<std::streamsize>(values.size() * sizeof(uint32_t)));
+  };
+
+  // the triangle's direction is its last field, just before the one pixel
+  const auto entry_size =
+      static_cast<std::streamoff>(std::filesystem::file_size(entry_path));
+  overwrite(entry_size - 8, {7});
+  std::optional<hollow_lantern::ModelData> cached;
+  REQUIRE_NOTHROW(
+      cached = mesh_cache.ProvideMeshedModel("chr_knight", greedy, testing));
+  REQUIRE_FALSE(cached.has_value());
+
+  // overwrite the atlas size, which follows the magic, version, hash, size
+  // and voxel_scale, with one whose pixel count wraps when turned into bytes
+  mesh_cache.StoreMeshedModel(model_data, greedy, testing);
+  overwrite(32, {0x80000000u, 0x80000000u});
+  REQUIRE_NOTHROW(
+      cached = mesh_cache.ProvideMeshedModel("chr_knight", greedy, testing));
+  REQUIRE_FALSE(cached.has_value());
+
+  std::filesystem::remove_all(cache_folder);
+}
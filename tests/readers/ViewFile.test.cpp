@@ -0,0 +1,91 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief units tests for ViewFile class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "ViewFile.h"
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+
+TEST_CASE("ViewFile round trips projected views", "[ViewFile]") {
+  std::filesystem::path folder =
+      std::filesystem::temp_directory_path() / "hollow_lantern_view_file";
+  std::filesystem::remove_all(folder);
+  std::filesystem::path path = folder / "chr_knight.hlviews";
+
+  sf::VertexArray triangles(sf::PrimitiveType::Triangles);
+  triangles.append(sf::Vertex{{0.f, 0.f}, sf::Color(10, 20, 30, 40)});
+  triangles.append(sf::Vertex{{1.5f, 0.f}, sf::Color::Red});
+  triangles.append(sf::Vertex{{0.f, -2.25f}, sf::Color::Blue});
+  sf::VertexArray strip(sf::PrimitiveType::TriangleStrip);
+  for (int i = 0; i < 4; ++i) {
+    strip.append(sf::Vertex{{static_cast<float>(i / 2), static_cast<float>(i)},
+                            sf::Color::Green});
+  }
+  sf::VertexArray empty(sf::PrimitiveType::Triangles);
+
+  hollow_lantern::ViewFile::Write(path, "chr_knight",
+                                  {triangles, empty, strip});
+
+  hollow_lantern::ViewFile view_file;
+  REQUIRE(view_file.Open(path));
+  REQUIRE(view_file.Name() == "chr_knight");
+  REQUIRE(view_file.ViewCount() == 3);
+  REQUIRE(view_file.PrimitiveType(0) == sf::PrimitiveType::Triangles);
+  REQUIRE(view_file.PrimitiveType(2) == sf::PrimitiveType::TriangleStrip);
+  REQUIRE(view_file.Positions(1).empty());
+
+  REQUIRE(view_file.Positions(0).size() == 3);
+  REQUIRE(view_file.Positions(0)[2] == sf::Vector2f(0.f, -2.25f));
+  REQUIRE(view_file.Colors(0)[0] == sf::Color(10, 20, 30, 40));
+  REQUIRE(view_file.Positions(2).size() == 4);
+  REQUIRE(view_file.Positions(2)[3] == sf::Vector2f(1.f, 3.f));
+  REQUIRE(view_file.Colors(2)[3] == sf::Color::Green);
+
+  // the arrays are used in place, so they have to be aligned
+  REQUIRE(reinterpret_cast<uintptr_t>(view_file.Positions(0).data()) %
+              alignof(sf::Vector2f) ==
+          0);
+
+  sf::VertexArray copy = view_file.ProvideVertexArray(2);
+  REQUIRE(copy.getPrimitiveType() == sf::PrimitiveType::TriangleStrip);
+  REQUIRE(copy.getVertexCount() == 4);
+  REQUIRE(copy[1].position == strip[1].position);
+  REQUIRE(copy[1].color == strip[1].color);
+
+  view_file.Close();
+  REQUIRE(view_file.ViewCount() == 0);
+  std::filesystem::remove_all(folder);
+}
+
+TEST_CASE("ViewFile rejects malformed files", "[ViewFile]") {
+  std::filesystem::path folder =
+      std::filesystem::temp_directory_path() / "hollow_lantern_view_file_bad";
+  std::filesystem::remove_all(folder);
+  std::filesystem::path path = folder / "bad.hlviews";
+
+  sf::VertexArray triangles(sf::PrimitiveType::Triangles, 3);
+  hollow_lantern::ViewFile::Write(path, "bad", {triangles});
+  const auto full_size = std::filesystem::file_size(path);
+
+  // a truncated file is caught by the size checks, not read past its end
+  std::filesystem::resize_file(path, full_size - 4);
+  hollow_lantern::ViewFile view_file;
+  REQUIRE_FALSE(view_file.Open(path));
+  REQUIRE(view_file.ViewCount() == 0);
+
+  // so is a file that is not a view file at all
+  {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << "{\"name\": \"bad\"}";
+  }
+  REQUIRE_FALSE(view_file.Open(path));
+  REQUIRE_FALSE(view_file.Open(folder / "missing.hlviews"));
+
+  std::filesystem::remove_all(folder);
+}
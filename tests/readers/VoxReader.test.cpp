@@ -40,5 +40,13 @@ TEST_CASE("VoxReader provides VoxData object", "[VoxReader]") {
   REQUIRE(result.has_value());
   REQUIRE(result->name == "chr_knight");
   REQUIRE(result->voxel_data.size() > 0);
+  // the occupied bounds hold a voxel and fit inside the model
+  const auto &bounds = result->occupancy.bounds;
+  REQUIRE_FALSE(bounds.IsEmpty());
+  REQUIRE(bounds.max.x <= result->size.x);
+  REQUIRE(bounds.max.y <= result->size.y);
+  REQUIRE(bounds.max.z <= result->size.z);
+  REQUIRE(result->occupancy.slice_counts[0][bounds.min.x] > 0);
+  REQUIRE(result->occupancy.slice_counts[0][bounds.max.x - 1] > 0);
   // Check if the voxels have valid positions and colors
 }